@@ -0,0 +1,133 @@
+/*
+ * 설명: MatchmakingIndex로 대기자 N명(기본 10만)을 모두 매치로 묶는 처리량(users/s), 묶을 수 없는 대기자가
+ *       섞인 큐의 재확인 한 번 비용, N명(기본 20만)이 대기 중일 때 큐 점검 한 번의 만료 처리 비용을 측정한다.
+ *       실행: ./build/bench_matchmaking --benchmark_counters_tabular=true
+ * 버전: v1.0.0
+ * 관련 문서: design/server/v0.5.0-match-session.md
+ */
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "server/matchmaking_index.hpp"
+
+namespace {
+
+// 레이팅 1000±600 부근에 몰린 분포를 만든다(균등 난수 네 개의 합). 시드 고정으로 실행마다 같다.
+std::vector<int> MakeRatings(std::size_t count) {
+  std::vector<int> ratings;
+  ratings.reserve(count);
+  std::uint64_t state = 0x9e3779b97f4a7c15ULL;
+  auto next = [&state]() {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return static_cast<int>((state >> 33) % 301);
+  };
+  for (std::size_t i = 0; i < count; ++i) {
+    ratings.push_back(400 + next() + next() + next() + next());
+  }
+  return ratings;
+}
+
+// 대기자 users명을 넣은 뒤 PopMatch가 더 묶지 못할 때까지 session_size명씩 뺀다. 채우는 시간은 제외한다.
+// 입장 시각은 최근 10초에 고르게 퍼뜨려 창 너비가 대기자마다 다르게 한다.
+void BM_PairQueuedUsers(benchmark::State& state) {
+  const auto users = static_cast<std::size_t>(state.range(0));
+  const auto session_size = static_cast<std::size_t>(state.range(1));
+  const auto ratings = MakeRatings(users);
+  const auto now = std::chrono::steady_clock::now();
+  std::vector<server::MatchTicket> matched;
+  std::size_t paired = 0;
+  std::size_t left_over = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    server::MatchmakingIndex index;
+    for (std::size_t i = 0; i < users; ++i) {
+      const auto joined_at = now - std::chrono::milliseconds(static_cast<std::int64_t>((users - i) * 10'000 / users));
+      index.Add(server::MatchTicket{static_cast<int>(i + 1), "user", ratings[i], joined_at,
+                                    joined_at + std::chrono::seconds(60)});
+    }
+    server::MatchmakingIndex::Scan scan;
+    state.ResumeTiming();
+    while (index.PopMatch(now, session_size, matched, scan)) {
+      paired += matched.size();
+    }
+    left_over += index.Size();
+  }
+  state.counters["users/s"] = benchmark::Counter(static_cast<double>(paired), benchmark::Counter::kIsRate);
+  state.counters["unmatched"] =
+      benchmark::Counter(static_cast<double>(left_over), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_PairQueuedUsers)
+    ->ArgNames({"users", "size"})
+    ->ArgsProduct({{10'000, 100'000}, {2, 8}})
+    ->Unit(benchmark::kMillisecond);
+
+// 재확인 한 번의 비용. 앞쪽 절반은 창 안에 상대가 없는 대기자(레이팅 간격 1000)이고, 뒤쪽 절반은 바로 묶이는 쌍이다.
+// 실패한 앵커를 매치마다 다시 보면 O(n²)로 늘어난다. 채우는 시간은 제외한다.
+void BM_RecheckSparseQueue(benchmark::State& state) {
+  const auto users = static_cast<std::size_t>(state.range(0));
+  const auto now = std::chrono::steady_clock::now();
+  std::vector<server::MatchTicket> matched;
+  std::size_t paired = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    server::MatchmakingIndex index;
+    for (std::size_t i = 0; i < users; ++i) {
+      const int rating = i < users / 2 ? static_cast<int>(i) * 1000 : static_cast<int>((i - users / 2) / 2) * 1000 + 500;
+      index.Add(server::MatchTicket{static_cast<int>(i + 1), "user", rating, now, now + std::chrono::seconds(60)});
+    }
+    server::MatchmakingIndex::Scan scan;
+    state.ResumeTiming();
+    while (index.PopMatch(now, 2, matched, scan)) {
+      paired += matched.size();
+    }
+  }
+  state.counters["users/s"] = benchmark::Counter(static_cast<double>(paired), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_RecheckSparseQueue)->ArgName("users")->Arg(2'000)->Arg(20'000)->Unit(benchmark::kMillisecond);
+
+// 대기자 users명을 유지한 채 점검마다 expiring명이 만료되고 같은 수가 새로 들어오는 정상 상태를 흉내 낸다.
+// 만료 시각은 입장 순서와 무관하게 섞는다. 점검 비용이 큐 길이가 아니라 만료 수를 따라야 한다.
+void BM_ExpireFromLargeQueue(benchmark::State& state) {
+  const auto users = static_cast<std::size_t>(state.range(0));
+  const auto expiring = static_cast<std::size_t>(state.range(1));
+  const auto ratings = MakeRatings(users);
+  const auto base = std::chrono::steady_clock::now();
+  // 점검 k번째에 만료될 티켓은 base + k초 부근이다. 순번을 섞어 넣어 입장 순서와 만료 순서를 어긋나게 한다.
+  auto deadline_of = [&](std::size_t i) {
+    const auto slot = (i * 7919) % users;
+    return base + std::chrono::seconds(1 + static_cast<std::int64_t>(slot / expiring));
+  };
+  server::MatchmakingIndex index;
+  for (std::size_t i = 0; i < users; ++i) {
+    index.Add(server::MatchTicket{static_cast<int>(i + 1), "user", ratings[i], base, deadline_of(i)});
+  }
+  std::vector<server::MatchTicket> expired;
+  std::size_t next_user = users;
+  std::size_t removed = 0;
+  std::int64_t tick = 0;
+  const auto horizon = static_cast<std::int64_t>(users / expiring);
+  for (auto _ : state) {
+    ++tick;
+    expired.clear();
+    removed += index.RemoveExpired(base + std::chrono::seconds(tick), expired);
+    for (std::size_t i = 0; i < expired.size(); ++i, ++next_user) {
+      index.Add(server::MatchTicket{static_cast<int>(next_user + 1), "user", expired[i].rating, base,
+                                    base + std::chrono::seconds(tick + horizon)});
+    }
+  }
+  state.counters["expired/tick"] =
+      benchmark::Counter(static_cast<double>(removed), benchmark::Counter::kAvgIterations);
+  state.counters["queued"] = static_cast<double>(index.Size());
+}
+BENCHMARK(BM_ExpireFromLargeQueue)
+    ->ArgNames({"users", "expiring"})
+    ->ArgsProduct({{20'000, 200'000}, {100}})
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,218 @@
+/*
+ * 설명: Simulation 핫 경로(EnqueueInput/TickOnce/Snapshot/전체 세션/상태 전파)의 ns/op와 allocs/op를 측정한다.
+ *       실행: ./build/bench_simulation --benchmark_counters_tabular=true
+ * 버전: v1.0.0
+ * 관련 문서: design/server/v0.3.0-tick-loop.md
+ */
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include "server/interest_filter.hpp"
+#include "server/simulation.hpp"
+
+namespace {
+
+std::atomic<std::uint64_t> g_allocations{0};
+
+// 반복 구간 동안의 operator new 호출 수를 allocs/op 카운터로 기록한다.
+class AllocationScope {
+ public:
+  explicit AllocationScope(benchmark::State& state) : state_(state), start_(g_allocations.load()) {}
+  ~AllocationScope() {
+    state_.counters["allocs/op"] = benchmark::Counter(static_cast<double>(g_allocations.load() - start_),
+                                                      benchmark::Counter::kAvgIterations);
+  }
+
+ private:
+  benchmark::State& state_;
+  std::uint64_t start_;
+};
+
+constexpr int kFillTicks = server::Simulation::kInputHorizonTicks - 1;
+
+enum class Load { kEmpty, kSparse, kSaturated };
+
+// (current, current + kFillTicks] 구간에 부하 유형별 입력을 채운다.
+void FillHorizon(server::Simulation& sim, int players, Load load, std::vector<std::uint64_t>& sequences) {
+  const int base = sim.CurrentTick();
+  for (int tick = base + 1; tick <= base + kFillTicks; ++tick) {
+    if (load == Load::kEmpty) {
+      continue;
+    }
+    const int per_player = load == Load::kSaturated ? server::Simulation::kMaxInputsPerTickPerUser : 1;
+    const int player_count = load == Load::kSaturated ? players : 1;
+    for (int p = 0; p < player_count; ++p) {
+      const int user = load == Load::kSaturated ? p + 1 : (tick % players) + 1;
+      for (int k = 0; k < per_player; ++k) {
+        sim.EnqueueInput({user, tick, (k % 3) - 1, ++sequences[static_cast<std::size_t>(user - 1)]});
+      }
+    }
+  }
+}
+
+server::Simulation MakeSimulation(int players) {
+  server::Simulation sim;
+  for (int p = 1; p <= players; ++p) {
+    sim.AddPlayer(p);
+  }
+  return sim;
+}
+
+void BM_EnqueueInput(benchmark::State& state) {
+  const int players = static_cast<int>(state.range(0));
+  auto sim = MakeSimulation(players);
+  std::vector<std::uint64_t> sequences(static_cast<std::size_t>(players), 0);
+  const int capacity = players * server::Simulation::kMaxInputsPerTickPerUser * kFillTicks;
+  int filled = 0;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    if (filled == capacity) {
+      // 창이 가득 차면 측정을 멈추고 틱을 진행해 비운다.
+      state.PauseTiming();
+      for (int i = 0; i < kFillTicks; ++i) {
+        sim.TickOnce();
+      }
+      filled = 0;
+      state.ResumeTiming();
+    }
+    const int user = filled % players + 1;
+    const int tick = sim.CurrentTick() + 1 + filled / (players * server::Simulation::kMaxInputsPerTickPerUser);
+    auto result = sim.EnqueueInput({user, tick, 1, ++sequences[static_cast<std::size_t>(user - 1)]});
+    benchmark::DoNotOptimize(result);
+    ++filled;
+  }
+}
+BENCHMARK(BM_EnqueueInput)->Arg(2)->Arg(8)->Arg(32);
+
+void BM_TickOnce(benchmark::State& state) {
+  const int players = static_cast<int>(state.range(0));
+  const auto load = static_cast<Load>(state.range(1));
+  auto sim = MakeSimulation(players);
+  std::vector<std::uint64_t> sequences(static_cast<std::size_t>(players), 0);
+  FillHorizon(sim, players, load, sequences);
+  int remaining = kFillTicks;
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    if (remaining == 0) {
+      state.PauseTiming();
+      FillHorizon(sim, players, load, sequences);
+      remaining = kFillTicks;
+      state.ResumeTiming();
+    }
+    sim.TickOnce();
+    --remaining;
+  }
+}
+BENCHMARK(BM_TickOnce)
+    ->ArgNames({"players", "load"})
+    ->ArgsProduct({{2, 8, 32},
+                   {static_cast<int>(Load::kEmpty), static_cast<int>(Load::kSparse),
+                    static_cast<int>(Load::kSaturated)}});
+
+void BM_SnapshotJson(benchmark::State& state) {
+  auto sim = MakeSimulation(static_cast<int>(state.range(0)));
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    auto snapshot = sim.Snapshot();
+    benchmark::DoNotOptimize(snapshot);
+  }
+}
+BENCHMARK(BM_SnapshotJson)->Arg(2)->Arg(8)->Arg(32);
+
+void BM_SnapshotView(benchmark::State& state) {
+  auto sim = MakeSimulation(static_cast<int>(state.range(0)));
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    long sum = 0;
+    sim.View().ForEachPlayer([&sum](const server::PlayerView& player) { sum += player.position; });
+    benchmark::DoNotOptimize(sum);
+  }
+}
+BENCHMARK(BM_SnapshotView)->Arg(2)->Arg(8)->Arg(32);
+
+// 세션 하나를 처음부터 끝까지: 플레이어마다 매 틱 입력 1개, 틱마다 뷰 읽기, 종료 시 JSON 스냅샷.
+void BM_FullSession(benchmark::State& state) {
+  const int players = static_cast<int>(state.range(0));
+  const int max_ticks = static_cast<int>(state.range(1));
+  AllocationScope allocs(state);
+  for (auto _ : state) {
+    auto sim = MakeSimulation(players);
+    std::uint64_t sequence = 0;
+    for (int t = 0; t < max_ticks; ++t) {
+      ++sequence;
+      for (int p = 1; p <= players; ++p) {
+        sim.EnqueueInput({p, sim.CurrentTick() + 1, (p + t) % 3 - 1, sequence});
+      }
+      sim.TickOnce();
+      int best = 0;
+      sim.View().ForEachPlayer([&best](const server::PlayerView& player) { best = std::max(best, player.position); });
+      benchmark::DoNotOptimize(best);
+    }
+    auto snapshot = sim.Snapshot();
+    benchmark::DoNotOptimize(snapshot);
+  }
+  state.counters["ticks/s"] =
+      benchmark::Counter(static_cast<double>(max_ticks), benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_FullSession)->ArgNames({"players", "max_ticks"})->ArgsProduct({{2, 8, 32}, {300, 3600}});
+
+// 틱 하나의 session.state 전파(N명 수신). radius=0은 한 번 직렬화해 공유, 그 외는 수신자별 필터 후 직렬화한다.
+// 플레이어는 3칸 간격으로 놓여 반경 안 이웃 수가 radius에 비례한다. bytes/tick은 전체 수신자에게 나가는 바이트다.
+void BM_StateFanout(benchmark::State& state) {
+  const int players = static_cast<int>(state.range(0));
+  const int radius = static_cast<int>(state.range(1));
+  auto sim = MakeSimulation(players);
+  for (int p = 1; p <= players; ++p) {
+    for (std::uint64_t step = 1; step <= static_cast<std::uint64_t>(p); ++step) {
+      sim.EnqueueInput({p, static_cast<int>(step), server::Simulation::kMaxDelta, step});
+    }
+  }
+  for (int t = 0; t < players; ++t) {
+    sim.TickOnce();
+  }
+  const auto filter = server::MakeInterestFilter(radius);
+  std::vector<server::PlayerView> selected;
+  std::size_t bytes = 0;
+  for (auto _ : state) {
+    const auto view = sim.View();
+    if (filter->Broadcast()) {
+      const auto frame = nlohmann::json{{"tick", view.Tick()}, {"players", server::PlayersToJson(view)}}.dump();
+      bytes += frame.size() * static_cast<std::size_t>(players);
+      benchmark::DoNotOptimize(frame.data());
+      continue;
+    }
+    for (int recipient = 1; recipient <= players; ++recipient) {
+      server::SelectInterestedPlayers(view, recipient, *filter, selected);
+      nlohmann::json list = nlohmann::json::array();
+      for (const auto& player : selected) {
+        list.push_back(server::PlayerToJson(player));
+      }
+      const auto frame = nlohmann::json{{"tick", view.Tick()}, {"players", std::move(list)}}.dump();
+      bytes += frame.size();
+      benchmark::DoNotOptimize(frame.data());
+    }
+  }
+  state.counters["bytes/tick"] =
+      benchmark::Counter(static_cast<double>(bytes), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_StateFanout)->ArgNames({"players", "radius"})->ArgsProduct({{2, 8, 32, 64}, {0, 9}});
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+BENCHMARK_MAIN();
@@ -0,0 +1,59 @@
+/*
+ * 설명: 틱 지연, 이벤트 루프 지연, 활성 세션 수로 노드 여유를 판단해 새 큐 입장/세션 생성을 받을지 정한다.
+ * 버전: v1.0.0
+ * 관련 문서: design/server/v0.5.0-match-session.md, design/protocol/contract.md
+ * 테스트: server/tests/unit/admission_controller_test.cpp, server/tests/e2e/session_flow_test.cpp
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace server {
+
+struct AdmissionConfig {
+  // 0이면 해당 신호로는 거절하지 않는다. max_active_sessions는 동시에 진행할 수 있는 세션 수다.
+  std::size_t max_active_sessions{0};
+  std::chrono::milliseconds max_tick_lateness{0};
+  std::chrono::milliseconds max_loop_lag{0};
+  // 거절 응답의 Retry-After.
+  std::chrono::seconds retry_after{1};
+  // 이 시간 동안 틱 관측이 없으면(진행 중인 세션이 없으면) 틱 지연을 0으로 본다.
+  std::chrono::milliseconds lateness_stale_after{1000};
+};
+
+enum class AdmissionVerdict { kAdmit, kTooManySessions, kTickLateness, kLoopLag };
+
+struct AdmissionSignals {
+  std::size_t active_sessions{0};
+  std::chrono::microseconds tick_lateness{0};
+  std::chrono::microseconds loop_lag{0};
+};
+
+// 진행 중인 매치를 지키기 위해 과부하 시 새 작업을 먼저 거절한다.
+// RecordTickLateness는 여러 세션 strand에서, Evaluate는 HTTP/큐 경로에서 잠금 없이 호출한다.
+class AdmissionController {
+ public:
+  explicit AdmissionController(const AdmissionConfig& config);
+
+  // 틱 처리 직후 예정 시각 대비 지연을 넣는다. 세션 전체에 대한 지수 이동 평균(1/8 가중)으로 합친다.
+  void RecordTickLateness(std::chrono::microseconds lateness);
+  // 평활된 틱 지연. 최근 관측이 없으면 0.
+  std::chrono::microseconds TickLateness() const;
+
+  // 세션 하나를 더 받을 여유가 있는지 본다. 큐 입장과 세션 생성 모두 같은 기준을 쓴다.
+  AdmissionVerdict Evaluate(const AdmissionSignals& signals) const;
+  std::chrono::seconds RetryAfter() const { return config_.retry_after; }
+  bool Enabled() const;
+
+ private:
+  AdmissionConfig config_;
+  std::atomic<std::int64_t> smoothed_lateness_us_{0};
+  std::atomic<std::chrono::steady_clock::rep> last_observed_at_{0};
+};
+
+const char* AdmissionVerdictName(AdmissionVerdict verdict);
+
+}  // namespace server
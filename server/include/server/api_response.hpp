@@ -24,5 +24,6 @@ struct WsEnvelope {
 };
 
 nlohmann::json ToWsJson(const WsEnvelope& env);
+nlohmann::json ToWsJson(WsEnvelope&& env);
 
 }  // namespace server
@@ -16,7 +16,9 @@
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/steady_timer.hpp>
 
+#include "server/admission.hpp"
 #include "server/auth.hpp"
 #include "server/config.hpp"
 #include "server/match_queue.hpp"
@@ -25,6 +27,7 @@
 #include "server/reconnect.hpp"
 #include "server/result_service.hpp"
 #include "server/session_manager.hpp"
+#include "server/session_migration.hpp"
 #include "server/rating.hpp"
 
 namespace server {
@@ -44,19 +47,27 @@ class ServerApp {
   std::shared_ptr<AuthService> GetAuthService() { return auth_service_; }
   std::shared_ptr<ReconnectService> GetReconnectService() { return reconnect_service_; }
   std::shared_ptr<SessionManager> GetSessionManager() { return session_manager_; }
-  std::shared_ptr<MatchQueueService> GetMatchQueue() { return match_queue_; }
+  std::shared_ptr<MatchQueues> GetMatchQueues() { return match_queues_; }
   std::shared_ptr<RatingService> GetRatingService() { return rating_service_; }
   std::shared_ptr<ResultService> GetResultService() { return result_service_; }
   std::shared_ptr<Observability> GetObservability() { return observability_; }
+  std::shared_ptr<AdmissionController> GetAdmissionController() { return admission_; }
   std::size_t DebugResultCount() const { return result_service_->Count(); }
 
  private:
   void RunWorkers();
+  void RunWorker(int index);
+  void ScheduleLagProbe();
+  // 다른 서버가 보낸 세션을 받아들이고 참가자별 접속/복귀 토큰을 돌려준다(type=import).
+  // 같은 migrationId로 다시 오면 이미 받은 세션의 토큰을 새로 발급하고, type=abort면 그 이전을 취소한다.
+  nlohmann::json AcceptMigration(const nlohmann::json& request);
 
   AppConfig config_;
   boost::asio::io_context ioc_;
   boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_guard_;
+  boost::asio::steady_timer lag_probe_timer_;
   std::shared_ptr<Listener> listener_;
+  std::shared_ptr<MigrationListener> migration_listener_;
   std::shared_ptr<AuthService> auth_service_;
   std::shared_ptr<ReconnectService> reconnect_service_;
   std::shared_ptr<RealtimeCoordinator> coordinator_;
@@ -64,8 +75,9 @@ class ServerApp {
   std::shared_ptr<RatingService> rating_service_;
   std::shared_ptr<ResultRepository> result_repository_;
   std::shared_ptr<ResultService> result_service_;
+  std::shared_ptr<AdmissionController> admission_;
   std::shared_ptr<SessionManager> session_manager_;
-  std::shared_ptr<MatchQueueService> match_queue_;
+  std::shared_ptr<MatchQueues> match_queues_;
   std::vector<std::thread> workers_;
   std::atomic<bool> running_{false};
 };
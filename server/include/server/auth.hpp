@@ -59,6 +59,8 @@ class AuthService {
                                    const std::string& ip,
                                    std::string& error_code, std::string& error_message);
   bool Logout(const std::string& token);
+  // 비밀번호 확인 없이 토큰을 발급한다. 다른 서버에서 이전돼 온 세션 참가자에게 접속 토큰을 줄 때 쓴다.
+  AuthSession IssueSession(const AuthUser& user);
   std::optional<AuthSession> ValidateToken(const std::string& token);
 
   AuthConfig GetConfig() const { return config_; }
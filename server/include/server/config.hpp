@@ -9,9 +9,20 @@
 
 #include <cstddef>
 #include <string>
+#include <vector>
 
 namespace server {
 
+// 큐 모드 하나의 설정. 모드마다 독립된 큐(matchmaker 스레드)를 만든다.
+struct MatchModeConfig {
+  std::string name;
+  std::size_t queue_timeout_seconds{10};
+  std::size_t session_size{2};
+  std::size_t rating_window{100};
+  std::size_t rating_widen_per_second{50};
+  std::size_t rating_window_max{400};
+};
+
 struct AppConfig {
   unsigned short port;
   std::string db_host;
@@ -30,8 +41,48 @@ struct AppConfig {
   std::size_t match_queue_timeout_seconds;
   std::size_t session_tick_interval_ms;
   std::string ops_token;
+  // 매치 수명주기 샘플 트레이스 보관 주기(N개 매치마다 1개, 0이면 끔).
+  // 샘플 세션은 입력마다 트레이서 전역 잠금을 잡으므로 기본값은 드물게 둔다.
+  std::size_t trace_sample_every{100};
+  // 늦은 입력을 받아 재시뮬레이션할 과거 틱 수(0이면 롤백 끔, 최대 Simulation::kMaxRollbackTicks).
+  std::size_t session_rollback_ticks{0};
+  // 과부하 시 세션별로 늘릴 수 있는 최대 틱 간격(ms). session_tick_interval_ms 이하이면 조절하지 않는다.
+  std::size_t session_tick_interval_max_ms{0};
+  // 전체 상태(session.state)를 보내는 틱 주기. 1이면 매 틱 전체 상태, K>1이면 그 사이 틱은 {tick, stateHash}만 보낸다.
+  std::size_t session_full_state_every{1};
+  // 한 세션 참가자 수(2~SessionManager::kMaxSessionPlayers). 큐에서 이 인원이 모이면 세션을 만든다.
+  std::size_t match_session_size{2};
+  // 수신자와 위치 차이가 이 값 이하인 플레이어만 session.state에 담는다(0이면 모든 플레이어).
+  std::size_t session_interest_radius{0};
+  // 다른 서버에서 이전해 오는 세션을 받을 127.0.0.1 포트(0이면 받지 않음). 요청은 migration_token으로 인증한다.
+  unsigned short migration_port{0};
+  // 원본 → 대상 이전 요청에 싣는 전용 토큰. ops_token을 대상에 보내지 않도록 따로 둔다. 비어 있으면 이전을 보내지도 받지도 않는다.
+  std::string migration_token;
+  // /ops/migrate의 targetHost로 허용하는 주소(IP 문자열 그대로 비교).
+  std::vector<std::string> migration_allowed_hosts{"127.0.0.1"};
+  // 이전받은 세션이 참가자 복귀(session.resume)를 기다리는 최대 시간(ms). 지나면 모두 복귀하지 않아도 틱을 재개한다.
+  std::size_t migration_resume_timeout_ms{3000};
+  // 입장 제어 한도(0이면 해당 신호 끔). 넘으면 큐 입장을 503 server_overloaded로 거절하고 세션 생성을 미룬다.
+  std::size_t admission_max_sessions{0};
+  std::size_t admission_max_tick_lateness_ms{0};
+  std::size_t admission_max_loop_lag_ms{0};
+  std::size_t admission_retry_after_seconds{1};
+  // 관전자 연결별 대기 프레임 수. 넘치면 연결을 끊지 않고 가장 오래된 관전 프레임을 버린다.
+  std::size_t spectator_queue_frames{4};
+  // 세션당 관전자 수 상한과 관전 요청이 지정할 수 있는 최대 지연 틱 수.
+  std::size_t spectator_max_per_session{10000};
+  std::size_t spectator_max_delay_ticks{600};
+  // 매칭 레이팅 창: 입장 직후 허용 차이, 대기 1초마다 넓히는 폭, 상한(0이면 제한 없음).
+  std::size_t match_rating_window{100};
+  std::size_t match_rating_widen_per_second{50};
+  std::size_t match_rating_window_max{400};
+  // 큐 모드 목록(MATCH_MODES). 비어 있으면 위 match_* 값으로 "normal" 모드 하나만 둔다.
+  std::vector<MatchModeConfig> match_modes;
 };
 
+// match_modes가 비어 있으면 전역 match_* 값으로 만든 "normal" 모드 하나를 돌려준다.
+std::vector<MatchModeConfig> ResolveMatchModes(const AppConfig& config);
+
 AppConfig LoadConfigFromEnv();
 
 }  // namespace server
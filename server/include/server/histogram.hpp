@@ -0,0 +1,42 @@
+/*
+ * 설명: 고정 버킷 누적 히스토그램으로 지연/분포 메트릭을 잠금 없이 기록한다.
+ * 버전: v1.0.0
+ * 관련 문서: design/ops/v0.7.0-observability.md
+ * 테스트: server/tests/unit/match_trace_test.cpp
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace server {
+
+// 마이크로초 단위 지연 기록용 기본 버킷 상한(50us ~ 10s).
+std::vector<std::uint64_t> LatencyBucketsMicros();
+
+class Histogram {
+ public:
+  explicit Histogram(std::vector<std::uint64_t> upper_bounds);
+
+  void Record(std::uint64_t value);
+  std::uint64_t Count() const { return count_.load(std::memory_order_relaxed); }
+  // 버킷 상한 기준 근사 백분위. 마지막(초과) 버킷은 관측 최댓값을 돌려준다.
+  std::uint64_t Percentile(double quantile) const;
+  // divisor로 나눈 값을 suffix가 붙은 키로 직렬화한다(예: 1000.0, "Ms").
+  nlohmann::json ToJson(double divisor, std::string_view suffix) const;
+
+ private:
+  std::vector<std::uint64_t> upper_bounds_;
+  std::unique_ptr<std::atomic<std::uint64_t>[]> counts_;
+  std::atomic<std::uint64_t> count_{0};
+  std::atomic<std::uint64_t> sum_{0};
+  std::atomic<std::uint64_t> max_{0};
+};
+
+}  // namespace server
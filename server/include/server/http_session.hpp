@@ -36,7 +36,7 @@ namespace server {
               std::shared_ptr<ReconnectService> reconnect_service,
               std::shared_ptr<RealtimeCoordinator> coordinator,
               std::shared_ptr<SessionManager> session_manager,
-              std::shared_ptr<MatchQueueService> match_queue,
+              std::shared_ptr<MatchQueues> match_queues,
               std::shared_ptr<RatingService> rating_service,
               std::shared_ptr<Observability> observability);
   void Run();
@@ -48,6 +48,13 @@ namespace server {
   void SendResponse(std::shared_ptr<boost::beast::http::response<boost::beast::http::string_body>> res);
   void HandleWebSocket();
   std::optional<AuthSession> ExtractAuthSession();
+  bool IsOpsAuthorized();
+  // 결과를 모르는 세션 이전을 대상에 취소해 본다. 대상이 확인하면 원본에서 재개(502),
+  // 확인하지 못하면 원본을 멈춘 채로 두고 migration_unknown(504)으로 응답한다.
+  void ConfirmMigrationAbort(std::shared_ptr<boost::beast::http::response<boost::beast::http::string_body>> res,
+                             const std::string& session_id, const std::string& migration_id,
+                             const std::string& target_host, unsigned short target_port,
+                             const std::string& import_error);
   std::string RemoteIp();
   std::string ParseBearer(const std::string& header_value);
 
@@ -59,7 +66,7 @@ namespace server {
   std::shared_ptr<ReconnectService> reconnect_service_;
   std::shared_ptr<RealtimeCoordinator> coordinator_;
   std::shared_ptr<SessionManager> session_manager_;
-  std::shared_ptr<MatchQueueService> match_queue_;
+  std::shared_ptr<MatchQueues> match_queues_;
   std::shared_ptr<RatingService> rating_service_;
   std::shared_ptr<Observability> observability_;
   std::chrono::steady_clock::time_point request_start_;
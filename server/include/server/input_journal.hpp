@@ -0,0 +1,76 @@
+/*
+ * 설명: 세션에서 수락된 입력을 압축 바이너리 저널로 기록하고 Simulation으로 결정적으로 재생한다.
+ * 버전: v1.0.0
+ * 관련 문서: design/server/v0.3.0-tick-loop.md, design/protocol/contract.md
+ * 테스트: server/tests/unit/input_journal_test.cpp
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "server/simulation.hpp"
+
+namespace server {
+
+// 저널 형식(모든 정수는 LEB128 varint, 부호 있는 값은 zigzag):
+//   헤더: 'I' 'J' 버전(1) | 롤백 창 | 플레이어 수 | user_id 증분(오름차순, zigzag)
+//   레코드: 도착 틱 증분 | packed = (슬롯 << 3) | (delta + 3)
+//           | target_tick - 도착 틱(zigzag) | 해당 슬롯 직전 시퀀스 대비 증분
+//   종료: 도착 틱 증분 | packed 하위 3비트 = 7  (이때 도착 틱이 최종 틱이다)
+class InputJournal {
+ public:
+  static constexpr std::uint8_t kVersion = 1;
+  // 헤더에 허용하는 플레이어 수 상한. 세션 참가자 상한(SessionManager::kMaxSessionPlayers)과 같다.
+  static constexpr std::size_t kMaxPlayers = 64;
+
+  // 이전 세션에서 쓰던 버퍼 용량을 재사용한다.
+  void Begin(const std::vector<int>& user_ids, int rollback_window);
+  // arrival_tick: 입력을 수락한 시점의 Simulation::CurrentTick().
+  void Append(int arrival_tick, const InputCommand& input);
+  void Finish(int final_tick);
+
+  const std::string& Bytes() const { return bytes_; }
+  std::string TakeBytes() { return std::move(bytes_); }
+  std::size_t InputCount() const { return input_count_; }
+
+ private:
+  std::string bytes_;
+  std::vector<int> user_ids_;
+  std::vector<std::uint64_t> last_sequences_;
+  int last_arrival_tick_{0};
+  std::size_t input_count_{0};
+};
+
+struct ReplayResult {
+  bool ok{false};
+  std::string error;
+  std::size_t inputs{0};
+  int final_tick{0};
+};
+
+struct JournalHeader {
+  int rollback_window{0};
+  // 오름차순, 중복 없음.
+  std::vector<int> user_ids;
+};
+
+// 헤더만 읽는다. 재생 전에 참가자를 대조할 때 쓴다. 실패하면 error에 ReplayJournal과 같은 코드를 담는다.
+bool ReadJournalHeader(std::string_view bytes, JournalHeader& header, std::string& error);
+
+// 저널을 새 Simulation에 재생한다. 도착 틱까지 틱을 진행한 뒤 입력을 넣으므로 실시간 진행과 같은 검증/롤백 경로를 탄다.
+// continued가 있으면 같은 헤더로 Begin하고 재생한 입력을 같은 도착 틱으로 다시 기록해, 종료 표시 없이 이어 쓸 수 있게 한다.
+// 외부에서 받은 바이트를 그대로 넣어도 되도록 플레이어 수가 kMaxPlayers를 넘거나 도착 틱이 max_tick을 넘으면
+// 할당이나 틱 진행 전에 거절한다(too_many_players, tick_out_of_range).
+ReplayResult ReplayJournal(std::string_view bytes, Simulation& simulation, InputJournal* continued = nullptr,
+                           int max_tick = std::numeric_limits<int>::max());
+
+std::string EncodeBase64(std::string_view bytes);
+// 표준 알파벳(패딩 포함) base64를 디코드한다. 형식이 잘못되면 false를 돌려준다.
+bool DecodeBase64(std::string_view text, std::string& out);
+
+}  // namespace server
@@ -0,0 +1,52 @@
+/*
+ * 설명: 세션 상태를 수신자별로 보낼 때 수신자에게 필요한 플레이어만 고르는 관심 영역 필터를 정의한다.
+ * 버전: v1.0.0
+ * 관련 문서: design/server/v0.5.0-match-session.md, design/protocol/contract.md
+ * 테스트: server/tests/unit/interest_filter_test.cpp
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "server/simulation.hpp"
+
+namespace server {
+
+// 세션 틱 스레드(strand)에서 여러 세션이 공유하므로 구현은 상태를 바꾸지 않아야 한다.
+class InterestFilter {
+ public:
+  virtual ~InterestFilter() = default;
+
+  // recipient 입장에서 player 상태가 필요한지 판단한다. 자기 자신은 호출 측에서 항상 포함한다.
+  virtual bool Interested(const PlayerView& recipient, const PlayerView& player) const = 0;
+  // 모든 수신자가 같은 목록을 받으면 true. 이때 프레임을 한 번만 직렬화해 공유한다.
+  virtual bool Broadcast() const { return false; }
+};
+
+// 기존 동작: 모든 참가자가 모든 플레이어 상태를 받는다.
+class AllPlayersFilter : public InterestFilter {
+ public:
+  bool Interested(const PlayerView&, const PlayerView&) const override { return true; }
+  bool Broadcast() const override { return true; }
+};
+
+// 위치 차이가 radius 이하인 플레이어만 보낸다.
+class RadiusInterestFilter : public InterestFilter {
+ public:
+  explicit RadiusInterestFilter(int radius) : radius_(radius) {}
+  bool Interested(const PlayerView& recipient, const PlayerView& player) const override;
+
+ private:
+  int radius_;
+};
+
+// radius가 0 이하이면 AllPlayersFilter, 아니면 RadiusInterestFilter를 만든다.
+std::shared_ptr<const InterestFilter> MakeInterestFilter(int radius);
+
+// recipient_id 기준 관심 플레이어를 user_id 오름차순으로 out에 채운다. out의 용량은 재사용한다.
+// 수신자가 아직 스냅샷에 없으면 모든 플레이어를 채운다.
+void SelectInterestedPlayers(const SnapshotView& view, int recipient_id, const InterestFilter& filter,
+                             std::vector<PlayerView>& out);
+
+}  // namespace server
@@ -0,0 +1,74 @@
+/*
+ * 설명: io_context 워커 스레드별 처리 핸들러 수/바쁨·유휴 시간과 이벤트 루프 지연(loop lag)을 집계한다.
+ * 버전: v1.0.0
+ * 관련 문서: design/ops/v0.7.0-observability.md, design/protocol/contract.md
+ * 테스트: server/tests/e2e/metrics_ops_test.cpp
+ */
+#pragma once
+
+#include <pthread.h>
+#include <time.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "server/histogram.hpp"
+
+namespace server {
+
+class WorkerSlot {
+ public:
+  WorkerSlot(int index, clockid_t cpu_clock);
+
+  // 소유 워커 스레드만 호출한다(단일 기록자이므로 RMW 없이 증가).
+  void CountHandler() { handlers_.store(handlers_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+  // 워커 종료 직전에 호출해 마지막 CPU 시간을 고정한다.
+  void Finish();
+
+ private:
+  friend class LoopMonitor;
+
+  std::uint64_t BusyMicros() const;
+
+  int index_;
+  clockid_t cpu_clock_;
+  std::chrono::steady_clock::time_point started_at_;
+  std::atomic<std::uint64_t> handlers_{0};
+  std::atomic<bool> finished_{false};
+  std::atomic<std::uint64_t> final_busy_us_{0};
+  // 직전 프로브 시점 값과 그 구간의 사용률(천분율).
+  std::uint64_t last_busy_us_{0};
+  std::chrono::steady_clock::time_point last_sample_at_;
+  std::atomic<std::uint32_t> recent_permille_{0};
+};
+
+class LoopMonitor {
+ public:
+  static constexpr std::chrono::milliseconds kProbeInterval{100};
+
+  WorkerSlot& RegisterCurrentThread(int index);
+  // post→실행 지연을 기록한다.
+  void RecordLag(std::chrono::microseconds lag);
+  // 프로브 주기마다 호출해 워커별 최근 구간 사용률을 갱신한다.
+  void SampleUtilization();
+
+  std::uint64_t LastLagMicros() const { return last_lag_us_.load(std::memory_order_relaxed); }
+  std::uint64_t LagPercentileMicros(double quantile) const { return lag_.Percentile(quantile); }
+  // 등록된 워커의 최근 구간 평균 사용률(0~1).
+  double AverageUtilization() const;
+  nlohmann::json ToJson() const;
+
+ private:
+  std::vector<std::unique_ptr<WorkerSlot>> slots_;
+  mutable std::mutex mutex_;
+  Histogram lag_{LatencyBucketsMicros()};
+  std::atomic<std::uint64_t> last_lag_us_{0};
+};
+
+}  // namespace server
@@ -1,58 +1,194 @@
 /*
  * 설명: Redis 큐를 모사한 매칭 대기열을 관리하며 페어링/타임아웃/취소를 처리한다.
- * 버전: v0.8.0
+ * 버전: v1.0.0
  * 관련 문서: design/server/v0.5.0-match-session.md
- * 테스트: server/tests/e2e/session_flow_test.cpp
+ * 테스트: server/tests/e2e/session_flow_test.cpp, server/tests/unit/matchmaking_index_test.cpp
  */
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <cstddef>
-#include <iterator>
-#include <list>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
-#include <boost/asio/io_context.hpp>
-#include <boost/asio/steady_timer.hpp>
-
+#include "server/admission.hpp"
 #include "server/auth.hpp"
+#include "server/matchmaking_index.hpp"
+#include "server/observability.hpp"
+#include "server/rating.hpp"
 #include "server/realtime.hpp"
 #include "server/session_manager.hpp"
+#include "server/wake_signal.hpp"
 
 namespace server {
 
-class MatchQueueService : public std::enable_shared_from_this<MatchQueueService> {
+// 큐 입장/취소 처리 결과. ok가 false면 error_code/error_message에 사유가 담긴다.
+// matchmaker 스레드에서 호출되므로 호출자는 자기 실행 컨텍스트로 post만 하고 바로 돌아가야 한다.
+using QueueCompletion = std::function<void(bool ok, const std::string& error_code, const std::string& error_message)>;
+
+// 사용자가 한 번에 한 모드 큐에만 있도록 모드 큐들이 함께 쓰는 점유 표.
+// 서로 다른 모드의 matchmaker가 짧게 잡는 샤드 잠금이며, 다른 잠금과 겹쳐 잡지 않는다.
+class QueueMembership {
  public:
-  MatchQueueService(boost::asio::io_context& ioc, std::shared_ptr<SessionManager> session_manager,
-                    std::shared_ptr<RealtimeCoordinator> coordinator, std::chrono::seconds default_timeout);
+  static constexpr std::size_t kShardCount = 16;
+
+  // 다른 모드(또는 같은 모드)에 이미 있으면 false.
+  bool Claim(int user_id, std::size_t mode_index);
+  void Release(int user_id);
+  std::optional<std::size_t> ModeOf(int user_id) const;
+
+ private:
+  struct Shard {
+    mutable std::mutex mutex;
+    std::unordered_map<int, std::size_t> users;
+  };
+  Shard& ShardFor(int user_id) const { return shards_[static_cast<unsigned>(user_id) % kShardCount]; }
+
+  mutable std::array<Shard, kShardCount> shards_;
+};
+
+// 대기열 상태(색인/만료 힙/세션 인원)는 matchmaker 스레드 하나만 만진다.
+// 입장/취소는 잠금 없는 스택에 명령으로 넣고 바로 돌아가며, 결과는 QueueCompletion으로 받는다.
+// 큐 잠금이 없으므로 세션 관리자 잠금(IsUserInSession/CreateSession)과 겹쳐 잡히지 않는다.
+class MatchQueueService {
+ public:
+  // 입장 시 바로 묶지 못한 대기자를 넓어진 창/풀린 입장 제어로 다시 묶어 보는 주기.
+  static constexpr std::chrono::seconds kRecheckInterval{1};
+
+  MatchQueueService(std::shared_ptr<SessionManager> session_manager, std::shared_ptr<RealtimeCoordinator> coordinator,
+                    std::chrono::seconds default_timeout);
+  ~MatchQueueService();
 
-  bool Join(const AuthUser& user, std::chrono::seconds timeout, std::string& error_code, std::string& error_message);
-  bool Cancel(int user_id, std::string& error_code, std::string& error_message);
-  std::size_t QueueLength();
+  // 아래 Set* 설정은 Start 전에 호출한다.
+  void SetObservability(const std::shared_ptr<Observability>& observability) { observability_ = observability; }
+  // 설정하면 과부하 시 입장을 server_overloaded로 거절하고, 찬 큐의 세션 생성을 다음 재확인까지 미룬다.
+  void SetAdmissionController(const std::shared_ptr<AdmissionController>& admission) { admission_ = admission; }
+  std::chrono::seconds RetryAfter() const { return admission_ ? admission_->RetryAfter() : std::chrono::seconds(1); }
+  // 세션 하나에 묶을 인원. 2~SessionManager::kMaxSessionPlayers 범위로 맞춘다.
+  void SetSessionSize(std::size_t size);
+  // 입장 시 레이팅을 읽어 매칭 색인에 넣는다. 미설정이거나 기록이 없으면 RatingService 초기 레이팅으로 본다.
+  void SetRatingService(const std::shared_ptr<RatingService>& rating_service) { rating_service_ = rating_service; }
+  // 레이팅 창 설정.
+  void SetMatchmakingConfig(const MatchmakingConfig& config);
+  // 모드 이름/번호와 모드 간 점유 표. MatchQueues::Add가 SetObservability 뒤에 부른다.
+  void SetMode(const std::string& mode, std::size_t mode_index, const std::shared_ptr<QueueMembership>& membership);
+  const std::string& Mode() const { return mode_; }
+  // timeoutSeconds를 지정하지 않은 입장에 쓰는 대기 시간.
+  std::chrono::seconds DefaultTimeout() const { return default_timeout_; }
+
+  // matchmaker 스레드를 시작/정지한다. 시작 전에 들어온 명령은 시작 후 처리되고, Stop은 남은 명령을 처리한 뒤 돌아온다.
+  // Stop 뒤에 들어온 명령과 한 번도 처리되지 못한 명령은 server_stopping으로 응답한다.
+  void Start();
+  void Stop();
+
+  // trace_id는 큐 입장 HTTP 요청의 traceId로, 매치 트레이스에 연결된다.
+  // 레이팅은 호출 스레드에서 읽어 명령에 담는다. 대기 시간과 만료는 제출 시각부터 센다.
+  void Join(const AuthUser& user, std::chrono::seconds timeout, const std::string& trace_id, QueueCompletion done);
+  void Cancel(int user_id, QueueCompletion done);
+  // matchmaker가 마지막으로 처리한 시점의 대기 인원. 잠금 없이 읽는다.
+  std::size_t QueueLength() const { return queue_length_.load(std::memory_order_relaxed); }
+  // 아직 matchmaker가 꺼내지 않은 입장/취소 명령 수.
+  std::size_t PendingCommands() const { return pending_.load(std::memory_order_relaxed); }
 
  private:
-  struct QueueEntry {
+  struct QueueCommand {
+    enum class Kind { kJoin, kCancel };
+    Kind kind{Kind::kJoin};
     AuthUser user;
-    std::chrono::steady_clock::time_point expires_at;
-    std::chrono::steady_clock::time_point joined_at;
+    int rating{0};
+    std::chrono::seconds timeout{0};
+    std::string trace_id;
+    QueueCompletion done;
+    std::chrono::steady_clock::time_point submitted_at;
+  };
+  struct Node {
+    QueueCommand command;
+    Node* next = nullptr;
   };
 
-  void EnsureTimer();
-  void OnTick(const boost::system::error_code& ec);
+  void Submit(QueueCommand command);
+  void RunMatchmaker();
+  // 처리하지 못한 명령을 모두 꺼내 server_stopping으로 응답하고 버린다.
+  void RejectPending();
+  // 쌓인 명령을 모두 꺼내 제출 순서대로 처리하고 꺼낸 개수를 돌려준다.
+  std::size_t Drain();
+  void HandleJoin(QueueCommand& command);
+  void HandleCancel(QueueCommand& command);
+  // 만료를 처리하고, 재확인 주기가 지났으면 남은 대기자를 다시 묶어 본다.
+  void Sweep(std::chrono::steady_clock::time_point now);
+  // Join 경로. 방금 들어온 대기자를 앵커로 한 매치만 시도한다.
+  void PairOnJoin(int user_id, std::chrono::steady_clock::time_point now);
+  // 재확인 경로. 오래 기다린 대기자부터 넓어진 창으로 묶을 수 있는 만큼 묶는다.
   void PairIfPossible();
-  void HandleTimeouts();
+  // matched_에 담긴 인원으로 세션을 만들고 대기 시간/레이팅 차이를 기록한다.
+  // 이미 세션에 들어간 참가자가 있어 세션을 만들지 못하면 그 참가자만 빼고 나머지를 큐에 되돌린다.
+  void StartMatch(std::chrono::steady_clock::time_point now);
+  // 다른 모드와 공유하는 큐 점유를 놓는다. MatchQueues에 등록된 큐는 모드가 하나뿐이어도 점유 표를 가지므로 항상 놓고,
+  // 점유 표 없이 단독으로 만든 큐에서만 아무것도 하지 않는다.
+  void ReleaseClaim(int user_id);
+  void NotifyTimeouts(const std::vector<MatchTicket>& expired);
+  AdmissionVerdict CheckAdmission() const;
+  int RatingOf(int user_id) const;
 
-  boost::asio::steady_timer timer_;
   std::shared_ptr<SessionManager> session_manager_;
   std::shared_ptr<RealtimeCoordinator> coordinator_;
+  std::shared_ptr<Observability> observability_;
+  std::shared_ptr<AdmissionController> admission_;
+  std::shared_ptr<RatingService> rating_service_;
+  std::shared_ptr<QueueMembership> membership_;
   std::chrono::seconds default_timeout_;
-  std::list<QueueEntry> queue_;
-  std::unordered_map<int, std::list<QueueEntry>::iterator> user_index_;
-  std::mutex mutex_;
-  bool timer_active_{false};
+  std::string mode_{"normal"};
+  std::size_t mode_index_{0};
+  // Observability에 등록한 모드 번호. SetMode 전에는 모드별 메트릭을 남기지 않는다.
+  std::size_t metrics_mode_{Observability::kNoQueueMode};
+
+  // matchmaker 스레드 전용 상태. 시작 전에는 Set*만 만진다.
+  MatchmakingIndex index_;
+  // PopMatch 결과/만료 티켓 버퍼. 용량을 재사용한다.
+  std::vector<MatchTicket> matched_;
+  std::vector<MatchTicket> expired_;
+  std::size_t session_size_{2};
+  std::chrono::steady_clock::time_point next_recheck_;
+
+  // 다중 생산자 push 전용 스택. matchmaker가 exchange로 통째로 가져가 뒤집어 FIFO로 처리한다.
+  std::atomic<Node*> head_{nullptr};
+  std::atomic<std::size_t> pending_{0};
+  std::atomic<std::size_t> queue_length_{0};
+  std::atomic<bool> running_{false};
+  std::atomic<bool> stopped_{false};
+  std::thread matchmaker_;
+  WakeSignal wake_;
+};
+
+// 모드별 독립 큐 모음. 모드마다 matchmaker 스레드와 명령 스택, 타임아웃/인원/레이팅 창이 따로라
+// 한 모드에 입장이 몰려도 다른 모드의 페어링은 그 명령들을 기다리지 않는다.
+class MatchQueues {
+ public:
+  MatchQueues() : membership_(std::make_shared<QueueMembership>()) {}
+
+  // 서버 시작 전에 모드를 등록한다. 이미 있는 이름이면 false.
+  bool Add(const std::shared_ptr<MatchQueueService>& queue, const std::string& mode);
+  // 없는 모드면 nullptr.
+  std::shared_ptr<MatchQueueService> Find(const std::string& mode) const;
+  // 사용자가 대기 중인 모드의 큐. 어느 큐에도 없으면 nullptr.
+  std::shared_ptr<MatchQueueService> FindByUser(int user_id) const;
+  void Start();
+  void Stop();
+  std::vector<QueueModeSnapshot> Snapshot() const;
+  std::size_t PendingCommands() const;
+
+ private:
+  std::vector<std::shared_ptr<MatchQueueService>> queues_;
+  std::shared_ptr<QueueMembership> membership_;
 };
 
 }  // namespace server
@@ -0,0 +1,100 @@
+/*
+ * 설명: 큐 입장부터 레이팅 반영까지 매치 수명주기 구간 지연을 추적하고 샘플 트레이스를 보관한다.
+ * 버전: v1.0.0
+ * 관련 문서: design/ops/v0.7.0-observability.md, design/protocol/contract.md
+ * 테스트: server/tests/unit/match_trace_test.cpp, server/tests/e2e/metrics_ops_test.cpp
+ */
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "server/histogram.hpp"
+
+namespace server {
+
+enum class MatchEvent {
+  kCreated,
+  kStarted,
+  kFirstTick,
+  kInput,
+  kEnded,
+  kRatingApplied,
+};
+
+const char* MatchEventName(MatchEvent event);
+
+class MatchTracer {
+ public:
+  static constexpr std::size_t kDefaultMaxSamples = 64;
+  static constexpr std::size_t kMaxEventsPerTrace = 256;
+
+  // sample_every: N개 매치마다 1개를 샘플 트레이스로 보관한다(0이면 샘플링 끔).
+  explicit MatchTracer(std::size_t sample_every, std::size_t max_samples = kDefaultMaxSamples);
+
+  void RecordJoin(int user_id, const std::string& trace_id);
+  void DropJoin(int user_id);
+  // 세션 생성 시점을 페어링 시각으로 기록한다. 샘플 대상이면 true를 돌려준다.
+  bool OpenSession(const std::string& session_id, const std::string& trace_id, const std::vector<int>& user_ids);
+  void Mark(const std::string& session_id, MatchEvent event, std::optional<int> user_id = std::nullopt);
+  void CloseSession(const std::string& session_id);
+
+  nlohmann::json HistogramsJson() const;
+  nlohmann::json SampledTracesJson() const;
+  std::size_t OpenTraceCount() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct PendingJoin {
+    std::string trace_id;
+    Clock::time_point joined_at;
+  };
+
+  struct TraceEvent {
+    const char* name;
+    std::int64_t offset_us;
+    std::optional<int> user_id;
+  };
+
+  struct ActiveTrace {
+    std::string trace_id;
+    std::string session_id;
+    Clock::time_point paired_at;
+    std::vector<std::pair<int, PendingJoin>> joins;
+    std::optional<Clock::time_point> created_at;
+    std::optional<Clock::time_point> ended_at;
+    bool first_tick_seen{false};
+    bool sampled{false};
+    std::vector<TraceEvent> events;
+  };
+
+  void AppendEvent(ActiveTrace& trace, MatchEvent event, Clock::time_point now, std::optional<int> user_id);
+  void Retire(std::unordered_map<std::string, ActiveTrace>::iterator it);
+  static std::uint64_t Micros(Clock::duration d);
+
+  std::size_t sample_every_;
+  std::size_t max_samples_;
+  std::uint64_t opened_{0};
+  std::unordered_map<int, PendingJoin> pending_joins_;
+  std::unordered_map<std::string, ActiveTrace> active_;
+  std::deque<nlohmann::json> samples_;
+  mutable std::mutex mutex_;
+
+  Histogram join_to_pair_{LatencyBucketsMicros()};
+  Histogram pair_to_created_{LatencyBucketsMicros()};
+  Histogram created_to_first_tick_{LatencyBucketsMicros()};
+  Histogram queue_to_start_{LatencyBucketsMicros()};
+  Histogram end_to_rating_applied_{LatencyBucketsMicros()};
+};
+
+}  // namespace server
@@ -0,0 +1,110 @@
+/*
+ * 설명: 대기 중인 플레이어를 레이팅 순으로 색인하고, 대기 시간에 따라 넓어지는 레이팅 창 안에서 매치를 만든다.
+ * 버전: v1.0.0
+ * 관련 문서: design/server/v0.5.0-match-session.md
+ * 테스트: server/tests/unit/matchmaking_index_test.cpp
+ */
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace server {
+
+struct MatchmakingConfig {
+  // 입장 직후 허용하는 앵커와의 레이팅 차이.
+  int base_window{100};
+  // 대기 1초마다 넓히는 폭.
+  int widen_per_second{50};
+  // 창 상한. 0이면 제한 없이 넓힌다.
+  int max_window{400};
+};
+
+struct MatchTicket {
+  int user_id{0};
+  std::string username;
+  int rating{0};
+  std::chrono::steady_clock::time_point joined_at;
+  std::chrono::steady_clock::time_point expires_at;
+};
+
+// 단일 스레드 전용. MatchQueueService의 matchmaker 스레드만 사용한다.
+class MatchmakingIndex {
+ public:
+  // 같은 now로 PopMatch를 이어 부르는 재확인 한 번의 진행 위치.
+  // 창이 고정된 동안 티켓은 빠지기만 하므로 한 번 실패한 앵커는 다시 시도해도 실패한다. 그 앵커들을 건너뛴다.
+  struct Scan {
+    std::uint64_t next_seq{0};
+  };
+
+  explicit MatchmakingIndex(const MatchmakingConfig& config = MatchmakingConfig{});
+
+  // 이미 있는 user_id면 false.
+  bool Add(MatchTicket ticket);
+  bool Remove(int user_id);
+  bool Contains(int user_id) const { return seq_of_user_.count(user_id) > 0; }
+  std::size_t Size() const { return tickets_.size(); }
+  bool Empty() const { return tickets_.empty(); }
+
+  // 대기 시간 wait에 허용하는 레이팅 차이.
+  int WindowFor(std::chrono::steady_clock::duration wait) const;
+
+  // 오래 기다린 티켓부터 앵커로 삼아, 앵커 창 안에서 레이팅이 가장 가까운 size-1명을 고른다.
+  // 찾으면 size명을 색인에서 빼 out에 담고(앵커가 첫 번째) true. 앵커 하나당 O(log n + size)다.
+  // scan 위치부터 앵커를 보고, 돌아올 때 다음 호출이 이어 볼 위치로 옮긴다. 같은 scan으로 묶을 수 있는 만큼
+  // 이어 부르면 재확인 한 번이 앵커마다 한 번씩만 시도해 O(n · (log n + size))다. now는 호출마다 같아야 한다.
+  bool PopMatch(std::chrono::steady_clock::time_point now, std::size_t size, std::vector<MatchTicket>& out,
+                Scan& scan);
+  // 처음부터 한 번 훑는다. O(n · (log n + size)).
+  bool PopMatch(std::chrono::steady_clock::time_point now, std::size_t size, std::vector<MatchTicket>& out) {
+    Scan scan;
+    return PopMatch(now, size, out, scan);
+  }
+  // 방금 들어온 user_id를 앵커로 한 번만 시도한다. 후보는 앵커 창이나 후보 자신의 창 중 넓은 쪽 안에 있으면 고른다.
+  // 오래 기다려 창이 넓어진 대기자가 새 입장자를 바로 받을 수 있다. 어떤 대기자의 창도 가장 오래 기다린 대기자의 창보다
+  // 넓지 않으므로 그 창(상한 max_window 이하) 안의 대기자만 가까운 순으로 보며 O(log n + 그 안의 대기자 수)다.
+  bool PopMatchFor(int user_id, std::chrono::steady_clock::time_point now, std::size_t size,
+                   std::vector<MatchTicket>& out);
+
+  // expires_at이 now 이하인 티켓을 빼서 만료 순으로 expired 뒤에 붙이고 개수를 반환한다.
+  // 만료 시각 힙에서 꺼내므로 O(만료 수 · log n)이며, 만료되지 않은 티켓은 보지 않는다.
+  std::size_t RemoveExpired(std::chrono::steady_clock::time_point now, std::vector<MatchTicket>& expired);
+  // 가장 이른 만료 시각. 이미 빠진 티켓의 시각일 수 있으므로(그때는 일찍 깨어 아무것도 안 뺀다) 잠들 시각 상한으로만 쓴다.
+  std::optional<std::chrono::steady_clock::time_point> NextDeadline() const;
+
+ private:
+  // (rating, 입장 순번). 같은 레이팅은 먼저 들어온 순서로 놓인다.
+  using RatingKey = std::pair<int, std::uint64_t>;
+
+  void PushDeadline(std::chrono::steady_clock::time_point expires_at, std::uint64_t seq);
+  // candidate_window가 true면 후보 자신의 창도 허용 범위로 본다.
+  bool TryAnchor(std::uint64_t anchor_seq, std::chrono::steady_clock::time_point now, std::size_t size,
+                 bool candidate_window, std::vector<MatchTicket>& out);
+  void Erase(std::uint64_t seq);
+
+  MatchmakingConfig config_;
+  std::uint64_t next_seq_{1};
+  // 입장 순번 순서(가장 오래 기다린 티켓이 앞). 티켓 본체를 보관한다.
+  std::map<std::uint64_t, MatchTicket> tickets_;
+  std::set<RatingKey> by_rating_;
+  // (입장 시각, 입장 순번). 맨 앞 티켓의 창이 가장 넓다. 세션을 만들지 못해 다시 넣은 티켓은 원래 입장 시각을 가지므로
+  // 입장 순번 순서(tickets_)로는 가장 오래 기다린 티켓을 알 수 없다.
+  std::set<std::pair<std::chrono::steady_clock::time_point, std::uint64_t>> by_joined_;
+  std::unordered_map<int, std::uint64_t> seq_of_user_;
+  // (만료 시각, 입장 순번) 최소 힙. 매치/취소로 빠진 티켓은 지우지 않고 꺼낼 때 건너뛴다(순번은 재사용하지 않는다).
+  // 죽은 항목이 살아 있는 티켓의 두 배를 넘으면 다시 쌓아 메모리를 묶어 둔다.
+  using Deadline = std::pair<std::chrono::steady_clock::time_point, std::uint64_t>;
+  std::vector<Deadline> deadlines_;
+  // PopMatch가 고른 색인 위치를 담는 버퍼. 호출마다 용량을 재사용한다.
+  std::vector<std::set<RatingKey>::iterator> picked_;
+};
+
+}  // namespace server
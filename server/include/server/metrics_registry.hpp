@@ -0,0 +1,87 @@
+/*
+ * 설명: 스레드별 캐시 라인 정렬 슬롯에 카운터를 누적하고 조회 시에만 합산하는 메트릭 레지스트리.
+ * 버전: v1.0.0
+ * 관련 문서: design/ops/v0.7.0-observability.md
+ * 테스트: server/tests/unit/metrics_registry_test.cpp
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace server {
+
+enum class Counter : std::size_t {
+  kRequestTotal,
+  kRequestErrors,
+  kWebsocketActive,  // 게이지: 연결/해제를 +1/-1 델타로 기록한다.
+  kRollbackCorrections,
+  kResimulatedTicks,
+  kDegradedSessions,  // 게이지: 기본보다 긴 틱 간격으로 낮춰진 세션 수
+  kFullStateFrames,
+  kHashStateFrames,
+  kDesyncReports,
+  kDesyncConfirmed,
+  kFanoutFrames,
+  kFanoutPlayerEntries,
+  kTickPasses,
+  kTickPassSessions,
+  kSessionPoolHits,
+  kSessionPoolMisses,
+  kResultBatches,
+  kResultRecords,
+  kResultDuplicates,
+  kMigrationsExported,
+  kMigrationsImported,
+  kMigrationsFailed,
+  kMigrationsInDoubt,
+  kMigrationsAborted,
+  kAdmissionRejectedSessions,
+  kAdmissionRejectedTickLateness,
+  kAdmissionRejectedLoopLag,
+  kAdmissionDeferredPairs,
+  kSpectatorsActive,  // 게이지: 관전 구독 등록/해제를 +1/-N 델타로 기록한다.
+  kSpectatorFrames,
+  kSpectatorFramesDropped,
+  kMatchesFormed,
+  kCount,
+};
+
+class MetricsRegistry {
+ public:
+  static constexpr std::size_t kCacheLineSize = 64;
+
+  MetricsRegistry();
+  MetricsRegistry(const MetricsRegistry&) = delete;
+  MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+  // 호출 스레드 전용 슬롯에 더한다. 슬롯은 해당 스레드만 기록하므로 lock/RMW가 없다.
+  void Add(Counter counter, std::int64_t delta = 1) {
+    auto& value = LocalShard().values[static_cast<std::size_t>(counter)];
+    value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+  }
+
+  // 모든 스레드 슬롯을 합산한다. /metrics, /ops/status 조회 시에만 호출된다.
+  std::int64_t Sum(Counter counter) const;
+  std::size_t ShardCount() const;
+
+ private:
+  struct alignas(kCacheLineSize) Shard {
+    std::array<std::atomic<std::int64_t>, static_cast<std::size_t>(Counter::kCount)> values{};
+  };
+
+  Shard& LocalShard();
+  Shard& RegisterShard();
+
+  const std::uint64_t id_;
+  mutable std::mutex mutex_;
+  // 스레드가 종료되어도 누적값을 유지하기 위해 레지스트리가 슬롯을 소유한다.
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+}  // namespace server
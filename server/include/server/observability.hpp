@@ -6,11 +6,21 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 
+#include "server/admission.hpp"
+#include "server/histogram.hpp"
+#include "server/loop_monitor.hpp"
+#include "server/match_trace.hpp"
+#include "server/metrics_registry.hpp"
+
 namespace server {
 
 struct LogContext {
@@ -21,28 +31,108 @@ struct LogContext {
   long latency_ms{0};
 };
 
+// 큐 모드 하나의 대기 인원과 matchmaker가 아직 꺼내지 않은 명령 수.
+struct QueueModeSnapshot {
+  std::string mode;
+  std::uint64_t length{0};
+  std::uint64_t pending_commands{0};
+};
+
 struct MetricsSnapshot {
   std::uint64_t request_total{0};
   std::uint64_t request_errors{0};
   std::uint64_t websocket_active{0};
   std::uint64_t active_sessions{0};
-  std::uint64_t queue_length{0};
+  std::vector<QueueModeSnapshot> queues;
+  std::uint64_t degraded_sessions{0};
+
+  // 모든 모드의 대기 인원 합계.
+  std::uint64_t QueueLengthTotal() const;
 };
 
+// 세션 이전 한 건의 결과. 원본은 kExported/kFailed/kInDoubt, 대상은 kImported/kAborted(원본 취소로 내린 세션)를 기록한다.
+enum class MigrationOutcome { kExported, kImported, kFailed, kInDoubt, kAborted };
+
 class Observability {
  public:
+  explicit Observability(std::size_t trace_sample_every = 100) : tracer_(trace_sample_every) {}
+
   std::string NextTraceId();
   void IncrementRequest();
   void IncrementError();
-  void SetWebsocketActive(std::uint64_t count);
-  MetricsSnapshot Snapshot(std::uint64_t active_sessions, std::uint64_t queue_length) const;
+  void WebsocketOpened();
+  void WebsocketClosed();
+  void SessionDegraded(bool degraded);
+  void RecordResimulation(int ticks, std::chrono::microseconds elapsed);
+  nlohmann::json RollbackJson() const;
+  // 틱마다 보낸 상태 프레임 종류(전체/해시 전용)와 클라이언트 해시 불일치 보고를 기록한다.
+  void RecordStateFrame(bool full);
+  void RecordDesyncReport(bool confirmed);
+  nlohmann::json StateSyncJson() const;
+  // 틱 상태 전파 한 번의 수신자 수, 수신자별 목록에 담긴 플레이어 수 합계, 직렬화/전송 소요 시간을 기록한다.
+  void RecordFanout(std::size_t recipients, std::size_t player_entries, std::chrono::microseconds elapsed);
+  nlohmann::json FanoutJson() const;
+  // 틱 레인 패스 한 번에 함께 진행한 세션 수, 시뮬레이션 진행(스텝 단계)에 쓴 시간 합(step),
+  // 패스 시작부터 마지막 전파 조각까지의 시간(pass, 조각 사이에 처리한 입력 등 포함)을 기록한다.
+  void RecordTickPass(std::size_t sessions, std::chrono::microseconds step, std::chrono::microseconds pass);
+  nlohmann::json TickBatchJson() const;
+  // 세션 생성 시 재사용 풀에서 컨텍스트를 꺼냈는지(hit) 새로 할당했는지(miss)를 기록한다.
+  void RecordSessionPool(bool hit);
+  nlohmann::json SessionPoolJson(std::uint64_t pooled, std::uint64_t high_water) const;
+  // 결과 finalizer 배치 하나의 반영/중복 건수와, 결과별 세션 종료(Submit) → 레이팅 반영 지연을 기록한다.
+  void RecordResultBatch(std::size_t applied, std::size_t duplicates);
+  void RecordResultLag(std::chrono::microseconds lag);
+  nlohmann::json ResultFinalizerJson(std::uint64_t pending) const;
+  // 세션 이전 결과와, 원본에서 틱을 멈춘 뒤 대상에서 재개하기까지 놓친 틱 수를 기록한다.
+  void RecordMigration(MigrationOutcome outcome);
+  void RecordMigrationPause(std::uint64_t ticks);
+  nlohmann::json MigrationJson() const;
+  // 과부하로 거절한 큐 입장(사유별)과, 큐에 인원이 찼지만 세션 생성을 미룬 횟수를 기록한다.
+  void RecordAdmission(AdmissionVerdict verdict, bool deferred_pair);
+  nlohmann::json AdmissionJson(std::chrono::microseconds tick_lateness) const;
+  // 관전 구독 수와, 틱마다 관전자에게 넣은 프레임 수/느린 연결에서 밀려난 프레임 수/전송 소요 시간을 기록한다.
+  void SpectatorJoined();
+  void SpectatorsLeft(std::size_t count);
+  void RecordSpectatorFanout(std::size_t frames, std::size_t dropped, std::chrono::microseconds elapsed);
+  nlohmann::json SpectatorJson() const;
+  // 큐 모드별 대기 시간/매치 수를 따로 모은다. 서버 시작 전(요청 처리 전) 모드마다 한 번 등록하고 받은 번호로 기록한다.
+  static constexpr std::size_t kNoQueueMode = static_cast<std::size_t>(-1);
+  std::size_t RegisterQueueMode(const std::string& mode);
+  // 매칭된 플레이어별 큐 대기 시간과, 매치 하나의 레이팅 차이(최고 - 최저)를 전체와 모드별로 기록한다.
+  void RecordMatchmakingWait(std::size_t mode, std::chrono::microseconds wait);
+  void RecordMatchFormed(std::size_t mode, int rating_gap);
+  // 큐 입장/취소 명령 하나가 제출된 뒤 matchmaker 스레드가 꺼내기까지의 지연을 기록한다.
+  void RecordMatchmakerCommand(std::chrono::microseconds lag);
+  nlohmann::json MatchmakingJson(std::uint64_t pending_commands) const;
+  // {"length": 합계, "modes": {모드: {"length", "pendingCommands", "matches", "wait"}}}
+  nlohmann::json QueueJson(const std::vector<QueueModeSnapshot>& queues) const;
+  MetricsSnapshot Snapshot(std::uint64_t active_sessions, std::vector<QueueModeSnapshot> queues) const;
   void Log(const LogContext& ctx) const;
+  MatchTracer& Tracer() { return tracer_; }
+  LoopMonitor& Loop() { return loop_monitor_; }
 
  private:
-  std::atomic<std::uint64_t> request_total_{0};
-  std::atomic<std::uint64_t> request_errors_{0};
-  std::atomic<std::uint64_t> websocket_active_{0};
+  MetricsRegistry metrics_;
+  Histogram resimulation_latency_{LatencyBucketsMicros()};
+  Histogram fanout_latency_{LatencyBucketsMicros()};
+  Histogram tick_step_latency_{LatencyBucketsMicros()};
+  Histogram tick_pass_latency_{LatencyBucketsMicros()};
+  Histogram result_lag_{LatencyBucketsMicros()};
+  Histogram spectator_fanout_latency_{LatencyBucketsMicros()};
+  Histogram matchmaking_wait_{LatencyBucketsMicros()};
+  Histogram matchmaker_command_lag_{LatencyBucketsMicros()};
+  Histogram match_rating_gap_{{0, 10, 25, 50, 100, 150, 200, 300, 400, 600, 800}};
+  Histogram migration_pause_ticks_{{1, 2, 3, 4, 6, 8, 12, 16, 24, 32, 64, 128}};
+  struct QueueModeMetrics {
+    std::string mode;
+    Histogram wait{LatencyBucketsMicros()};
+    std::atomic<std::uint64_t> matches{0};
+  };
+  // 등록은 서버 시작 전에만 하므로 이후 기록/조회는 잠금 없이 읽는다.
+  std::vector<std::unique_ptr<QueueModeMetrics>> queue_modes_;
   std::atomic<std::uint64_t> trace_counter_{0};
+  MatchTracer tracer_;
+  LoopMonitor loop_monitor_;
 };
 
 }  // namespace server
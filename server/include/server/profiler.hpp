@@ -0,0 +1,37 @@
+/*
+ * 설명: SIGPROF 기반 스택 샘플러로 io_context 워커 스레드의 CPU 사용 위치를 folded stack으로 수집한다.
+ * 버전: v1.0.0
+ * 관련 문서: design/ops/v1.0.0-runbook.md, design/protocol/contract.md
+ * 테스트: server/tests/e2e/metrics_ops_test.cpp
+ */
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace server {
+
+struct ProfileResult {
+  std::size_t samples{0};
+  std::size_t dropped{0};
+  int frequency_hz{0};
+  // flamegraph.pl/speedscope 입력 형식: "root;...;leaf count" 줄 목록.
+  std::string folded;
+};
+
+// 시그널 핸들러가 프로세스 전역이므로 상태도 프로세스 전역으로 하나만 둔다.
+class SamplingProfiler {
+ public:
+  static constexpr int kDefaultFrequencyHz = 99;
+  static constexpr std::size_t kMaxSamples = 16384;
+  static constexpr int kMaxDepth = 48;
+
+  // 현재 스레드를 샘플 대상 워커로 표시한다. 미등록 스레드에서 받은 샘플은 버린다.
+  static void RegisterCurrentThread(int worker_index);
+  // 이미 수집 중이면 false를 돌려준다.
+  static bool Start(int frequency_hz = kDefaultFrequencyHz);
+  static ProfileResult Stop();
+  static bool Running();
+};
+
+}  // namespace server
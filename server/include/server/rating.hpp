@@ -11,6 +11,7 @@
 #include <optional>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace server {
@@ -24,6 +25,12 @@ struct RatingSummary {
   int matches() const { return wins + losses; }
 };
 
+// 배치 반영 단위. users는 EnsureUser와 같이 등록/이름 갱신할 (user_id, username), ranked_user_ids는 최종 순위다.
+struct RankedMatchResult {
+  std::vector<std::pair<int, std::string>> users;
+  std::vector<int> ranked_user_ids;
+};
+
 struct LeaderboardPage {
   std::size_t total;
   std::vector<RatingSummary> entries;
@@ -31,10 +38,18 @@ struct LeaderboardPage {
 
 class RatingService {
  public:
+  // 기록이 없는 사용자의 레이팅.
+  static constexpr int kInitialRating = 1000;
+
   RatingService();
 
   void EnsureUser(int user_id, const std::string& username);
   RatingSummary ApplyMatchResult(int winner_id, int loser_id);
+  // 최종 순위(1위부터) 순서의 N인 결과를 쌍별 Elo로 반영한다. 각 쌍에서 앞 순위가 승리한 것으로 보고
+  // K/(N-1)을 적용하므로 2인일 때 ApplyMatchResult와 같은 결과가 된다. 1위는 승, 나머지는 패로 집계한다.
+  std::vector<RatingSummary> ApplyRankedResult(const std::vector<int>& ranked_user_ids);
+  // 여러 매치 결과를 잠금 한 번으로 주어진 순서대로 반영한다. 각 결과는 EnsureUser 후 ApplyRankedResult와 같다.
+  void ApplyRankedResults(const std::vector<RankedMatchResult>& results);
   std::optional<RatingSummary> GetSummary(int user_id);
   LeaderboardPage GetLeaderboard(std::size_t page, std::size_t size);
 
@@ -47,12 +62,12 @@ class RatingService {
   };
 
   double ExpectedScore(int rating_a, int rating_b) const;
-  int ApplyElo(int rating, double expected, double score) const;
+  void EnsureUserLocked(int user_id, const std::string& username);
+  void ApplyRankedLocked(const std::vector<int>& ranked_user_ids, std::vector<RatingSummary>* summaries);
 
   std::unordered_map<int, Entry> entries_;
   mutable std::mutex mutex_;
   const int k_factor_ = 32;
-  const int initial_rating_ = 1000;
 };
 
 }  // namespace server
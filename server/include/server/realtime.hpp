@@ -19,6 +19,9 @@ namespace server {
 
 class WebSocketSession;
 
+// 한 번 직렬화한 WS 프레임. 여러 수신자의 송신 큐가 복사 없이 같은 버퍼를 참조한다.
+using SharedFrame = std::shared_ptr<const std::string>;
+
 class RealtimeCoordinator : public std::enable_shared_from_this<RealtimeCoordinator> {
  public:
   void SetObservability(const std::shared_ptr<Observability>& observability) { observability_ = observability; }
@@ -26,6 +29,7 @@ class RealtimeCoordinator : public std::enable_shared_from_this<RealtimeCoordina
   void Unregister(int user_id, const WebSocketSession* session);
   void SendEventToUser(int user_id, const std::string& event, const nlohmann::json& payload);
   void SendErrorToUser(int user_id, const std::string& code, const std::string& message);
+  void SendFrameToUser(int user_id, const SharedFrame& frame);
   std::size_t ActiveConnections() const;
 
  private:
@@ -12,6 +12,7 @@
 #include <optional>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 
@@ -19,18 +20,24 @@ namespace server {
 
 struct MatchResultRecord {
   std::string session_id;
-  int user1_id;
-  int user2_id;
+  // 최종 순위(1위부터) 순서의 참가자 user_id. 위치 내림차순, 동점은 user_id 오름차순이다.
+  std::vector<int> ranked_user_ids;
   int winner_user_id;
   int tick_count;
   std::chrono::system_clock::time_point ended_at;
   nlohmann::json snapshot;
+  // 세션에서 수락된 입력 저널(InputJournal 형식). replay 도구로 snapshot을 재현할 수 있다.
+  std::string input_journal;
 };
 
 class ResultRepository {
  public:
  bool SaveIfAbsent(const MatchResultRecord& record);
+  // 여러 결과를 잠금 한 번으로 저장한다. 이미 있는 session_id는 건너뛰고 저장한 개수를 돌려준다.
+  std::size_t SaveAllIfAbsent(std::vector<MatchResultRecord>&& records);
   bool Exists(const std::string& session_id) const;
+  // 잠금 한 번으로 각 session_id의 저장 여부를 같은 순서로 돌려준다.
+  std::vector<bool> ExistsAll(const std::vector<std::string>& session_ids) const;
   std::size_t Count() const;
   std::optional<MatchResultRecord> Find(const std::string& session_id) const;
 
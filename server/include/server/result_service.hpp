@@ -2,34 +2,85 @@
  * 설명: 결과 저장과 레이팅 반영을 묶어 중복 적용을 방지한다.
  * 버전: v1.0.0
  * 관련 문서: design/protocol/contract.md, design/server/v0.6.0-rating-leaderboard.md
- * 테스트: server/tests/e2e/rating_leaderboard_test.cpp
+ * 테스트: server/tests/unit/result_service_test.cpp, server/tests/e2e/rating_leaderboard_test.cpp
  */
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "server/observability.hpp"
 #include "server/rating.hpp"
 #include "server/result_repository.hpp"
+#include "server/wake_signal.hpp"
 
 namespace server {
 
-struct SessionParticipant;
+struct SessionParticipant {
+  int user_id;
+  std::string username;
+};
 
+// 종료된 매치 결과를 finalizer 스레드가 배치로 저장/레이팅 반영한다.
+// 세션 strand는 Submit으로 잠금 없는 스택에 넣고 바로 돌아가므로 저장소/레이팅 잠금을 기다리지 않는다.
 class ResultService {
  public:
+  // 한 번에 반영하는 최대 결과 수. 쌓인 결과가 더 많으면 여러 배치로 나눈다.
+  static constexpr std::size_t kMaxBatchSize = 256;
+
   ResultService(std::shared_ptr<ResultRepository> repository, std::shared_ptr<RatingService> rating_service);
+  ~ResultService();
+  void SetObservability(const std::shared_ptr<Observability>& observability) { observability_ = observability; }
 
+  // finalizer 스레드를 시작/정지한다. Stop은 남은 결과를 모두 반영한 뒤 돌아온다.
+  void Start();
+  void Stop();
+  // 결과를 finalizer 큐에 넣는다. finalizer가 시작되지 않았으면 호출 스레드에서 바로 반영한다.
+  void Submit(MatchResultRecord record, std::vector<SessionParticipant> participants);
+  // 호출 스레드에서 바로 반영한다. 같은 session_id가 이미 반영됐으면 false를 돌려준다.
   bool FinalizeResult(const MatchResultRecord& record, const std::vector<SessionParticipant>& participants);
+  std::size_t PendingCount() const { return pending_.load(std::memory_order_relaxed); }
   std::size_t Count() const { return repository_->Count(); }
   std::optional<MatchResultRecord> Find(const std::string& session_id) const { return repository_->Find(session_id); }
   std::shared_ptr<RatingService> GetRatingService() { return rating_service_; }
 
  private:
+  struct PendingResult {
+    MatchResultRecord record;
+    std::vector<SessionParticipant> participants;
+    std::chrono::steady_clock::time_point submitted_at;
+  };
+  struct Node {
+    PendingResult item;
+    Node* next = nullptr;
+  };
+
+  void RunFinalizer();
+  // 쌓인 결과를 모두 꺼내 제출 순서대로 배치 반영하고 꺼낸 개수를 돌려준다.
+  std::size_t Drain();
+  // 반영한(중복이 아닌) 결과 수를 돌려준다.
+  std::size_t ApplyBatch(std::vector<PendingResult>& batch);
+
   std::shared_ptr<ResultRepository> repository_;
   std::shared_ptr<RatingService> rating_service_;
+  std::shared_ptr<Observability> observability_;
+
+  // 다중 생산자 push 전용 스택. 소비자는 exchange로 통째로 가져가 뒤집어 FIFO로 처리한다.
+  std::atomic<Node*> head_{nullptr};
+  std::atomic<std::size_t> pending_{0};
+  std::atomic<bool> running_{false};
+  std::thread finalizer_;
+  // 결과가 없으면 finalizer는 이 신호만 기다린다(주기적으로 깨지 않는다).
+  WakeSignal wake_;
+  // finalizer와 동기 FinalizeResult를 직렬화한다. 중복 확인 → 레이팅 → 저장 순서가 원자적으로 보이게 한다.
+  std::mutex apply_mutex_;
 };
 
 }  // namespace server
@@ -6,11 +6,17 @@
  */
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -20,16 +26,27 @@
 
 #include <nlohmann/json.hpp>
 
+#include "server/admission.hpp"
+#include "server/input_journal.hpp"
+#include "server/interest_filter.hpp"
+#include "server/observability.hpp"
 #include "server/realtime.hpp"
 #include "server/result_service.hpp"
+#include "server/session_migration.hpp"
 #include "server/simulation.hpp"
+#include "server/tick_governor.hpp"
 
 namespace server {
 
-struct SessionParticipant {
-  int user_id;
-  std::string username;
-};
+// 서버 내부 세션 식별자. 문자열 "session-N"은 WS 페이로드/결과 저장 등 외부 경계에서만 FormatSessionId로 만든다.
+using SessionId = std::uint64_t;
+inline constexpr SessionId kInvalidSessionId = 0;
+
+std::string FormatSessionId(SessionId id);
+// out의 기존 용량을 재사용해 같은 문자열을 쓴다.
+void FormatSessionId(SessionId id, std::string& out);
+// "session-N"을 SessionId로 되돌린다. 형식이 다르면 kInvalidSessionId.
+SessionId ParseSessionId(std::string_view wire_id);
 
 struct SessionInput {
   std::string session_id;
@@ -39,51 +56,322 @@ struct SessionInput {
   int delta;
 };
 
+// 클라이언트가 자신이 계산한 틱 상태 해시가 서버 해시(session.hash)와 다르다고 보고한 내용.
+struct StateHashReport {
+  std::string session_id;
+  int user_id;
+  int tick;
+  std::uint64_t state_hash;
+};
+
+// 관전 구독 옵션. interval_ticks마다 한 번, delay_ticks만큼 지난 틱의 session.state를 받는다.
+struct SpectateOptions {
+  int interval_ticks{1};
+  int delay_ticks{0};
+};
+
 class SessionManager : public std::enable_shared_from_this<SessionManager> {
  public:
+  // 한 세션 참가자 수 상한. 상태 전파가 참가자 수의 제곱에 비례하므로 제한한다.
+  static constexpr std::size_t kMaxSessionPlayers = 64;
+
   SessionManager(boost::asio::io_context& ioc, std::shared_ptr<RealtimeCoordinator> coordinator,
                  std::shared_ptr<ResultService> result_service, std::chrono::milliseconds tick_interval,
                  std::size_t max_ticks);
 
-  std::string CreateSession(const std::vector<SessionParticipant>& participants);
+  void SetObservability(const std::shared_ptr<Observability>& observability) { observability_ = observability; }
+  void SetRollbackWindow(int ticks) { rollback_window_ticks_ = ticks; }
+  // 세션별 틱 간격 조절 상한. tick_interval 이하이면 조절하지 않는다.
+  void SetMaxTickInterval(std::chrono::milliseconds max_interval) { governor_config_.max_interval = max_interval; }
+  // 전체 상태를 보내는 틱 주기(1이면 매 틱). 그 사이 틱에는 session.hash만 보낸다.
+  void SetFullStateEvery(std::size_t ticks) { full_state_every_ = ticks; }
+  // 수신자별 session.state에 담을 플레이어를 고른다. 기본은 모든 플레이어(AllPlayersFilter).
+  void SetInterestFilter(std::shared_ptr<const InterestFilter> filter) { interest_filter_ = std::move(filter); }
+  // 틱마다 예정 시각 대비 지연을 입장 제어에 알린다.
+  void SetAdmissionController(std::shared_ptr<AdmissionController> admission) { admission_ = std::move(admission); }
+  // 세션 전체의 평활된 틱 지연(입장 제어 미설정 또는 최근 틱이 없으면 0).
+  std::chrono::microseconds TickLateness() const {
+    return admission_ ? admission_->TickLateness() : std::chrono::microseconds(0);
+  }
+  // 참가자가 없거나 kMaxSessionPlayers를 넘거나, 이미 다른 세션에 참가 중인 사용자가 있으면
+  // 세션을 만들지 않고 kInvalidSessionId를 돌려준다.
+  SessionId CreateSession(const std::vector<SessionParticipant>& participants);
   bool IsUserInSession(int user_id) const;
   bool SubmitInput(const SessionInput& input, std::string& error_code, std::string& error_message);
+  // 보고한 틱의 서버 해시와 비교해 불일치를 집계하고, 보고자에게 현재 틱 전체 상태를 보낸다.
+  bool ReportDesync(const StateHashReport& report, std::string& error_code, std::string& error_message);
   std::size_t ResultCount() const { return result_service_->Count(); }
-  std::size_t ActiveSessionCount() const;
+  std::size_t PendingResultCount() const { return result_service_->PendingCount(); }
+  std::optional<MatchResultRecord> FindResult(const std::string& session_id) const {
+    return result_service_->Find(session_id);
+  }
+  // 세션 생성/종료 시 갱신하는 카운터를 읽는다(잠금 없음).
+  std::size_t ActiveSessionCount() const { return active_sessions_.load(std::memory_order_relaxed); }
+  // 재사용 대기 중인 세션 컨텍스트 수와 그 최댓값.
+  std::size_t PooledContextCount() const { return pooled_contexts_.load(std::memory_order_relaxed); }
+  std::size_t PoolHighWater() const { return pool_high_water_.load(std::memory_order_relaxed); }
+
+  // 세션 이전(원본 측). 틱을 멈추고 이전 단위를 만든다. 이후 CompleteMigration, AbortMigration,
+  // MarkMigrationInDoubt 중 하나를 호출한다. target은 대상 주소("host:port")다.
+  // 결과를 알 수 없던 세션은 같은 대상으로만 다시 보낼 수 있고, 이때 같은 migrationId의 이전 단위를 만들고 retrying을 켠다.
+  bool PauseForMigration(const std::string& session_id, const std::string& target, SessionExport& out, bool& retrying,
+                         std::string& error_code, std::string& error_message);
+  // 대상에 사본이 없음을 확인했으면 멈춘 틱을 그대로 이어 간다.
+  void AbortMigration(const std::string& session_id);
+  // 대상이 세션을 받았는지 알 수 없다. 두 사본이 함께 진행되지 않도록 틱을 멈추고 입력을 거절한 채로 둔다.
+  void MarkMigrationInDoubt(const std::string& session_id);
+  // 참가자에게 session.migrated(대상 주소/토큰)를 보내고 결과 기록 없이 세션을 내린다.
+  bool CompleteMigration(const std::string& session_id, const MigrationAccepted& accepted, const std::string& target_host,
+                         std::string& error_code, std::string& error_message);
+  // 세션 이전(대상 측). 저널을 재생해 같은 틱/해시로 복원한 뒤 참가자 복귀(session.resume)를 기다린다.
+  // 모든 참가자가 복귀하거나 복귀 대기 시간이 지나면 틱을 재개한다.
+  // 이미 받은 migrationId면 새로 만들지 않고 그 세션 id를 돌려준다. 취소된 id는 migration_aborted,
+  // 아직 받는 중인 id는 migration_in_progress로 거절한다.
+  SessionId ImportSession(const SessionExport& exported, std::string& error_code, std::string& error_message);
+  // 원본이 결과를 모르는 이전을 취소한다. 받은 적 없거나 받는 중인 id는 취소 표시를 남겨 이후 도착해도 받지 않는다.
+  // 받은 세션은 아무 참가자도 복귀하지 않았으면 결과 기록 없이 내리고, 이미 진행했으면 migration_committed로 거절한다.
+  bool AbortImport(const std::string& migration_id, std::string& error_code, std::string& error_message);
+  bool ResumeMigratedUser(int user_id, const std::string& session_id, std::string& error_code,
+                          std::string& error_message);
+  void SetMigrationResumeTimeout(std::chrono::milliseconds timeout) { migration_resume_timeout_ = timeout; }
+
+  // 세션당 관전자 수 상한과 허용하는 최대 지연 틱 수. 지연 프레임은 이 틱 수만큼만 보관한다.
+  void SetSpectatorLimits(std::size_t max_per_session, int max_delay_ticks) {
+    max_spectators_per_session_ = max_per_session;
+    max_spectator_delay_ticks_ = std::max(max_delay_ticks, 0);
+  }
+  // 참가자가 아닌 사용자를 관전자로 등록하고 session.spectating을 보낸다. 이후 틱마다 한 번 직렬화한
+  // session.state를 모든 관전자가 공유하며, 세션이 끝나면 같은 session.ended를 받는다.
+  bool Spectate(const std::string& session_id, int user_id, const std::shared_ptr<WebSocketSession>& viewer,
+                const SpectateOptions& options, std::string& error_code, std::string& error_message);
+  void Unspectate(const std::string& session_id, const WebSocketSession* viewer);
 
  private:
+  // desync 보고를 검증할 수 있는 최근 틱 해시 수.
+  static constexpr std::size_t kHashHistoryTicks = 64;
+
+  struct TickHash {
+    int tick{0};
+    std::uint64_t hash{0};
+  };
+
+  // 세션/사용자 맵을 나눠 담는 샤드 수. 세션은 SessionId, 사용자 매핑은 user_id 기준으로 샤드를 고른다.
+  static constexpr std::size_t kShardCount = 16;
+  // 샤드별로 보관할 종료된 세션 컨텍스트 수 상한. 넘치면 해제한다.
+  static constexpr std::size_t kPoolCapacityPerShard = 64;
+  // 세션 틱을 나눠 맡는 레인 수. 세션은 SessionId % kTickLanes 레인에 속하고, 레인마다 strand와 타이머 하나를 둔다.
+  // 레인끼리는 io 스레드에서 병렬로 진행된다.
+  static constexpr std::size_t kTickLanes = 16;
+  static constexpr std::size_t kNotScheduled = static_cast<std::size_t>(-1);
+  // 레인 패스를 나눠 처리하는 세션 수. 조각마다 strand에 다시 올려, 같은 레인의 입력/관전 요청은 패스 전체가 아니라
+  // 조각 하나만 기다린다.
+  static constexpr std::size_t kLaneSliceSessions = 64;
+
+  struct Spectator {
+    std::weak_ptr<WebSocketSession> session;
+    const WebSocketSession* raw{nullptr};
+    int user_id{0};
+    SpectateOptions options;
+  };
+
+  // 스텝 단계에서 롤백 정정한 상태. 전파 단계에서 session.correction으로 보낸다. from_tick이 0이면 없음.
+  struct PendingCorrection {
+    int from_tick{0};
+    int tick{0};
+    int resimulated_ticks{0};
+    std::uint64_t state_hash{0};
+    std::vector<PlayerView> players;  // 틱마다 용량을 재사용한다.
+  };
+
+  // 지연 관전용으로 보관하는 과거 틱의 관전 프레임.
+  struct SpectatorFrame {
+    int tick{0};
+    SharedFrame frame;
+  };
+
   struct SessionContext : public std::enable_shared_from_this<SessionContext> {
-    std::string id;
+    SessionId id{kInvalidSessionId};
+    std::string wire_id;  // FormatSessionId(id). 페이로드/트레이스/결과 기록에 쓰기 위해 생성 시 한 번만 만든다.
+    std::string trace_id;
+    bool trace_sampled{false};
+    std::chrono::steady_clock::time_point opened_at;
     std::vector<SessionParticipant> participants;
-    std::unordered_map<int, SessionParticipant> participant_map;
+    std::vector<int> participant_ids;  // user_id 오름차순
     Simulation simulation;
+    InputJournal journal;
     boost::asio::strand<boost::asio::io_context::executor_type> strand;
     boost::asio::steady_timer timer;
     std::size_t tick_sent{0};
     bool ended{false};
+    // kExporting: 원본에서 이전 응답 대기(틱 정지, 입력 거절). kInDoubt: 원본에서 대상 수신 여부를 모름(틱 정지, 입력 거절).
+    // kAwaitingResume: 대상에서 참가자 복귀 대기(틱 정지).
+    enum class MigrationState { kNone, kExporting, kInDoubt, kAwaitingResume };
+    MigrationState migration{MigrationState::kNone};
+    std::vector<int> awaiting_resume;
+    std::chrono::system_clock::time_point paused_at;
+    // 원본에서 진행 중이거나 결과를 모르는 이전 시도의 식별자와 대상 주소.
+    std::string migration_id;
+    std::string migration_target;
 
-    SessionContext(boost::asio::io_context& ioc, std::chrono::milliseconds interval)
-        : strand(boost::asio::make_strand(ioc)), timer(ioc), tick_interval(interval) {}
+    // strand는 소속 틱 레인의 strand다. 같은 레인의 세션은 입력/틱 처리가 한 strand에서 직렬화된다.
+    SessionContext(boost::asio::io_context& ioc, boost::asio::strand<boost::asio::io_context::executor_type> lane_strand,
+                   const TickGovernorConfig& governor_config)
+        : strand(std::move(lane_strand)), timer(ioc), governor(governor_config),
+          tick_interval(governor_config.base_interval) {}
 
+    TickGovernor governor;
     std::chrono::milliseconds tick_interval;
+    std::chrono::steady_clock::time_point tick_deadline;
+    // 레인 패스 시작 시각 기준 이번 틱의 지연. 같은 패스에서 앞 세션의 전송 시간이 섞이지 않는다.
+    std::chrono::microseconds tick_lateness{0};
+    // 이번 패스의 스텝 단계에서 진행했고 아직 전파하지 않았으면 true.
+    bool pass_stepped{false};
+    PendingCorrection correction;
+    // 틱 레인의 sessions 안 위치. 틱을 예약하지 않았으면 kNotScheduled.
+    std::size_t lane_slot{kNotScheduled};
+    // tick % kHashHistoryTicks 위치에 해당 틱 해시를 보관한다. 롤백으로 바뀐 틱은 tick=0으로 무효화한다.
+    std::vector<TickHash> hash_history = std::vector<TickHash>(kHashHistoryTicks);
+    // 수신자별 관심 플레이어 선택 버퍼. 틱마다 용량을 재사용한다.
+    std::vector<PlayerView> interest_scratch;
+    // 관전자 목록과 지연 관전용 최근 프레임(가장 긴 지연만큼만 보관). strand에서만 접근한다.
+    std::vector<Spectator> spectators;
+    std::deque<SpectatorFrame> spectator_frames;
+
+    bool IsParticipant(int user_id) const {
+      return std::binary_search(participant_ids.begin(), participant_ids.end(), user_id);
+    }
+    // 풀에서 꺼낸 컨텍스트를 새 매치용으로 되돌린다. strand/timer와 모든 버퍼 용량은 유지한다.
+    void Reset(const TickGovernorConfig& governor_config);
+  };
+
+  // 한 레인에 속한 세션들의 틱을 타이머 하나로 묶어 진행한다. 모든 멤버는 레인 strand에서만 접근한다.
+  struct TickLane {
+    explicit TickLane(boost::asio::io_context& ioc) : strand(boost::asio::make_strand(ioc)), timer(ioc) {}
+
+    boost::asio::strand<boost::asio::io_context::executor_type> strand;
+    boost::asio::steady_timer timer;
+    // 다음 틱을 예약한 세션. 종료/이전으로 틱을 멈추면 뺀다.
+    std::vector<std::shared_ptr<SessionContext>> sessions;
+    // 이번 패스에서 만기된 세션. 패스마다 용량을 재사용한다.
+    std::vector<std::shared_ptr<SessionContext>> due;
+    // 타이머가 기다리는 시각. 기다리지 않으면 time_point::max().
+    std::chrono::steady_clock::time_point armed_at{std::chrono::steady_clock::time_point::max()};
+    // 패스 중에는 세션별로 타이머를 다시 걸지 않고 패스가 끝날 때 한 번만 건다.
+    bool stepping{false};
+    // 진행 중인 패스의 단계와 due 안 다음 조각 위치, 시작 시각, 스텝 단계에 쓴 시간 합.
+    bool publishing{false};
+    std::size_t cursor{0};
+    std::chrono::steady_clock::time_point pass_started;
+    std::chrono::steady_clock::duration step_busy{0};
   };
 
+  // 샤드마다 독립 잠금을 둔다. 서로 다른 캐시 라인에 두어 샤드 간 잠금 경합이 섞이지 않게 한다.
+  // 종료된 세션의 맵 노드(extract)와 컨텍스트를 보관했다가 다음 세션에 재사용해 정상 상태의 생성이 할당 없이 끝나게 한다.
+  struct alignas(64) Shard {
+    using SessionMap = std::unordered_map<SessionId, std::shared_ptr<SessionContext>>;
+    using UserMap = std::unordered_map<int, SessionId>;
+
+    mutable std::mutex mutex;
+    SessionMap sessions;
+    UserMap user_to_session;
+    std::vector<SessionMap::node_type> spare_session_nodes;
+    std::vector<UserMap::node_type> spare_user_nodes;
+    // 종료된 컨텍스트. 다른 핸들러가 아직 참조 중일 수 있으므로 use_count()==1일 때만 꺼내 쓴다.
+    std::vector<std::shared_ptr<SessionContext>> idle_contexts;
+  };
+
+  TickLane& LaneFor(SessionId id) { return *lanes_[id % kTickLanes]; }
+  Shard& SessionShardFor(SessionId id) { return shards_[id % kShardCount]; }
+  const Shard& SessionShardFor(SessionId id) const { return shards_[id % kShardCount]; }
+  Shard& UserShardFor(int user_id) { return shards_[static_cast<std::size_t>(user_id) % kShardCount]; }
+  const Shard& UserShardFor(int user_id) const { return shards_[static_cast<std::size_t>(user_id) % kShardCount]; }
+
+  std::shared_ptr<SessionContext> AcquireContext(SessionId id);
+  void ReleaseContext(const std::shared_ptr<SessionContext>& ctx);
+
+  // 세션/사용자 맵에 등록하고 활성 세션 수를 올린다. 해제는 그 반대이며 컨텍스트를 풀로 돌려보낸다.
+  // 이미 다른 세션에 매핑된 참가자가 있으면 아무것도 등록하지 않고 false를 돌려준다.
+  bool RegisterSession(const std::shared_ptr<SessionContext>& ctx);
+  // 참가자 앞쪽 count명의 사용자 매핑 중 이 세션을 가리키는 것만 지운다.
+  void UnmapUsers(const std::shared_ptr<SessionContext>& ctx, std::size_t count);
+  void UnregisterSession(const std::shared_ptr<SessionContext>& ctx);
+  std::shared_ptr<SessionContext> FindSession(const std::string& session_id, std::string& error_code,
+                                              std::string& error_message) const;
+  std::shared_ptr<SessionContext> FindUserSession(int user_id, std::string& error_code,
+                                                  std::string& error_message) const;
+  nlohmann::json StatePayload(const std::shared_ptr<SessionContext>& ctx, const SnapshotView& view,
+                              std::uint64_t state_hash) const;
+  // 관심 필터에 따라 session.state를 보낸다. 브로드캐스트 필터면 한 번만 직렬화해 공유하고 그 프레임을 돌려준다.
+  SharedFrame FanOutState(const std::shared_ptr<SessionContext>& ctx, const SnapshotView& view,
+                          std::uint64_t state_hash);
+  // 관전자에게 전체 플레이어 session.state를 보낸다. 틱당 한 번만 직렬화하며 participant_frame이 있으면 그대로 쓴다.
+  void FanOutSpectators(const std::shared_ptr<SessionContext>& ctx, const SnapshotView& view,
+                        std::uint64_t state_hash, SharedFrame participant_frame);
+  // 관전자 전원에게 frame을 보내고 구독을 해제한다.
+  void DropSpectators(const std::shared_ptr<SessionContext>& ctx, const SharedFrame& frame);
+  bool IsFullStateTick(const std::shared_ptr<SessionContext>& ctx, int tick) const;
+
   void StartSession(const std::shared_ptr<SessionContext>& ctx);
-  void BroadcastToParticipants(const std::shared_ptr<SessionContext>& ctx, const std::string& event,
-                               const nlohmann::json& payload);
+  SharedFrame BroadcastToParticipants(const std::shared_ptr<SessionContext>& ctx, const std::string& event,
+                                      nlohmann::json payload);
+  // 세션의 다음 틱 시각을 간격 격자(steady_clock 기준 간격의 배수)에 맞춰 정하고 레인에 올린다.
+  // 같은 간격의 세션은 같은 시각에 만기되므로 레인 패스 하나에서 함께 진행된다.
   void ScheduleTick(const std::shared_ptr<SessionContext>& ctx);
-  void HandleTick(const std::shared_ptr<SessionContext>& ctx);
+  // 레인에서 세션을 빼 틱을 멈춘다. 예약되지 않은 세션이면 아무것도 하지 않는다.
+  void UnscheduleTick(const std::shared_ptr<SessionContext>& ctx);
+  void ArmLane(std::size_t lane_index, std::chrono::steady_clock::time_point at);
+  // 레인 패스. 만기된 세션을 모두 시뮬레이션한 뒤(StepSession), 세션별로 상태를 전파하고 다음 틱을 잡는다.
+  // 두 단계 모두 kLaneSliceSessions개씩 RunLaneSlice로 나눠 진행한다.
+  void RunTickLane(std::size_t lane_index);
+  void RunLaneSlice(std::size_t lane_index);
+  // 스텝 단계. 롤백 정정과 TickOnce만 하며 직렬화/전송은 하지 않는다.
+  void StepSession(const std::shared_ptr<SessionContext>& ctx);
+  // 전파 단계. 정정/해시/상태 프레임을 보내고 종료, 틱 간격 조절, 다음 틱 예약을 한다.
+  void PublishTick(const std::shared_ptr<SessionContext>& ctx);
+  // 늦은 입력으로 바뀐 틱을 다시 계산하고 정정 상태를 ctx->correction에 담는다. 전송은 PublishTick이 한다.
+  void ApplyCorrection(const std::shared_ptr<SessionContext>& ctx);
+  void PublishCorrection(const std::shared_ptr<SessionContext>& ctx);
+  void GovernTickRate(const std::shared_ptr<SessionContext>& ctx, std::chrono::microseconds lateness);
   void FinishSession(const std::shared_ptr<SessionContext>& ctx);
+  void ResumeAfterMigration(const std::shared_ptr<SessionContext>& ctx);
+  // 아무도 복귀하지 않은 이전받은 세션을 결과 기록 없이 내린다. 이미 진행했거나 없으면 false.
+  bool DropImportedSession(SessionId id);
+  void PruneImportRecords(std::chrono::steady_clock::time_point now);
+  void TraceSessionEvent(const std::shared_ptr<SessionContext>& ctx, MatchEvent event);
 
   boost::asio::io_context& ioc_;
   std::shared_ptr<RealtimeCoordinator> coordinator_;
   std::shared_ptr<ResultService> result_service_;
+  std::shared_ptr<Observability> observability_;
   std::chrono::milliseconds tick_interval_;
+  TickGovernorConfig governor_config_;
   std::size_t max_ticks_;
-  std::size_t next_session_id_{1};
-  std::unordered_map<std::string, std::shared_ptr<SessionContext>> sessions_;
-  std::unordered_map<int, std::string> user_to_session_;
-  mutable std::mutex mutex_;
+  int rollback_window_ticks_{0};
+  std::size_t full_state_every_{1};
+  std::chrono::milliseconds migration_resume_timeout_{3000};
+  std::size_t max_spectators_per_session_{10000};
+  int max_spectator_delay_ticks_{600};
+  std::shared_ptr<const InterestFilter> interest_filter_ = std::make_shared<AllPlayersFilter>();
+  std::shared_ptr<AdmissionController> admission_;
+  std::atomic<SessionId> next_session_id_{1};
+  std::atomic<std::size_t> active_sessions_{0};
+  std::atomic<std::size_t> pooled_contexts_{0};
+  std::atomic<std::size_t> pool_high_water_{0};
+  std::array<Shard, kShardCount> shards_;
+  std::vector<std::unique_ptr<TickLane>> lanes_;
+
+  // 대상 측 migrationId별 수신 기록. kImportRecordTtl 동안 보관해 다시 온 요청과 늦게 온 요청을 가린다.
+  struct ImportRecord {
+    enum class State { kImporting, kImported, kAborted };
+    State state{State::kImporting};
+    SessionId session_id{kInvalidSessionId};
+    std::vector<int> participant_ids;  // user_id 오름차순
+    std::chrono::steady_clock::time_point updated_at;
+  };
+  static constexpr std::chrono::minutes kImportRecordTtl{10};
+  // 잠금 순서는 imports_mutex_ → 샤드 잠금이다.
+  std::mutex imports_mutex_;
+  std::unordered_map<std::string, ImportRecord> imports_;
 };
 
 }  // namespace server
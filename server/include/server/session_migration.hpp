@@ -0,0 +1,99 @@
+/*
+ * 설명: 진행 중인 세션을 다른 서버 프로세스로 옮기기 위한 직렬화 형식과 로컬 TCP 전송을 정의한다.
+ * 버전: v1.0.0
+ * 관련 문서: design/server/v0.5.0-match-session.md, design/protocol/contract.md
+ * 테스트: server/tests/e2e/session_migration_test.cpp
+ */
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include "server/result_service.hpp"
+
+namespace server {
+
+// 이전 요청/응답 한 줄(JSON + '\n')의 최대 크기.
+constexpr std::size_t kMaxMigrationBytes = 4 * 1024 * 1024;
+// 원본 서버가 대상 서버의 응답을 기다리는 최대 시간. 기다리는 동안 io 스레드는 막지 않는다.
+constexpr std::chrono::milliseconds kMigrationTimeout{3000};
+// migrationId 최대 길이. 원본은 NewMigrationId로 32자 16진수를 만든다.
+constexpr std::size_t kMaxMigrationIdBytes = 64;
+
+// 일시정지한 세션의 이전 단위. 시뮬레이션 상태는 입력 저널(참가자/롤백 창/수락된 입력, 미래 틱 대기 입력 포함)을
+// 현재 틱까지 재생해 복원하고, state_hash로 복원 결과가 원본과 같은지 확인한다.
+struct SessionExport {
+  // 이전 시도 식별자. 원본이 결과를 모르는 이전을 다시 보내거나 취소할 때 같은 값을 쓰며, 대상은 이 값으로 중복 수신을 막는다.
+  std::string migration_id;
+  std::string session_id;
+  int tick{0};
+  std::vector<SessionParticipant> participants;
+  std::string journal;
+  std::uint64_t state_hash{0};
+  // 원본에서 틱을 멈춘 시각(system_clock, ms). 같은 호스트 간 이전이므로 대상에서 정지 구간 계산에 쓴다.
+  std::int64_t paused_at_ms{0};
+};
+
+// 대상 서버가 참가자별로 발급한 접속 정보. access_token으로 WS에 접속하고 resume_token으로 세션에 복귀한다.
+struct MigrationTicket {
+  int user_id{0};
+  std::string access_token;
+  std::string resume_token;
+};
+
+struct MigrationAccepted {
+  std::string session_id;
+  int tick{0};
+  unsigned short port{0};
+  std::vector<MigrationTicket> tickets;
+};
+
+// 새 이전 시도 식별자(무작위 16바이트의 16진수).
+std::string NewMigrationId();
+// 이전 요청의 migrationToken을 설정값과 상수 시간에 비교한다. 설정값이 비어 있으면 항상 false.
+bool MigrationTokenMatches(const std::string& expected, const nlohmann::json& request);
+nlohmann::json SessionExportToJson(const SessionExport& exported);
+bool SessionExportFromJson(const nlohmann::json& json, SessionExport& out, std::string& error_message);
+nlohmann::json MigrationAcceptedToJson(const MigrationAccepted& accepted);
+bool MigrationAcceptedFromJson(const nlohmann::json& json, MigrationAccepted& out, std::string& error_message);
+
+// 대상 서버 측 수신기. 127.0.0.1에만 바인드하며 연결마다 요청 한 줄을 읽어 handler 결과를 한 줄로 돌려준다.
+class MigrationListener : public std::enable_shared_from_this<MigrationListener> {
+ public:
+  using Handler = std::function<nlohmann::json(const nlohmann::json& request)>;
+
+  MigrationListener(boost::asio::io_context& ioc, unsigned short port, Handler handler);
+  void Run();
+  void Stop();
+
+ private:
+  void DoAccept();
+
+  boost::asio::io_context& ioc_;
+  boost::asio::ip::tcp::acceptor acceptor_;
+  Handler handler_;
+};
+
+// 이전 전송 결과. ok가 false면 error_message에 사유(시간 초과/연결 실패/응답 해석 실패)가 담긴다.
+// connected가 false면 대상에 연결하지 못해 요청이 전달되지 않은 것이고, true면 요청이 대상에 닿았을 수 있다.
+using MigrationReplyHandler = std::function<void(bool ok, bool connected, const nlohmann::json& reply,
+                                                 const std::string& error_message)>;
+
+// 원본 서버 측 전송. executor 위에서 요청 한 줄을 보내고 응답 한 줄을 받는다. 호출 스레드를 막지 않으며
+// done은 timeout 안에 응답이 오거나 실패/시간 초과가 나면 executor에서 한 번 불린다.
+// executor는 strand처럼 핸들러를 직렬화해야 한다(HTTP 연결의 strand를 그대로 넘긴다).
+void AsyncSendMigration(const boost::asio::ip::tcp::socket::executor_type& executor, const std::string& host,
+                        unsigned short port, const nlohmann::json& request, std::chrono::milliseconds timeout,
+                        MigrationReplyHandler done);
+
+}  // namespace server
@@ -8,10 +8,8 @@
 
 #include <chrono>
 #include <cstdint>
-#include <map>
 #include <string>
 #include <thread>
-#include <unordered_map>
 #include <vector>
 
 #include <nlohmann/json.hpp>
@@ -30,11 +28,47 @@ struct ValidationResult {
   std::string reason;
 };
 
-struct PlayerState {
+struct PlayerView {
+  int user_id{0};
   int position{0};
   std::uint64_t last_sequence{0};
 };
 
+// Simulation 내부 배열을 그대로 가리키는 읽기 전용 뷰. 할당이 없으며 다음 TickOnce/EnqueueInput 전까지 유효하다.
+class SnapshotView {
+ public:
+  SnapshotView(int tick, const std::vector<int>& user_ids, const std::vector<int>& positions,
+               const std::vector<std::uint64_t>& last_sequences, const std::vector<std::uint8_t>& visible)
+      : tick_(tick), user_ids_(user_ids), positions_(positions), last_sequences_(last_sequences), visible_(visible) {}
+
+  int Tick() const { return tick_; }
+
+  // user_id 오름차순으로 스냅샷에 노출되는 플레이어를 순회한다.
+  template <typename Fn>
+  void ForEachPlayer(Fn&& fn) const {
+    for (std::size_t slot = 0; slot < user_ids_.size(); ++slot) {
+      if (visible_[slot]) {
+        fn(PlayerView{user_ids_[slot], positions_[slot], last_sequences_[slot]});
+      }
+    }
+  }
+
+ private:
+  int tick_;
+  const std::vector<int>& user_ids_;
+  const std::vector<int>& positions_;
+  const std::vector<std::uint64_t>& last_sequences_;
+  const std::vector<std::uint8_t>& visible_;
+};
+
+// 스냅샷 JSON 인코딩. 상태 브로드캐스트/결과 저장 등 경계에서 한 번만 호출한다.
+nlohmann::json PlayerToJson(const PlayerView& player);
+nlohmann::json PlayersToJson(const SnapshotView& view);
+nlohmann::json SnapshotToJson(const SnapshotView& view);
+// 틱과 노출 플레이어(user_id 오름차순)의 (user_id, position, last_sequence)를 64비트 워드로 순서대로 섞은 상태 해시.
+// 슬롯 순서가 user_id 순이므로 입장 순서와 무관하며, 클라이언트가 같은 규칙으로 재현할 수 있다(계약 문서 참고).
+std::uint64_t HashSnapshot(const SnapshotView& view);
+
 class Simulation {
  public:
   static constexpr int kTickRate = 60;
@@ -42,28 +76,94 @@ class Simulation {
       std::chrono::nanoseconds(1'000'000'000 / kTickRate)};
   static constexpr int kMaxInputsPerTickPerUser = 4;
   static constexpr int kMaxDelta = 3;
+  // 현재 틱 기준으로 미리 받을 수 있는 미래 입력 범위(틱). 초과 입력은 tick_out_of_window로 거부한다.
+  static constexpr int kInputHorizonTicks = 128;
+  // 롤백 창 상한. 링 버킷을 과거 창과 미래 입력이 나눠 쓰므로 미래 범위는 kInputHorizonTicks - 창 크기가 된다.
+  static constexpr int kMaxRollbackTicks = 32;
+
+  Simulation();
+
+  // 최근 window_ticks 틱 이내의 늦은 입력을 받아 재시뮬레이션한다(0이면 끔). 입력을 받기 전에 호출한다.
+  void EnableRollback(int window_ticks);
+  int RollbackWindow() const { return rollback_window_; }
+
+  // 플레이어/대기 입력/롤백 사본을 모두 비우고 0틱으로 되돌린다. 배열 용량은 유지하므로
+  // 같은 규모의 다음 매치는 할당 없이 시작한다. 롤백 창은 EnableRollback으로 다시 지정한다.
+  void Reset();
 
   ValidationResult EnqueueInput(const InputCommand& input);
   void AddPlayer(int user_id);
+  // 늦은 입력이 들어온 가장 이른 틱(없으면 0).
+  int PendingCorrectionTick() const { return dirty_from_tick_; }
+  // 늦은 입력이 있으면 해당 틱 직전 상태로 되돌린 뒤 현재 틱까지 다시 적용하고 재계산한 틱 수를 돌려준다.
+  // 비용은 창 크기(틱)로 제한된다. TickOnce도 진행 전에 호출한다.
+  int Resimulate();
   void TickOnce();
   void RunForDuration(std::chrono::milliseconds duration);
 
   int CurrentTick() const { return current_tick_; }
-  nlohmann::json Snapshot() const;
+  SnapshotView View() const {
+    return SnapshotView(current_tick_, user_ids_, positions_, last_sequences_, visible_);
+  }
+  nlohmann::json Snapshot() const { return SnapshotToJson(View()); }
+  std::uint64_t StateHash() const { return HashSnapshot(View()); }
 
  private:
-  struct UserTracker {
-    std::uint64_t last_sequence{0};
-    std::unordered_map<int, int> per_tick_count;
+  static constexpr std::size_t kNoSlot = static_cast<std::size_t>(-1);
+
+  // 대기 입력은 user_id 대신 슬롯 인덱스를 보관한다. 슬롯이 user_id 오름차순이므로
+  // (sequence, slot) 정렬은 기존 (sequence, user_id) 정렬과 같은 순서를 만든다.
+  struct PendingInput {
+    std::size_t slot{0};
+    int delta{0};
+    std::uint64_t sequence{0};
+  };
+
+  // 링 버킷은 target_tick % kInputHorizonTicks 위치에 하나의 틱만 담는다.
+  // events는 도착 시 (sequence, slot) 순서로 삽입되고, 틱 처리 후 용량을 유지한 채 비워진다.
+  struct TickBucket {
+    std::vector<PendingInput> events;
+    std::vector<std::uint8_t> counts;  // 슬롯별 해당 틱 입력 수
   };
 
-  bool ValidateInput(const InputCommand& input, std::string& reason) const;
-  void ApplyEvent(const InputCommand& input);
+  TickBucket& BucketFor(int tick) { return ring_[static_cast<std::size_t>(tick % kInputHorizonTicks)]; }
+  const TickBucket& BucketFor(int tick) const {
+    return ring_[static_cast<std::size_t>(tick % kInputHorizonTicks)];
+  }
+
+  // 롤백용 상태 사본. 틱 t를 적용하기 직전 상태를 보관한다.
+  struct SavedState {
+    int tick{0};
+    std::vector<int> positions;
+    std::vector<std::uint64_t> last_sequences;
+    std::vector<std::uint8_t> visible;
+  };
+
+  void ApplyTick(int tick);
+  // 사본 배열 용량은 유지한 채 내용만 비운다.
+  void ClearSavedStates();
+  SavedState& SavedStateFor(int tick) {
+    return saved_states_[static_cast<std::size_t>(tick) % saved_states_.size()];
+  }
+
+  std::size_t FindSlot(int user_id) const;
+  std::size_t EnsureSlot(int user_id);
+  bool ValidateInput(const InputCommand& input, std::size_t slot, std::string& reason) const;
+  void ApplyEvent(const PendingInput& input);
 
   int current_tick_{0};
-  std::map<int, std::vector<InputCommand>> inputs_by_tick_;
-  std::unordered_map<int, UserTracker> trackers_;
-  std::unordered_map<int, PlayerState> players_;
+  std::vector<TickBucket> ring_;
+  int rollback_window_{0};
+  int dirty_from_tick_{0};
+  std::vector<SavedState> saved_states_;
+
+  // 플레이어 상태(SoA). 모든 배열은 같은 슬롯 인덱스를 공유하며 user_id 오름차순이다.
+  std::vector<int> user_ids_;
+  std::vector<int> positions_;
+  std::vector<std::uint64_t> last_sequences_;      // 마지막으로 적용된 시퀀스
+  std::vector<std::uint64_t> accepted_sequences_;  // 마지막으로 큐잉이 허용된 시퀀스
+  // 스냅샷 노출 여부. AddPlayer 또는 첫 입력 적용 시점부터 노출해 기존 스냅샷과 동일하게 유지한다.
+  std::vector<std::uint8_t> visible_;
 };
 
 }  // namespace server
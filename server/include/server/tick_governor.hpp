@@ -0,0 +1,46 @@
+/*
+ * 설명: 틱 지연과 이벤트 루프 지연을 보고 세션별 틱 간격을 설정 범위 안에서 늘리거나 되돌린다.
+ * 버전: v1.0.0
+ * 관련 문서: design/server/v0.5.0-match-session.md, design/protocol/contract.md
+ * 테스트: server/tests/unit/tick_governor_test.cpp
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace server {
+
+struct TickGovernorConfig {
+  std::chrono::milliseconds base_interval{100};
+  // base_interval 이하이면 조절하지 않는다.
+  std::chrono::milliseconds max_interval{100};
+  double step_factor{1.5};
+  // max(틱 지연, 루프 지연)이 간격의 pressure_ratio를 넘으면 압박, relief_ratio 미만이면 여유로 본다.
+  double pressure_ratio{0.25};
+  double relief_ratio{0.05};
+  // 연속 관측 수(히스테리시스). 늦추기는 빠르게, 되돌리기는 천천히 한다.
+  int pressure_ticks{3};
+  int relief_ticks{30};
+};
+
+// 세션 strand에서만 호출한다. 틱 간격은 벽시계 주기만 바꾸며 시뮬레이션 틱 번호/결과에는 영향이 없다.
+class TickGovernor {
+ public:
+  explicit TickGovernor(const TickGovernorConfig& config);
+
+  // 틱 한 번의 관측을 반영하고 간격이 바뀌었으면 true를 돌려준다.
+  bool Observe(std::chrono::microseconds tick_lateness, std::chrono::microseconds loop_lag);
+
+  std::chrono::milliseconds Interval() const { return interval_; }
+  bool Degraded() const { return interval_ > config_.base_interval; }
+  bool Enabled() const { return config_.max_interval > config_.base_interval; }
+
+ private:
+  TickGovernorConfig config_;
+  std::chrono::milliseconds interval_;
+  int pressure_streak_{0};
+  int relief_streak_{0};
+};
+
+}  // namespace server
@@ -0,0 +1,33 @@
+/*
+ * 설명: 잠금 없는 명령 스택의 소비자 스레드를 깨우는 신호. 신호를 잠금 안에서 표시해 놓치지 않는다.
+ * 버전: v1.0.0
+ * 관련 문서: design/server/v0.5.0-match-session.md, design/server/v0.6.0-rating-leaderboard.md
+ * 테스트: server/tests/unit/result_service_test.cpp, server/tests/e2e/session_flow_test.cpp
+ */
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace server {
+
+// 생산자는 Notify, 소비자는 할 일을 모두 처리한 뒤 Wait/WaitUntil을 부른다.
+// 소비자가 잠들기 전에 온 신호는 표시로 남아 있어 다음 대기가 바로 돌아간다(신호 하나는 한 번만 소비된다).
+class WakeSignal {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  void Notify();
+  // 신호가 올 때까지 잔다.
+  void Wait();
+  // 신호가 오거나 deadline이 될 때까지 잔다. 신호를 받았으면 true.
+  bool WaitUntil(Clock::time_point deadline);
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool signaled_{false};
+};
+
+}  // namespace server
@@ -29,12 +29,17 @@ class WebSocketSession : public std::enable_shared_from_this<WebSocketSession> {
                    std::shared_ptr<ReconnectService> reconnect_service,
                    std::shared_ptr<RealtimeCoordinator> coordinator,
                    std::shared_ptr<SessionManager> session_manager, std::size_t max_queue_messages,
-                   std::size_t max_queue_bytes);
+                   std::size_t max_queue_bytes, std::size_t max_spectator_frames);
   ~WebSocketSession();
   void Run();
 
   void SendServerEvent(const std::string& event, const nlohmann::json& payload);
   void SendServerError(const std::string& code, const std::string& message);
+  // 이미 직렬화된 WS 프레임(여러 수신자 공용)을 그대로 전송한다.
+  void SendServerFrame(SharedFrame frame);
+  // 관전 프레임은 별도 큐에 넣어 참가자 백프레셔 한도에 포함하지 않는다.
+  // 큐가 차면 연결을 끊지 않고 가장 오래된 대기 프레임을 버리며, 이때 false를 돌려준다.
+  bool SendSpectatorFrame(SharedFrame frame);
 
  private:
   void DoRead();
@@ -42,10 +47,15 @@ class WebSocketSession : public std::enable_shared_from_this<WebSocketSession> {
   void SendEcho(const nlohmann::json& message, std::uint64_t seq);
   void HandleResyncRequest(const nlohmann::json& message, std::uint64_t seq);
   void HandleSessionInput(const nlohmann::json& message, std::uint64_t seq);
+  void HandleSessionDesync(const nlohmann::json& message, std::uint64_t seq);
+  void HandleSessionResume(const nlohmann::json& message, std::uint64_t seq);
+  void HandleSessionSpectate(const nlohmann::json& message, std::uint64_t seq);
+  void HandleSessionUnspectate(const nlohmann::json& message, std::uint64_t seq);
   void SendError(std::string_view code, std::string_view message, std::uint64_t seq);
   void SendResyncState(std::uint64_t seq);
   void SendAuthState();
   void EnqueueMessage(std::string message);
+  void EnqueueFrame(SharedFrame frame);
   void WriteNext();
   void OnWrite(boost::beast::error_code ec);
   void TriggerBackpressureClose();
@@ -58,12 +68,18 @@ class WebSocketSession : public std::enable_shared_from_this<WebSocketSession> {
   std::shared_ptr<ReconnectService> reconnect_service_;
   std::shared_ptr<RealtimeCoordinator> coordinator_;
   std::shared_ptr<SessionManager> session_manager_;
-  std::deque<std::string> send_queue_;
+  std::deque<SharedFrame> send_queue_;
   std::size_t queued_bytes_{0};
+  // 참가자/제어 큐를 먼저 비우고 남는 대역으로 관전 큐를 보낸다.
+  std::deque<SharedFrame> spectator_queue_;
   bool writing_{false};
+  bool writing_spectator_{false};
   bool closing_{false};
   std::size_t max_queue_messages_;
   std::size_t max_queue_bytes_;
+  std::size_t max_spectator_frames_;
+  // 관전 중인 세션 id(없으면 빈 문자열). 다른 세션을 관전하면 이전 구독을 해제한다.
+  std::string spectating_;
   std::string resume_token_;
   nlohmann::json snapshot_;
   int snapshot_version_{1};
@@ -0,0 +1,68 @@
+/*
+ * 설명: 틱 지연, 이벤트 루프 지연, 활성 세션 수로 노드 여유를 판단해 새 큐 입장/세션 생성을 받을지 정한다.
+ * 버전: v1.0.0
+ * 관련 문서: design/server/v0.5.0-match-session.md, design/protocol/contract.md
+ * 테스트: server/tests/unit/admission_controller_test.cpp, server/tests/e2e/session_flow_test.cpp
+ */
+#include "server/admission.hpp"
+
+#include <algorithm>
+
+namespace server {
+
+AdmissionController::AdmissionController(const AdmissionConfig& config) : config_(config) {}
+
+void AdmissionController::RecordTickLateness(std::chrono::microseconds lateness) {
+  const std::int64_t sample = std::max<std::int64_t>(lateness.count(), 0);
+  const auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+  const auto last = last_observed_at_.exchange(now, std::memory_order_relaxed);
+  const bool stale = now - last > std::chrono::steady_clock::duration(config_.lateness_stale_after).count();
+  std::int64_t current = smoothed_lateness_us_.load(std::memory_order_relaxed);
+  std::int64_t next = 0;
+  do {
+    // 오래 관측이 없었다면 이전 평균을 잇지 않고 새 표본에서 다시 시작한다.
+    next = stale ? sample : current + (sample - current) / 8;
+  } while (!smoothed_lateness_us_.compare_exchange_weak(current, next, std::memory_order_relaxed));
+}
+
+std::chrono::microseconds AdmissionController::TickLateness() const {
+  const auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+  const auto last = last_observed_at_.load(std::memory_order_relaxed);
+  if (last == 0 || now - last > std::chrono::steady_clock::duration(config_.lateness_stale_after).count()) {
+    return std::chrono::microseconds(0);
+  }
+  return std::chrono::microseconds(smoothed_lateness_us_.load(std::memory_order_relaxed));
+}
+
+AdmissionVerdict AdmissionController::Evaluate(const AdmissionSignals& signals) const {
+  if (config_.max_active_sessions > 0 && signals.active_sessions >= config_.max_active_sessions) {
+    return AdmissionVerdict::kTooManySessions;
+  }
+  if (config_.max_tick_lateness.count() > 0 && signals.tick_lateness > config_.max_tick_lateness) {
+    return AdmissionVerdict::kTickLateness;
+  }
+  if (config_.max_loop_lag.count() > 0 && signals.loop_lag > config_.max_loop_lag) {
+    return AdmissionVerdict::kLoopLag;
+  }
+  return AdmissionVerdict::kAdmit;
+}
+
+bool AdmissionController::Enabled() const {
+  return config_.max_active_sessions > 0 || config_.max_tick_lateness.count() > 0 || config_.max_loop_lag.count() > 0;
+}
+
+const char* AdmissionVerdictName(AdmissionVerdict verdict) {
+  switch (verdict) {
+    case AdmissionVerdict::kAdmit:
+      return "admit";
+    case AdmissionVerdict::kTooManySessions:
+      return "sessions";
+    case AdmissionVerdict::kTickLateness:
+      return "tick_lateness";
+    case AdmissionVerdict::kLoopLag:
+      return "loop_lag";
+  }
+  return "admit";
+}
+
+}  // namespace server
@@ -53,4 +53,17 @@ nlohmann::json ToWsJson(const WsEnvelope& env) {
   return j;
 }
 
+nlohmann::json ToWsJson(WsEnvelope&& env) {
+  nlohmann::json j;
+  j["t"] = std::move(env.type);
+  j["seq"] = env.seq;
+  if (j["t"] == "event") {
+    j["event"] = std::move(env.event);
+  } else {
+    j["event"] = nullptr;
+  }
+  j["p"] = std::move(env.payload);
+  return j;
+}
+
 }  // namespace server
@@ -3,13 +3,18 @@
  * 버전: v1.0.0
  * 관련 문서: design/protocol/contract.md
  * 테스트: server/tests/e2e/auth_flow_test.cpp, server/tests/e2e/reconnect_backpressure_test.cpp,
- *         server/tests/e2e/session_flow_test.cpp
+ *         server/tests/e2e/session_flow_test.cpp, server/tests/e2e/session_migration_test.cpp
  */
 #include "server/app.hpp"
 
+#include <algorithm>
+#include <cctype>
 #include <chrono>
 #include <cstdlib>
+#include <ctime>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 
 #include <boost/asio/signal_set.hpp>
 #include <boost/asio/strand.hpp>
@@ -17,19 +22,29 @@
 
 #include "server/http_session.hpp"
 #include "server/observability.hpp"
+#include "server/profiler.hpp"
 
 namespace server {
+namespace {
+std::string ToIsoString(std::chrono::system_clock::time_point tp) {
+  auto tt = std::chrono::system_clock::to_time_t(tp);
+  std::tm tm = *std::gmtime(&tt);
+  std::ostringstream oss;
+  oss << std::put_time(&tm, "%FT%TZ");
+  return oss.str();
+}
+}  // namespace
 
 class Listener : public std::enable_shared_from_this<Listener> {
  public:
  Listener(boost::asio::io_context& ioc, const boost::asio::ip::tcp::endpoint& endpoint,
            const AppConfig& config, std::shared_ptr<AuthService> auth_service,
            std::shared_ptr<ReconnectService> reconnect_service, std::shared_ptr<RealtimeCoordinator> coordinator,
-           std::shared_ptr<SessionManager> session_manager, std::shared_ptr<MatchQueueService> match_queue,
+           std::shared_ptr<SessionManager> session_manager, std::shared_ptr<MatchQueues> match_queues,
            std::shared_ptr<RatingService> rating_service, std::shared_ptr<Observability> observability)
       : ioc_(ioc), acceptor_(boost::asio::make_strand(ioc)), config_(config), auth_service_(std::move(auth_service)),
         reconnect_service_(std::move(reconnect_service)), coordinator_(std::move(coordinator)),
-        session_manager_(std::move(session_manager)), match_queue_(std::move(match_queue)),
+        session_manager_(std::move(session_manager)), match_queues_(std::move(match_queues)),
         rating_service_(std::move(rating_service)), observability_(std::move(observability)) {
     boost::beast::error_code ec;
 
@@ -73,7 +88,7 @@ class Listener : public std::enable_shared_from_this<Listener> {
                                           self->reconnect_service_,
                                           self->coordinator_,
                                           self->session_manager_,
-                                          self->match_queue_,
+                                          self->match_queues_,
                                           self->rating_service_,
                                           self->observability_)
                 ->Run();
@@ -91,29 +106,59 @@ class Listener : public std::enable_shared_from_this<Listener> {
   std::shared_ptr<ReconnectService> reconnect_service_;
   std::shared_ptr<RealtimeCoordinator> coordinator_;
   std::shared_ptr<SessionManager> session_manager_;
-  std::shared_ptr<MatchQueueService> match_queue_;
+  std::shared_ptr<MatchQueues> match_queues_;
   std::shared_ptr<RatingService> rating_service_;
   std::shared_ptr<Observability> observability_;
 };
 
 ServerApp::ServerApp(const AppConfig& config)
-    : config_(config), ioc_(1), work_guard_(boost::asio::make_work_guard(ioc_)) {
+    : config_(config), ioc_(1), work_guard_(boost::asio::make_work_guard(ioc_)), lag_probe_timer_(ioc_) {
   AuthConfig auth_config;
   auth_config.token_ttl = std::chrono::seconds(config.auth_token_ttl_seconds);
   auth_config.login_window = std::chrono::seconds(config.login_rate_window_seconds);
   auth_config.login_max_attempts = config.login_rate_limit_max;
   auth_service_ = std::make_shared<AuthService>(auth_config);
   reconnect_service_ = std::make_shared<ReconnectService>();
-  observability_ = std::make_shared<Observability>();
+  observability_ = std::make_shared<Observability>(config.trace_sample_every);
   coordinator_ = std::make_shared<RealtimeCoordinator>();
   coordinator_->SetObservability(observability_);
   rating_service_ = std::make_shared<RatingService>();
   result_repository_ = std::make_shared<ResultRepository>();
   result_service_ = std::make_shared<ResultService>(result_repository_, rating_service_);
+  result_service_->SetObservability(observability_);
   session_manager_ = std::make_shared<SessionManager>(ioc_, coordinator_, result_service_,
                                                      std::chrono::milliseconds(config.session_tick_interval_ms), 5);
-  match_queue_ = std::make_shared<MatchQueueService>(ioc_, session_manager_, coordinator_,
-                                                     std::chrono::seconds(config.match_queue_timeout_seconds));
+  session_manager_->SetObservability(observability_);
+  session_manager_->SetRollbackWindow(static_cast<int>(config.session_rollback_ticks));
+  session_manager_->SetMaxTickInterval(std::chrono::milliseconds(config.session_tick_interval_max_ms));
+  session_manager_->SetFullStateEvery(config.session_full_state_every);
+  session_manager_->SetInterestFilter(MakeInterestFilter(static_cast<int>(config.session_interest_radius)));
+  session_manager_->SetMigrationResumeTimeout(std::chrono::milliseconds(config.migration_resume_timeout_ms));
+  session_manager_->SetSpectatorLimits(config.spectator_max_per_session,
+                                       static_cast<int>(config.spectator_max_delay_ticks));
+  AdmissionConfig admission_config;
+  admission_config.max_active_sessions = config.admission_max_sessions;
+  admission_config.max_tick_lateness = std::chrono::milliseconds(config.admission_max_tick_lateness_ms);
+  admission_config.max_loop_lag = std::chrono::milliseconds(config.admission_max_loop_lag_ms);
+  admission_config.retry_after = std::chrono::seconds(std::max<std::size_t>(config.admission_retry_after_seconds, 1));
+  admission_ = std::make_shared<AdmissionController>(admission_config);
+  session_manager_->SetAdmissionController(admission_);
+  // 모드마다 독립된 큐(matchmaker 스레드)를 둔다. 입장 제어와 세션 관리자는 노드 전체가 함께 쓴다.
+  match_queues_ = std::make_shared<MatchQueues>();
+  for (const auto& mode : ResolveMatchModes(config)) {
+    auto queue = std::make_shared<MatchQueueService>(session_manager_, coordinator_,
+                                                     std::chrono::seconds(mode.queue_timeout_seconds));
+    queue->SetObservability(observability_);
+    queue->SetSessionSize(mode.session_size);
+    queue->SetAdmissionController(admission_);
+    queue->SetRatingService(rating_service_);
+    MatchmakingConfig matchmaking_config;
+    matchmaking_config.base_window = static_cast<int>(mode.rating_window);
+    matchmaking_config.widen_per_second = static_cast<int>(mode.rating_widen_per_second);
+    matchmaking_config.max_window = static_cast<int>(mode.rating_window_max);
+    queue->SetMatchmakingConfig(matchmaking_config);
+    match_queues_->Add(queue, mode.name);
+  }
 }
 
 ServerApp::~ServerApp() { Stop(); }
@@ -123,11 +168,19 @@ void ServerApp::Run() {
     running_ = true;
     boost::asio::ip::tcp::endpoint endpoint{boost::asio::ip::tcp::v4(), config_.port};
     listener_ = std::make_shared<Listener>(ioc_, endpoint, config_, auth_service_, reconnect_service_, coordinator_,
-                                           session_manager_, match_queue_, rating_service_, observability_);
+                                           session_manager_, match_queues_, rating_service_, observability_);
     listener_->Run();
     std::cout << "서버 시작: 포트 " << config_.port << "\n";
+    if (config_.migration_port != 0) {
+      migration_listener_ = std::make_shared<MigrationListener>(
+          ioc_, config_.migration_port, [this](const nlohmann::json& request) { return AcceptMigration(request); });
+      migration_listener_->Run();
+    }
+    ScheduleLagProbe();
+    result_service_->Start();
+    match_queues_->Start();
     RunWorkers();
-    ioc_.run();
+    RunWorker(0);
   } catch (const std::exception& ex) {
     std::cerr << "서버 실행 중 예외: " << ex.what() << "\n";
   }
@@ -137,8 +190,35 @@ void ServerApp::RunWorkers() {
   const unsigned int thread_count = std::max(1u, std::thread::hardware_concurrency());
   // 현재 스레드도 run()을 호출하므로 워커는 thread_count - 1개만 생성한다.
   for (unsigned int i = 0; i + 1 < thread_count; ++i) {
-    workers_.emplace_back([this]() { ioc_.run(); });
+    workers_.emplace_back([this, i]() { RunWorker(static_cast<int>(i + 1)); });
+  }
+}
+
+void ServerApp::RunWorker(int index) {
+  SamplingProfiler::RegisterCurrentThread(index);
+  auto& slot = observability_->Loop().RegisterCurrentThread(index);
+  // run()과 동일하게 동작하되 핸들러 실행 수를 워커별로 센다.
+  while (ioc_.run_one() > 0) {
+    slot.CountHandler();
   }
+  slot.Finish();
+}
+
+void ServerApp::ScheduleLagProbe() {
+  lag_probe_timer_.expires_after(LoopMonitor::kProbeInterval);
+  lag_probe_timer_.async_wait([this](const boost::system::error_code& ec) {
+    if (ec || !running_) {
+      return;
+    }
+    // 타이머 만료 후 post한 핸들러가 실제로 실행되기까지의 지연을 loop lag로 본다.
+    auto posted_at = std::chrono::steady_clock::now();
+    boost::asio::post(ioc_, [this, posted_at]() {
+      auto lag = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - posted_at);
+      observability_->Loop().RecordLag(lag);
+      observability_->Loop().SampleUtilization();
+      ScheduleLagProbe();
+    });
+  });
 }
 
 void ServerApp::Stop() {
@@ -147,15 +227,75 @@ void ServerApp::Stop() {
   }
   running_ = false;
   work_guard_.reset();
+  lag_probe_timer_.cancel();
   if (listener_) {
     listener_->Stop();
   }
+  if (migration_listener_) {
+    migration_listener_->Stop();
+  }
   ioc_.stop();
   for (auto& worker : workers_) {
     if (worker.joinable()) {
       worker.join();
     }
   }
+  // 워커가 모두 멈춘 뒤 matchmaker와 finalizer를 세운다. matchmaker가 마지막으로 만든 세션의 결과는 없으므로 순서는 무관하다.
+  match_queues_->Stop();
+  result_service_->Stop();
+}
+
+nlohmann::json ServerApp::AcceptMigration(const nlohmann::json& request) {
+  auto reject = [](const std::string& code, const std::string& message) {
+    return nlohmann::json{{"ok", false}, {"code", code}, {"message", message}};
+  };
+  if (!request.is_object() || !MigrationTokenMatches(config_.migration_token, request)) {
+    return reject("unauthorized", "이전 토큰이 올바르지 않습니다");
+  }
+  const auto type = request.contains("type") && request["type"].is_string() ? request["type"].get<std::string>() : "";
+  if (type == "abort") {
+    if (!request.contains("migrationId") || !request["migrationId"].is_string() ||
+        request["migrationId"].get_ref<const std::string&>().empty() ||
+        request["migrationId"].get_ref<const std::string&>().size() > kMaxMigrationIdBytes) {
+      return reject("migration_invalid", "migrationId가 필요합니다");
+    }
+    std::string error_code;
+    std::string error_message;
+    if (!session_manager_->AbortImport(request["migrationId"].get<std::string>(), error_code, error_message)) {
+      return reject(error_code, error_message);
+    }
+    return nlohmann::json{{"ok", true}};
+  }
+  if (type != "import") {
+    return reject("bad_request", "type은 import 또는 abort여야 합니다");
+  }
+  SessionExport exported;
+  std::string error_message;
+  if (!request.contains("session") || !SessionExportFromJson(request["session"], exported, error_message)) {
+    return reject("migration_invalid", error_message.empty() ? "session이 필요합니다" : error_message);
+  }
+  std::string error_code;
+  const SessionId id = session_manager_->ImportSession(exported, error_code, error_message);
+  if (id == kInvalidSessionId) {
+    return reject(error_code, error_message);
+  }
+
+  MigrationAccepted accepted;
+  FormatSessionId(id, accepted.session_id);
+  accepted.tick = exported.tick;
+  accepted.port = config_.port;
+  const auto issued_at = ToIsoString(std::chrono::system_clock::now());
+  for (const auto& p : exported.participants) {
+    const AuthUser user{p.user_id, p.username};
+    nlohmann::json snapshot{{"version", 1},
+                            {"state", "migrated"},
+                            {"sessionId", accepted.session_id},
+                            {"issuedAt", issued_at},
+                            {"user", {{"userId", user.user_id}, {"username", user.username}}}};
+    accepted.tickets.push_back(MigrationTicket{user.user_id, auth_service_->IssueSession(user).token,
+                                               reconnect_service_->IssueToken(user, 1, snapshot, std::nullopt)});
+  }
+  return nlohmann::json{{"ok", true}, {"result", MigrationAcceptedToJson(accepted)}};
 }
 
 AppConfig LoadConfigFromEnv() {
@@ -182,7 +322,81 @@ AppConfig LoadConfigFromEnv() {
   cfg.match_queue_timeout_seconds = static_cast<std::size_t>(std::stoul(get_env("MATCH_QUEUE_TIMEOUT_SECONDS", "10")));
   cfg.session_tick_interval_ms = static_cast<std::size_t>(std::stoul(get_env("SESSION_TICK_INTERVAL_MS", "100")));
   cfg.ops_token = get_env("OPS_TOKEN", "");
+  cfg.trace_sample_every = static_cast<std::size_t>(std::stoul(get_env("TRACE_SAMPLE_EVERY", "100")));
+  cfg.session_rollback_ticks = static_cast<std::size_t>(std::stoul(get_env("SESSION_ROLLBACK_TICKS", "0")));
+  cfg.session_tick_interval_max_ms =
+      static_cast<std::size_t>(std::stoul(get_env("SESSION_TICK_INTERVAL_MAX_MS", "0")));
+  cfg.session_full_state_every = static_cast<std::size_t>(std::stoul(get_env("SESSION_FULL_STATE_EVERY", "1")));
+  cfg.match_session_size = static_cast<std::size_t>(std::stoul(get_env("MATCH_SESSION_SIZE", "2")));
+  cfg.session_interest_radius = static_cast<std::size_t>(std::stoul(get_env("SESSION_INTEREST_RADIUS", "0")));
+  cfg.migration_port = static_cast<unsigned short>(std::stoi(get_env("MIGRATION_PORT", "0")));
+  cfg.migration_token = get_env("MIGRATION_TOKEN", "");
+  cfg.migration_allowed_hosts.clear();
+  std::stringstream allowed_hosts(get_env("MIGRATION_ALLOWED_HOSTS", "127.0.0.1"));
+  std::string host;
+  while (std::getline(allowed_hosts, host, ',')) {
+    host.erase(std::remove_if(host.begin(), host.end(), [](unsigned char c) { return std::isspace(c) != 0; }),
+               host.end());
+    if (!host.empty()) {
+      cfg.migration_allowed_hosts.push_back(host);
+    }
+  }
+  cfg.migration_resume_timeout_ms =
+      static_cast<std::size_t>(std::stoul(get_env("MIGRATION_RESUME_TIMEOUT_MS", "3000")));
+  cfg.admission_max_sessions = static_cast<std::size_t>(std::stoul(get_env("ADMISSION_MAX_SESSIONS", "0")));
+  cfg.admission_max_tick_lateness_ms =
+      static_cast<std::size_t>(std::stoul(get_env("ADMISSION_MAX_TICK_LATENESS_MS", "0")));
+  cfg.admission_max_loop_lag_ms = static_cast<std::size_t>(std::stoul(get_env("ADMISSION_MAX_LOOP_LAG_MS", "0")));
+  cfg.admission_retry_after_seconds =
+      static_cast<std::size_t>(std::stoul(get_env("ADMISSION_RETRY_AFTER_SECONDS", "1")));
+  cfg.spectator_queue_frames = static_cast<std::size_t>(std::stoul(get_env("SPECTATOR_QUEUE_FRAMES", "4")));
+  cfg.spectator_max_per_session =
+      static_cast<std::size_t>(std::stoul(get_env("SPECTATOR_MAX_PER_SESSION", "10000")));
+  cfg.spectator_max_delay_ticks = static_cast<std::size_t>(std::stoul(get_env("SPECTATOR_MAX_DELAY_TICKS", "600")));
+  cfg.match_rating_window = static_cast<std::size_t>(std::stoul(get_env("MATCH_RATING_WINDOW", "100")));
+  cfg.match_rating_widen_per_second =
+      static_cast<std::size_t>(std::stoul(get_env("MATCH_RATING_WIDEN_PER_SECOND", "50")));
+  cfg.match_rating_window_max = static_cast<std::size_t>(std::stoul(get_env("MATCH_RATING_WINDOW_MAX", "400")));
+  // 모드별 값은 MATCH_<MODE>_* 로 덮어쓰고, 없으면 위 전역 값을 쓴다. 예: MATCH_RANKED_SESSION_SIZE.
+  std::stringstream modes(get_env("MATCH_MODES", "normal"));
+  std::string name;
+  while (std::getline(modes, name, ',')) {
+    name.erase(std::remove_if(name.begin(), name.end(), [](unsigned char c) { return std::isspace(c) != 0; }),
+               name.end());
+    if (name.empty()) {
+      continue;
+    }
+    std::string prefix = "MATCH_";
+    for (unsigned char c : name) {
+      prefix.push_back(static_cast<char>(std::toupper(c)));
+    }
+    auto get_mode_env = [&](const char* suffix, std::size_t def) {
+      return static_cast<std::size_t>(std::stoul(get_env((prefix + suffix).c_str(), std::to_string(def).c_str())));
+    };
+    MatchModeConfig mode;
+    mode.name = name;
+    mode.queue_timeout_seconds = get_mode_env("_QUEUE_TIMEOUT_SECONDS", cfg.match_queue_timeout_seconds);
+    mode.session_size = get_mode_env("_SESSION_SIZE", cfg.match_session_size);
+    mode.rating_window = get_mode_env("_RATING_WINDOW", cfg.match_rating_window);
+    mode.rating_widen_per_second = get_mode_env("_RATING_WIDEN_PER_SECOND", cfg.match_rating_widen_per_second);
+    mode.rating_window_max = get_mode_env("_RATING_WINDOW_MAX", cfg.match_rating_window_max);
+    cfg.match_modes.push_back(std::move(mode));
+  }
   return cfg;
 }
 
+std::vector<MatchModeConfig> ResolveMatchModes(const AppConfig& config) {
+  if (!config.match_modes.empty()) {
+    return config.match_modes;
+  }
+  MatchModeConfig mode;
+  mode.name = "normal";
+  mode.queue_timeout_seconds = config.match_queue_timeout_seconds;
+  mode.session_size = config.match_session_size;
+  mode.rating_window = config.match_rating_window;
+  mode.rating_widen_per_second = config.match_rating_widen_per_second;
+  mode.rating_window_max = config.match_rating_window_max;
+  return {mode};
+}
+
 }  // namespace server
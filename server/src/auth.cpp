@@ -134,6 +134,18 @@ std::optional<AuthSession> AuthService::Login(const std::string& username, const
   return session;
 }
 
+AuthSession AuthService::IssueSession(const AuthUser& user) {
+  auto now = std::chrono::system_clock::now();
+  std::lock_guard<std::mutex> lock(AuthMutex());
+  CleanupExpired(now);
+  AuthSession session;
+  session.token = GenerateToken();
+  session.user = user;
+  session.expires_at = now + config_.token_ttl;
+  sessions_[session.token] = session;
+  return session;
+}
+
 bool AuthService::Logout(const std::string& token) {
   std::lock_guard<std::mutex> lock(AuthMutex());
   return sessions_.erase(token) > 0;
@@ -0,0 +1,75 @@
+/*
+ * 설명: 고정 버킷 히스토그램 기록과 백분위 계산, JSON 직렬화를 수행한다.
+ * 버전: v1.0.0
+ * 관련 문서: design/ops/v0.7.0-observability.md
+ * 테스트: server/tests/unit/match_trace_test.cpp
+ */
+#include "server/histogram.hpp"
+
+#include <algorithm>
+#include <string>
+
+namespace server {
+
+std::vector<std::uint64_t> LatencyBucketsMicros() {
+  return {50,      100,     250,     500,     1'000,     2'500,     5'000,     10'000,    25'000,
+          50'000,  100'000, 250'000, 500'000, 1'000'000, 2'500'000, 5'000'000, 10'000'000};
+}
+
+Histogram::Histogram(std::vector<std::uint64_t> upper_bounds)
+    : upper_bounds_(std::move(upper_bounds)),
+      counts_(std::make_unique<std::atomic<std::uint64_t>[]>(upper_bounds_.size() + 1)) {
+  std::sort(upper_bounds_.begin(), upper_bounds_.end());
+  for (std::size_t i = 0; i <= upper_bounds_.size(); ++i) {
+    counts_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void Histogram::Record(std::uint64_t value) {
+  auto it = std::lower_bound(upper_bounds_.begin(), upper_bounds_.end(), value);
+  auto index = static_cast<std::size_t>(it - upper_bounds_.begin());
+  counts_[index].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+  auto prev = max_.load(std::memory_order_relaxed);
+  while (value > prev && !max_.compare_exchange_weak(prev, value, std::memory_order_relaxed)) {
+  }
+}
+
+std::uint64_t Histogram::Percentile(double quantile) const {
+  auto total = Count();
+  if (total == 0) {
+    return 0;
+  }
+  auto rank = static_cast<std::uint64_t>(quantile * static_cast<double>(total));
+  if (rank >= total) {
+    rank = total - 1;
+  }
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i < upper_bounds_.size(); ++i) {
+    seen += counts_[i].load(std::memory_order_relaxed);
+    if (seen > rank) {
+      return std::min(upper_bounds_[i], max_.load(std::memory_order_relaxed));
+    }
+  }
+  return max_.load(std::memory_order_relaxed);
+}
+
+nlohmann::json Histogram::ToJson(double divisor, std::string_view suffix) const {
+  const std::string sfx{suffix};
+  auto scaled = [divisor](std::uint64_t v) { return static_cast<double>(v) / divisor; };
+  nlohmann::json buckets = nlohmann::json::array();
+  for (std::size_t i = 0; i < upper_bounds_.size(); ++i) {
+    buckets.push_back({{"le" + sfx, scaled(upper_bounds_[i])}, {"count", counts_[i].load(std::memory_order_relaxed)}});
+  }
+  buckets.push_back({{"le" + sfx, "inf"}, {"count", counts_[upper_bounds_.size()].load(std::memory_order_relaxed)}});
+  return {{"count", Count()},
+          {"sum" + sfx, scaled(sum_.load(std::memory_order_relaxed))},
+          {"p50" + sfx, scaled(Percentile(0.50))},
+          {"p95" + sfx, scaled(Percentile(0.95))},
+          {"p99" + sfx, scaled(Percentile(0.99))},
+          {"max" + sfx, scaled(max_.load(std::memory_order_relaxed))},
+          {"buckets", buckets}};
+}
+
+}  // namespace server
@@ -7,6 +7,7 @@
  */
 #include "server/http_session.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <ctime>
 #include <iomanip>
@@ -16,15 +17,21 @@
 #include <sstream>
 #include <unordered_map>
 
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/beast/http.hpp>
 #include <boost/beast/version.hpp>
 
 #include "server/api_response.hpp"
 #include "server/observability.hpp"
+#include "server/input_journal.hpp"
+#include "server/profiler.hpp"
 
 namespace server {
 
 namespace {
+constexpr std::size_t kMaxProfileSeconds = 60;
+
 std::string ToIsoString(std::chrono::system_clock::time_point tp) {
   auto tt = std::chrono::system_clock::to_time_t(tp);
   std::tm tm = *std::gmtime(&tt);
@@ -70,12 +77,12 @@ HttpSession::HttpSession(boost::asio::ip::tcp::socket socket, const AppConfig& c
                          std::shared_ptr<ReconnectService> reconnect_service,
                          std::shared_ptr<RealtimeCoordinator> coordinator,
                          std::shared_ptr<SessionManager> session_manager,
-                         std::shared_ptr<MatchQueueService> match_queue,
+                         std::shared_ptr<MatchQueues> match_queues,
                          std::shared_ptr<RatingService> rating_service,
                          std::shared_ptr<Observability> observability)
     : stream_(std::move(socket)), config_(config), auth_service_(std::move(auth_service)),
       reconnect_service_(std::move(reconnect_service)), coordinator_(std::move(coordinator)),
-      session_manager_(std::move(session_manager)), match_queue_(std::move(match_queue)),
+      session_manager_(std::move(session_manager)), match_queues_(std::move(match_queues)),
       rating_service_(std::move(rating_service)), observability_(std::move(observability)) {}
 
 void HttpSession::Run() { DoRead(); }
@@ -139,11 +146,24 @@ void HttpSession::HandleRequest() {
   }
 
   if (req_.method() == http::verb::get && path == "/metrics") {
-    auto snapshot = observability_->Snapshot(session_manager_->ActiveSessionCount(), match_queue_->QueueLength());
+    auto snapshot = observability_->Snapshot(session_manager_->ActiveSessionCount(), match_queues_->Snapshot());
     nlohmann::json data{{"requests", { {"total", snapshot.request_total}, {"errors", snapshot.request_errors} }},
                         {"connections", {{"websocket", snapshot.websocket_active}}},
-                        {"sessions", {{"active", snapshot.active_sessions}}},
-                        {"queue", {{"length", snapshot.queue_length}}}};
+                        {"sessions", {{"active", snapshot.active_sessions}, {"degraded", snapshot.degraded_sessions}}},
+                        {"queue", observability_->QueueJson(snapshot.queues)},
+                        {"matchLifecycle", observability_->Tracer().HistogramsJson()},
+                        {"eventLoop", observability_->Loop().ToJson()},
+                        {"rollback", observability_->RollbackJson()},
+                        {"stateSync", observability_->StateSyncJson()},
+                        {"fanout", observability_->FanoutJson()},
+                        {"tickBatch", observability_->TickBatchJson()},
+                        {"sessionPool", observability_->SessionPoolJson(session_manager_->PooledContextCount(),
+                                                                         session_manager_->PoolHighWater())},
+                        {"resultFinalizer", observability_->ResultFinalizerJson(session_manager_->PendingResultCount())},
+                        {"migration", observability_->MigrationJson()},
+                        {"admission", observability_->AdmissionJson(session_manager_->TickLateness())},
+                        {"spectators", observability_->SpectatorJson()},
+                        {"matchmaking", observability_->MatchmakingJson(match_queues_->PendingCommands())}};
     auto body = MakeSuccessEnvelope(data).dump();
     res->result(http::status::ok);
     res->body() = body;
@@ -152,20 +172,41 @@ void HttpSession::HandleRequest() {
   }
 
   if (req_.method() == http::verb::get && path == "/ops/status") {
-    auto header_it = req_.base().find("X-Ops-Token");
-    std::string header_token = header_it == req_.base().end() ? std::string() : std::string(header_it->value());
-    if (config_.ops_token.empty() || header_token != config_.ops_token) {
+    if (!IsOpsAuthorized()) {
       res->result(http::status::unauthorized);
       auto body = MakeErrorEnvelope("unauthorized", "운영 토큰이 올바르지 않습니다").dump();
       res->body() = body;
       res->content_length(body.size());
       return SendResponse(res);
     }
-    auto snapshot = observability_->Snapshot(session_manager_->ActiveSessionCount(), match_queue_->QueueLength());
+    auto snapshot = observability_->Snapshot(session_manager_->ActiveSessionCount(), match_queues_->Snapshot());
+    nlohmann::json queue_lengths = nlohmann::json::object();
+    for (const auto& queue : snapshot.queues) {
+      queue_lengths[queue.mode] = queue.length;
+    }
     nlohmann::json data{{"activeSessions", snapshot.active_sessions},
-                        {"queueLength", snapshot.queue_length},
+                        {"queueLength", snapshot.QueueLengthTotal()},
+                        {"queueLengths", queue_lengths},
                         {"activeWebsocket", snapshot.websocket_active},
-                        {"errorCount", snapshot.request_errors}};
+                        {"errorCount", snapshot.request_errors},
+                        {"loopLagP95Ms", observability_->Loop().LagPercentileMicros(0.95) / 1000.0},
+                        {"workerUtilization", observability_->Loop().AverageUtilization()}};
+    auto body = MakeSuccessEnvelope(data).dump();
+    res->result(http::status::ok);
+    res->body() = body;
+    res->content_length(body.size());
+    return SendResponse(res);
+  }
+
+  if (req_.method() == http::verb::get && path == "/ops/traces") {
+    if (!IsOpsAuthorized()) {
+      res->result(http::status::unauthorized);
+      auto body = MakeErrorEnvelope("unauthorized", "운영 토큰이 올바르지 않습니다").dump();
+      res->body() = body;
+      res->content_length(body.size());
+      return SendResponse(res);
+    }
+    nlohmann::json data{{"traces", observability_->Tracer().SampledTracesJson()}};
     auto body = MakeSuccessEnvelope(data).dump();
     res->result(http::status::ok);
     res->body() = body;
@@ -173,6 +214,199 @@ void HttpSession::HandleRequest() {
     return SendResponse(res);
   }
 
+  if (req_.method() == http::verb::get && path == "/ops/journal") {
+    if (!IsOpsAuthorized()) {
+      res->result(http::status::unauthorized);
+      auto body = MakeErrorEnvelope("unauthorized", "운영 토큰이 올바르지 않습니다").dump();
+      res->body() = body;
+      res->content_length(body.size());
+      return SendResponse(res);
+    }
+    auto params = ParseQueryParams(query);
+    auto session_it = params.find("sessionId");
+    std::optional<MatchResultRecord> record;
+    if (session_it != params.end()) {
+      record = session_manager_->FindResult(session_it->second);
+    }
+    if (!record) {
+      res->result(http::status::not_found);
+      auto body = MakeErrorEnvelope("session_not_found", "종료된 세션 결과가 없습니다").dump();
+      res->body() = body;
+      res->content_length(body.size());
+      return SendResponse(res);
+    }
+    nlohmann::json data{{"sessionId", record->session_id},
+                        {"tickCount", record->tick_count},
+                        {"bytes", record->input_journal.size()},
+                        {"encoding", "base64"},
+                        {"journal", EncodeBase64(record->input_journal)},
+                        {"snapshot", record->snapshot}};
+    auto body = MakeSuccessEnvelope(data).dump();
+    res->result(http::status::ok);
+    res->body() = body;
+    res->content_length(body.size());
+    return SendResponse(res);
+  }
+
+  if (req_.method() == http::verb::post && path == "/ops/migrate") {
+    if (!IsOpsAuthorized()) {
+      res->result(http::status::unauthorized);
+      auto body = MakeErrorEnvelope("unauthorized", "운영 토큰이 올바르지 않습니다").dump();
+      res->body() = body;
+      res->content_length(body.size());
+      return SendResponse(res);
+    }
+    nlohmann::json body_json;
+    try {
+      body_json = nlohmann::json::parse(req_.body());
+    } catch (const std::exception&) {
+      body_json = nullptr;
+    }
+    if (!body_json.is_object() || !body_json.contains("sessionId") || !body_json["sessionId"].is_string() ||
+        !body_json.contains("targetPort") || !body_json["targetPort"].is_number_integer() ||
+        body_json["targetPort"].get<int>() < 1 || body_json["targetPort"].get<int>() > 65535 ||
+        (body_json.contains("targetHost") && !body_json["targetHost"].is_string())) {
+      res->result(http::status::bad_request);
+      auto body = MakeErrorEnvelope("bad_request", "sessionId와 targetPort(1~65535)가 필요합니다").dump();
+      res->body() = body;
+      res->content_length(body.size());
+      return SendResponse(res);
+    }
+    const auto session_id = body_json["sessionId"].get<std::string>();
+    const auto target_port = body_json["targetPort"].get<unsigned short>();
+    const auto target_host = body_json.value("targetHost", std::string("127.0.0.1"));
+    // 이전 단위에는 참가자와 입력 전체가 담기므로 설정한 대상에만 보낸다.
+    if (config_.migration_token.empty()) {
+      res->result(http::status::service_unavailable);
+      auto body = MakeErrorEnvelope("migration_disabled", "MIGRATION_TOKEN이 설정되지 않았습니다").dump();
+      res->body() = body;
+      res->content_length(body.size());
+      return SendResponse(res);
+    }
+    const auto& allowed_hosts = config_.migration_allowed_hosts;
+    if (std::find(allowed_hosts.begin(), allowed_hosts.end(), target_host) == allowed_hosts.end()) {
+      res->result(http::status::forbidden);
+      auto body = MakeErrorEnvelope("migration_target_forbidden", "허용되지 않은 이전 대상입니다: " + target_host).dump();
+      res->body() = body;
+      res->content_length(body.size());
+      return SendResponse(res);
+    }
+
+    std::string error_code;
+    std::string error_message;
+    SessionExport exported;
+    bool retrying = false;
+    if (!session_manager_->PauseForMigration(session_id, target_host + ":" + std::to_string(target_port), exported,
+                                             retrying, error_code, error_message)) {
+      res->result(error_code == "session_not_found" ? http::status::not_found : http::status::conflict);
+      auto body = MakeErrorEnvelope(error_code, error_message).dump();
+      res->body() = body;
+      res->content_length(body.size());
+      return SendResponse(res);
+    }
+    // 대상 응답을 기다리는 동안 io 스레드를 막지 않는다. 응답은 이 연결의 strand에서 보낸다.
+    AsyncSendMigration(
+        stream_.get_executor(), target_host, target_port,
+        nlohmann::json{{"type", "import"},
+                       {"migrationToken", config_.migration_token},
+                       {"session", SessionExportToJson(exported)}},
+        kMigrationTimeout,
+        [self = shared_from_this(), res, session_id, target_host, target_port, retrying,
+         migration_id = exported.migration_id](bool ok, bool connected, const nlohmann::json& reply,
+                                               const std::string& send_error) {
+          std::string error_code;
+          std::string error_message = send_error;
+          MigrationAccepted accepted;
+          const bool replied = ok && reply.is_object();
+          if (!(replied && reply.value("ok", false) && reply.contains("result") &&
+                MigrationAcceptedFromJson(reply["result"], accepted, error_message))) {
+            std::string rejected_code;
+            if (replied && reply.contains("code") && reply["code"].is_string()) {
+              rejected_code = reply["code"].get<std::string>();
+            }
+            if (replied && reply.contains("message") && reply["message"].is_string()) {
+              error_message = reply["message"].get<std::string>();
+            }
+            // 첫 시도가 대상에 닿지 않았거나 대상이 이 요청을 거절했으면 대상에 사본이 없으므로 원본에서 틱을 재개한다.
+            // 다시 보낸 요청이었거나 결과를 모르면 대상에 취소를 보내 사본이 없음을 확인한 뒤에만 재개한다.
+            if (!retrying && (!connected || (!rejected_code.empty() && rejected_code != "migration_in_progress"))) {
+              self->session_manager_->AbortMigration(session_id);
+              res->result(http::status::bad_gateway);
+              auto body = MakeErrorEnvelope("migration_failed", error_message).dump();
+              res->body() = body;
+              res->content_length(body.size());
+              return self->SendResponse(res);
+            }
+            return self->ConfirmMigrationAbort(res, session_id, migration_id, target_host, target_port, error_message);
+          }
+          if (!self->session_manager_->CompleteMigration(session_id, accepted, target_host, error_code,
+                                                         error_message)) {
+            res->result(http::status::conflict);
+            auto body = MakeErrorEnvelope(error_code, error_message).dump();
+            res->body() = body;
+            res->content_length(body.size());
+            return self->SendResponse(res);
+          }
+          nlohmann::json data{
+              {"sessionId", session_id}, {"targetSessionId", accepted.session_id}, {"tick", accepted.tick}};
+          auto body = MakeSuccessEnvelope(data).dump();
+          res->result(http::status::ok);
+          res->body() = body;
+          res->content_length(body.size());
+          self->SendResponse(res);
+        });
+    return;
+  }
+
+  if (req_.method() == http::verb::get && path == "/ops/profile") {
+    if (!IsOpsAuthorized()) {
+      res->result(http::status::unauthorized);
+      auto body = MakeErrorEnvelope("unauthorized", "운영 토큰이 올바르지 않습니다").dump();
+      res->body() = body;
+      res->content_length(body.size());
+      return SendResponse(res);
+    }
+    std::size_t seconds = 5;
+    auto params = ParseQueryParams(query);
+    auto seconds_it = params.find("seconds");
+    if (seconds_it != params.end()) {
+      auto parsed = ParsePositiveInt(seconds_it->second);
+      if (!parsed || *parsed < 1 || *parsed > kMaxProfileSeconds) {
+        res->result(http::status::bad_request);
+        auto body = MakeErrorEnvelope("bad_request", "seconds는 1~60 범위여야 합니다").dump();
+        res->body() = body;
+        res->content_length(body.size());
+        return SendResponse(res);
+      }
+      seconds = *parsed;
+    }
+    if (!SamplingProfiler::Start()) {
+      res->result(http::status::conflict);
+      auto body = MakeErrorEnvelope("profile_in_progress", "이미 프로파일 수집이 진행 중입니다").dump();
+      res->body() = body;
+      res->content_length(body.size());
+      return SendResponse(res);
+    }
+    // 수집 동안 I/O 스레드를 막지 않도록 타이머 만료 시 응답한다.
+    stream_.expires_after(std::chrono::seconds(seconds + 30));
+    auto timer = std::make_shared<boost::asio::steady_timer>(stream_.get_executor(), std::chrono::seconds(seconds));
+    timer->async_wait([self = shared_from_this(), timer, res, seconds](const boost::system::error_code&) {
+      auto profile = SamplingProfiler::Stop();
+      nlohmann::json data{{"seconds", seconds},
+                          {"frequencyHz", profile.frequency_hz},
+                          {"samples", profile.samples},
+                          {"dropped", profile.dropped},
+                          {"format", "folded"},
+                          {"folded", profile.folded}};
+      auto body = MakeSuccessEnvelope(data).dump();
+      res->result(http::status::ok);
+      res->body() = body;
+      res->content_length(body.size());
+      self->SendResponse(res);
+    });
+    return;
+  }
+
   if (req_.method() == http::verb::post && path == "/api/auth/register") {
     try {
       auto body_json = nlohmann::json::parse(req_.body());
@@ -284,33 +518,50 @@ void HttpSession::HandleRequest() {
         throw std::runtime_error("mode required");
       }
       std::string mode = body_json["mode"].get<std::string>();
-      if (mode != "normal") {
+      auto queue = match_queues_->Find(mode);
+      if (!queue) {
         throw std::runtime_error("mode invalid");
       }
-      std::chrono::seconds timeout{config_.match_queue_timeout_seconds};
+      std::chrono::seconds timeout = queue->DefaultTimeout();
       if (body_json.contains("timeoutSeconds")) {
         if (!body_json["timeoutSeconds"].is_number_unsigned()) {
           throw std::runtime_error("timeout invalid");
         }
         timeout = std::chrono::seconds(body_json["timeoutSeconds"].get<std::uint64_t>());
       }
-      std::string error_code;
-      std::string error_message;
-      if (!match_queue_->Join(session->user, timeout, error_code, error_message)) {
-        res->result(error_code == "queue_duplicate" ? http::status::conflict : http::status::bad_request);
-        auto body = MakeErrorEnvelope(error_code, error_message).dump();
-        res->body() = body;
-        res->content_length(body.size());
-        return SendResponse(res);
-      }
-      nlohmann::json data{{"queued", true},
-                          {"mode", mode},
-                          {"expiresAt", ToIsoString(std::chrono::system_clock::now() + timeout)}};
-      auto body = MakeSuccessEnvelope(data).dump();
-      res->result(http::status::ok);
-      res->body() = body;
-      res->content_length(body.size());
-      return SendResponse(res);
+      // 결과는 matchmaker 스레드에서 오므로 이 연결의 strand로 옮겨 응답한다.
+      queue->Join(
+          session->user, timeout, trace_id_,
+          [self = shared_from_this(), res, queue, mode, timeout](bool ok, const std::string& error_code,
+                                                                 const std::string& error_message) {
+            boost::asio::post(self->stream_.get_executor(), [self, res, queue, mode, timeout, ok, error_code,
+                                                             error_message]() {
+              if (!ok) {
+                if (error_code == "server_overloaded") {
+                  // 진행 중인 매치를 지키려고 새 입장을 거절한다. 클라이언트는 Retry-After 뒤에 다시 시도한다.
+                  res->result(http::status::service_unavailable);
+                  res->set(http::field::retry_after, std::to_string(queue->RetryAfter().count()));
+                } else if (error_code == "server_stopping") {
+                  res->result(http::status::service_unavailable);
+                } else {
+                  res->result(error_code == "queue_duplicate" ? http::status::conflict : http::status::bad_request);
+                }
+                auto body = MakeErrorEnvelope(error_code, error_message).dump();
+                res->body() = body;
+                res->content_length(body.size());
+                return self->SendResponse(res);
+              }
+              nlohmann::json data{{"queued", true},
+                                  {"mode", mode},
+                                  {"expiresAt", ToIsoString(std::chrono::system_clock::now() + timeout)}};
+              auto body = MakeSuccessEnvelope(data).dump();
+              res->result(http::status::ok);
+              res->body() = body;
+              res->content_length(body.size());
+              self->SendResponse(res);
+            });
+          });
+      return;
     } catch (const std::exception&) {
       res->result(http::status::bad_request);
       auto body = MakeErrorEnvelope("bad_request", "mode 또는 timeoutSeconds가 올바르지 않습니다").dump();
@@ -329,21 +580,34 @@ void HttpSession::HandleRequest() {
       res->content_length(body.size());
       return SendResponse(res);
     }
-    std::string error_code;
-    std::string error_message;
-    if (!match_queue_->Cancel(session->user.user_id, error_code, error_message)) {
+    // 사용자가 대기 중인 모드 큐로 보낸다. 어느 큐에도 없으면 바로 응답한다.
+    auto queue = match_queues_->FindByUser(session->user.user_id);
+    if (!queue) {
       res->result(http::status::not_found);
-      auto body = MakeErrorEnvelope(error_code, error_message).dump();
+      auto body = MakeErrorEnvelope("queue_not_found", "대기열에 존재하지 않습니다").dump();
       res->body() = body;
       res->content_length(body.size());
       return SendResponse(res);
     }
-    nlohmann::json data{{"canceled", true}};
-    auto body = MakeSuccessEnvelope(data).dump();
-    res->result(http::status::ok);
-    res->body() = body;
-    res->content_length(body.size());
-    return SendResponse(res);
+    queue->Cancel(session->user.user_id, [self = shared_from_this(), res](bool ok, const std::string& error_code,
+                                                                       const std::string& error_message) {
+      boost::asio::post(self->stream_.get_executor(), [self, res, ok, error_code, error_message]() {
+        if (!ok) {
+          res->result(error_code == "server_stopping" ? http::status::service_unavailable : http::status::not_found);
+          auto body = MakeErrorEnvelope(error_code, error_message).dump();
+          res->body() = body;
+          res->content_length(body.size());
+          return self->SendResponse(res);
+        }
+        nlohmann::json data{{"canceled", true}};
+        auto body = MakeSuccessEnvelope(data).dump();
+        res->result(http::status::ok);
+        res->body() = body;
+        res->content_length(body.size());
+        self->SendResponse(res);
+      });
+    });
+    return;
   }
 
   if (req_.method() == http::verb::get && path == "/api/leaderboard") {
@@ -470,7 +734,8 @@ void HttpSession::HandleWebSocket() {
   try {
     ws.accept(req_);
     std::make_shared<WebSocketSession>(std::move(ws), *session, reconnect_service_, coordinator_, session_manager_,
-                                       config_.ws_queue_limit_messages, config_.ws_queue_limit_bytes)
+                                       config_.ws_queue_limit_messages, config_.ws_queue_limit_bytes,
+                                       config_.spectator_queue_frames)
         ->Run();
   } catch (const std::exception&) {
     boost::beast::error_code ec;
@@ -490,6 +755,42 @@ std::optional<AuthSession> HttpSession::ExtractAuthSession() {
   return auth_service_->ValidateToken(token);
 }
 
+void HttpSession::ConfirmMigrationAbort(
+    std::shared_ptr<boost::beast::http::response<boost::beast::http::string_body>> res, const std::string& session_id,
+    const std::string& migration_id, const std::string& target_host, unsigned short target_port,
+    const std::string& import_error) {
+  using namespace boost::beast;
+  AsyncSendMigration(
+      stream_.get_executor(), target_host, target_port,
+      nlohmann::json{{"type", "abort"}, {"migrationToken", config_.migration_token}, {"migrationId", migration_id}},
+      kMigrationTimeout,
+      [self = shared_from_this(), res, session_id, import_error](bool ok, bool, const nlohmann::json& reply,
+                                                                 const std::string&) {
+        if (ok && reply.is_object() && reply.value("ok", false)) {
+          // 대상이 사본을 내렸거나 받은 적 없음을 확인했다. 이후 같은 id의 요청도 받지 않으므로 원본에서 재개한다.
+          self->session_manager_->AbortMigration(session_id);
+          res->result(http::status::bad_gateway);
+          auto body = MakeErrorEnvelope("migration_failed", import_error).dump();
+          res->body() = body;
+          res->content_length(body.size());
+          return self->SendResponse(res);
+        }
+        // 대상에 사본이 있는지 알 수 없다. 원본은 멈춘 채로 두고, 같은 대상으로 다시 이전하면 결과가 정해진다.
+        self->session_manager_->MarkMigrationInDoubt(session_id);
+        res->result(http::status::gateway_timeout);
+        auto body = MakeErrorEnvelope("migration_unknown", "대상이 세션을 받았는지 알 수 없습니다: " + import_error).dump();
+        res->body() = body;
+        res->content_length(body.size());
+        self->SendResponse(res);
+      });
+}
+
+bool HttpSession::IsOpsAuthorized() {
+  auto header_it = req_.base().find("X-Ops-Token");
+  std::string header_token = header_it == req_.base().end() ? std::string() : std::string(header_it->value());
+  return !config_.ops_token.empty() && header_token == config_.ops_token;
+}
+
 std::string HttpSession::RemoteIp() {
   boost::beast::error_code ec;
   auto endpoint = stream_.socket().remote_endpoint(ec);
@@ -0,0 +1,323 @@
+/*
+ * 설명: 세션에서 수락된 입력을 압축 바이너리 저널로 기록하고 Simulation으로 결정적으로 재생한다.
+ * 버전: v1.0.0
+ * 관련 문서: design/server/v0.3.0-tick-loop.md, design/protocol/contract.md
+ * 테스트: server/tests/unit/input_journal_test.cpp
+ */
+#include "server/input_journal.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+
+namespace server {
+namespace {
+
+constexpr std::uint64_t kEndMarker = 7;
+
+void PutVarint(std::string& out, std::uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+std::uint64_t ZigZag(std::int64_t value) {
+  return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+std::int64_t UnZigZag(std::uint64_t value) {
+  return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+class Cursor {
+ public:
+  explicit Cursor(std::string_view bytes) : bytes_(bytes) {}
+
+  bool AtEnd() const { return pos_ >= bytes_.size(); }
+
+  std::optional<std::uint8_t> Byte() {
+    if (AtEnd()) {
+      return std::nullopt;
+    }
+    return static_cast<std::uint8_t>(bytes_[pos_++]);
+  }
+
+  std::optional<std::uint64_t> Varint() {
+    std::uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (AtEnd()) {
+        return std::nullopt;
+      }
+      const auto byte = static_cast<std::uint8_t>(bytes_[pos_++]);
+      value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+    return std::nullopt;
+  }
+
+ private:
+  std::string_view bytes_;
+  std::size_t pos_{0};
+};
+
+// 헤더를 읽고 커서를 첫 레코드로 옮긴다. 실패하면 error에 ReplayJournal과 같은 코드를 담는다.
+bool ParseHeader(Cursor& cursor, JournalHeader& header, std::string& error) {
+  auto m1 = cursor.Byte();
+  auto m2 = cursor.Byte();
+  auto version = cursor.Byte();
+  if (!m1 || !m2 || !version || *m1 != 'I' || *m2 != 'J') {
+    error = "bad_magic";
+    return false;
+  }
+  if (*version != InputJournal::kVersion) {
+    error = "unsupported_version";
+    return false;
+  }
+  auto window = cursor.Varint();
+  auto players = cursor.Varint();
+  if (!window || !players) {
+    error = "truncated_header";
+    return false;
+  }
+  if (*players > InputJournal::kMaxPlayers) {
+    error = "too_many_players";
+    return false;
+  }
+  if (*window > static_cast<std::uint64_t>(Simulation::kMaxRollbackTicks)) {
+    error = "bad_header";
+    return false;
+  }
+  header.rollback_window = static_cast<int>(*window);
+  header.user_ids.clear();
+  header.user_ids.reserve(*players);
+  std::int64_t user_id = 0;
+  for (std::uint64_t i = 0; i < *players; ++i) {
+    auto delta = cursor.Varint();
+    if (!delta) {
+      error = "truncated_header";
+      return false;
+    }
+    // 기록 측은 중복 없는 오름차순으로만 쓴다. int 두 값의 차이는 ±2^32 안이므로 그 밖이면 누적 전에 거절한다.
+    constexpr std::int64_t kIdSpan = std::int64_t{1} << 32;
+    const auto step = UnZigZag(*delta);
+    if ((i > 0 && step <= 0) || step > kIdSpan || step < -kIdSpan) {
+      error = "bad_header";
+      return false;
+    }
+    user_id += step;
+    if (user_id > std::numeric_limits<int>::max() || user_id < std::numeric_limits<int>::min()) {
+      error = "bad_header";
+      return false;
+    }
+    header.user_ids.push_back(static_cast<int>(user_id));
+  }
+  return true;
+}
+
+ReplayResult Fail(ReplayResult result, std::string error) {
+  result.ok = false;
+  result.error = std::move(error);
+  return result;
+}
+
+}  // namespace
+
+void InputJournal::Begin(const std::vector<int>& user_ids, int rollback_window) {
+  user_ids_.assign(user_ids.begin(), user_ids.end());
+  std::sort(user_ids_.begin(), user_ids_.end());
+  user_ids_.erase(std::unique(user_ids_.begin(), user_ids_.end()), user_ids_.end());
+  last_sequences_.assign(user_ids_.size(), 0);
+  last_arrival_tick_ = 0;
+  input_count_ = 0;
+
+  bytes_.clear();
+  bytes_.push_back('I');
+  bytes_.push_back('J');
+  bytes_.push_back(static_cast<char>(kVersion));
+  PutVarint(bytes_, static_cast<std::uint64_t>(std::max(rollback_window, 0)));
+  PutVarint(bytes_, user_ids_.size());
+  int previous = 0;
+  for (int user_id : user_ids_) {
+    PutVarint(bytes_, ZigZag(static_cast<std::int64_t>(user_id) - previous));
+    previous = user_id;
+  }
+}
+
+void InputJournal::Append(int arrival_tick, const InputCommand& input) {
+  auto it = std::lower_bound(user_ids_.begin(), user_ids_.end(), input.user_id);
+  if (it == user_ids_.end() || *it != input.user_id) {
+    return;
+  }
+  const auto slot = static_cast<std::uint64_t>(it - user_ids_.begin());
+  PutVarint(bytes_, static_cast<std::uint64_t>(arrival_tick - last_arrival_tick_));
+  PutVarint(bytes_, (slot << 3) | static_cast<std::uint64_t>(input.delta + Simulation::kMaxDelta));
+  PutVarint(bytes_, ZigZag(static_cast<std::int64_t>(input.target_tick) - arrival_tick));
+  PutVarint(bytes_, input.sequence - last_sequences_[slot]);
+  last_sequences_[slot] = input.sequence;
+  last_arrival_tick_ = arrival_tick;
+  ++input_count_;
+}
+
+void InputJournal::Finish(int final_tick) {
+  PutVarint(bytes_, static_cast<std::uint64_t>(final_tick - last_arrival_tick_));
+  PutVarint(bytes_, kEndMarker);
+  last_arrival_tick_ = final_tick;
+}
+
+bool ReadJournalHeader(std::string_view bytes, JournalHeader& header, std::string& error) {
+  Cursor cursor(bytes);
+  return ParseHeader(cursor, header, error);
+}
+
+ReplayResult ReplayJournal(std::string_view bytes, Simulation& simulation, InputJournal* continued, int max_tick) {
+  ReplayResult result;
+  Cursor cursor(bytes);
+  JournalHeader header;
+  if (!ParseHeader(cursor, header, result.error)) {
+    return result;
+  }
+  const auto& user_ids = header.user_ids;
+  std::vector<std::uint64_t> last_sequences(user_ids.size(), 0);
+
+  simulation.EnableRollback(header.rollback_window);
+  for (int id : user_ids) {
+    simulation.AddPlayer(id);
+  }
+  if (continued) {
+    continued->Begin(user_ids, simulation.RollbackWindow());
+  }
+
+  const std::int64_t tick_limit = std::max(max_tick, 0);
+  std::int64_t arrival_tick = 0;
+  while (true) {
+    auto arrival_delta = cursor.Varint();
+    auto packed = cursor.Varint();
+    if (!arrival_delta || !packed) {
+      return Fail(result, "truncated_record");
+    }
+    // 틱을 하나씩 진행하므로 상한을 넘는 도착 틱은 진행하기 전에 거절한다.
+    if (*arrival_delta > static_cast<std::uint64_t>(tick_limit - arrival_tick)) {
+      return Fail(result, "tick_out_of_range");
+    }
+    arrival_tick += static_cast<std::int64_t>(*arrival_delta);
+    while (simulation.CurrentTick() < arrival_tick) {
+      simulation.TickOnce();
+    }
+    if ((*packed & 7) == kEndMarker) {
+      break;
+    }
+    auto target_offset = cursor.Varint();
+    auto sequence_delta = cursor.Varint();
+    const auto slot = *packed >> 3;
+    if (!target_offset || !sequence_delta) {
+      return Fail(result, "truncated_record");
+    }
+    if (slot >= user_ids.size()) {
+      return Fail(result, "bad_slot");
+    }
+    // arrival_tick은 int 범위이므로 빼는 쪽으로 비교하면 넘치지 않는다.
+    const auto target_offset_ticks = UnZigZag(*target_offset);
+    if (target_offset_ticks > std::numeric_limits<int>::max() - arrival_tick ||
+        target_offset_ticks < std::numeric_limits<int>::min() - arrival_tick) {
+      return Fail(result, "tick_out_of_range");
+    }
+    last_sequences[slot] += *sequence_delta;
+    InputCommand input;
+    input.user_id = user_ids[slot];
+    input.delta = static_cast<int>(*packed & 7) - Simulation::kMaxDelta;
+    input.target_tick = static_cast<int>(arrival_tick + target_offset_ticks);
+    input.sequence = last_sequences[slot];
+    auto validation = simulation.EnqueueInput(input);
+    if (!validation.accepted) {
+      return Fail(result, "input_rejected:" + validation.reason);
+    }
+    if (continued) {
+      continued->Append(static_cast<int>(arrival_tick), input);
+    }
+    ++result.inputs;
+  }
+  if (!cursor.AtEnd()) {
+    return Fail(result, "trailing_bytes");
+  }
+  result.ok = true;
+  result.final_tick = simulation.CurrentTick();
+  return result;
+}
+
+std::string EncodeBase64(std::string_view bytes) {
+  static constexpr char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string out;
+  out.reserve((bytes.size() + 2) / 3 * 4);
+  std::size_t i = 0;
+  for (; i + 2 < bytes.size(); i += 3) {
+    const std::uint32_t n = (static_cast<std::uint8_t>(bytes[i]) << 16) |
+                            (static_cast<std::uint8_t>(bytes[i + 1]) << 8) | static_cast<std::uint8_t>(bytes[i + 2]);
+    out.push_back(kAlphabet[(n >> 18) & 63]);
+    out.push_back(kAlphabet[(n >> 12) & 63]);
+    out.push_back(kAlphabet[(n >> 6) & 63]);
+    out.push_back(kAlphabet[n & 63]);
+  }
+  if (i < bytes.size()) {
+    std::uint32_t n = static_cast<std::uint8_t>(bytes[i]) << 16;
+    if (i + 1 < bytes.size()) {
+      n |= static_cast<std::uint8_t>(bytes[i + 1]) << 8;
+    }
+    out.push_back(kAlphabet[(n >> 18) & 63]);
+    out.push_back(kAlphabet[(n >> 12) & 63]);
+    out.push_back(i + 1 < bytes.size() ? kAlphabet[(n >> 6) & 63] : '=');
+    out.push_back('=');
+  }
+  return out;
+}
+
+bool DecodeBase64(std::string_view text, std::string& out) {
+  auto value_of = [](char c) -> int {
+    if (c >= 'A' && c <= 'Z') {
+      return c - 'A';
+    }
+    if (c >= 'a' && c <= 'z') {
+      return c - 'a' + 26;
+    }
+    if (c >= '0' && c <= '9') {
+      return c - '0' + 52;
+    }
+    if (c == '+') {
+      return 62;
+    }
+    if (c == '/') {
+      return 63;
+    }
+    return -1;
+  };
+  out.clear();
+  if (text.size() % 4 != 0) {
+    return false;
+  }
+  out.reserve(text.size() / 4 * 3);
+  for (std::size_t i = 0; i < text.size(); i += 4) {
+    const bool last = i + 4 == text.size();
+    const int a = value_of(text[i]);
+    const int b = value_of(text[i + 1]);
+    const int c = text[i + 2] == '=' && last ? 0 : value_of(text[i + 2]);
+    const int d = text[i + 3] == '=' && last ? 0 : value_of(text[i + 3]);
+    if (a < 0 || b < 0 || c < 0 || d < 0 || (text[i + 2] == '=' && text[i + 3] != '=')) {
+      return false;
+    }
+    const std::uint32_t n = (static_cast<std::uint32_t>(a) << 18) | (static_cast<std::uint32_t>(b) << 12) |
+                            (static_cast<std::uint32_t>(c) << 6) | static_cast<std::uint32_t>(d);
+    out.push_back(static_cast<char>((n >> 16) & 0xff));
+    if (text[i + 2] != '=') {
+      out.push_back(static_cast<char>((n >> 8) & 0xff));
+    }
+    if (text[i + 3] != '=') {
+      out.push_back(static_cast<char>(n & 0xff));
+    }
+  }
+  return true;
+}
+
+}  // namespace server
@@ -0,0 +1,42 @@
+/*
+ * 설명: 관심 영역 필터 구현과 수신자별 플레이어 선택을 제공한다.
+ * 버전: v1.0.0
+ * 관련 문서: design/server/v0.5.0-match-session.md, design/protocol/contract.md
+ * 테스트: server/tests/unit/interest_filter_test.cpp
+ */
+#include "server/interest_filter.hpp"
+
+#include <cstdlib>
+
+namespace server {
+
+bool RadiusInterestFilter::Interested(const PlayerView& recipient, const PlayerView& player) const {
+  return std::abs(static_cast<long long>(player.position) - recipient.position) <= radius_;
+}
+
+std::shared_ptr<const InterestFilter> MakeInterestFilter(int radius) {
+  if (radius <= 0) {
+    return std::make_shared<AllPlayersFilter>();
+  }
+  return std::make_shared<RadiusInterestFilter>(radius);
+}
+
+void SelectInterestedPlayers(const SnapshotView& view, int recipient_id, const InterestFilter& filter,
+                             std::vector<PlayerView>& out) {
+  out.clear();
+  const PlayerView* recipient = nullptr;
+  PlayerView found;
+  view.ForEachPlayer([&](const PlayerView& player) {
+    if (player.user_id == recipient_id) {
+      found = player;
+      recipient = &found;
+    }
+  });
+  view.ForEachPlayer([&](const PlayerView& player) {
+    if (recipient == nullptr || player.user_id == recipient_id || filter.Interested(*recipient, player)) {
+      out.push_back(player);
+    }
+  });
+}
+
+}  // namespace server
@@ -0,0 +1,115 @@
+/*
+ * 설명: 워커 스레드 CPU 시간 기반 바쁨/유휴 비율과 loop lag 히스토그램을 계산한다.
+ * 버전: v1.0.0
+ * 관련 문서: design/ops/v0.7.0-observability.md, design/protocol/contract.md
+ * 테스트: server/tests/e2e/metrics_ops_test.cpp
+ */
+#include "server/loop_monitor.hpp"
+
+#include <algorithm>
+
+namespace server {
+namespace {
+std::uint64_t ReadCpuMicros(clockid_t clock) {
+  timespec ts{};
+  if (clock_gettime(clock, &ts) != 0) {
+    return 0;
+  }
+  return static_cast<std::uint64_t>(ts.tv_sec) * 1'000'000ULL + static_cast<std::uint64_t>(ts.tv_nsec) / 1'000ULL;
+}
+
+std::uint64_t MicrosBetween(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+  return us < 0 ? 0 : static_cast<std::uint64_t>(us);
+}
+}  // namespace
+
+WorkerSlot::WorkerSlot(int index, clockid_t cpu_clock)
+    : index_(index), cpu_clock_(cpu_clock), started_at_(std::chrono::steady_clock::now()),
+      last_sample_at_(started_at_) {
+  last_busy_us_ = ReadCpuMicros(cpu_clock_);
+}
+
+void WorkerSlot::Finish() {
+  final_busy_us_.store(ReadCpuMicros(CLOCK_THREAD_CPUTIME_ID), std::memory_order_relaxed);
+  finished_.store(true, std::memory_order_release);
+}
+
+std::uint64_t WorkerSlot::BusyMicros() const {
+  // 종료된 스레드의 CPU 클록은 더 이상 유효하지 않으므로 고정값을 사용한다.
+  if (finished_.load(std::memory_order_acquire)) {
+    return final_busy_us_.load(std::memory_order_relaxed);
+  }
+  return ReadCpuMicros(cpu_clock_);
+}
+
+WorkerSlot& LoopMonitor::RegisterCurrentThread(int index) {
+  clockid_t clock = CLOCK_THREAD_CPUTIME_ID;
+  pthread_getcpuclockid(pthread_self(), &clock);
+  std::lock_guard<std::mutex> lock(mutex_);
+  slots_.push_back(std::make_unique<WorkerSlot>(index, clock));
+  return *slots_.back();
+}
+
+void LoopMonitor::RecordLag(std::chrono::microseconds lag) {
+  auto us = lag.count() < 0 ? 0 : static_cast<std::uint64_t>(lag.count());
+  lag_.Record(us);
+  last_lag_us_.store(us, std::memory_order_relaxed);
+}
+
+void LoopMonitor::SampleUtilization() {
+  auto now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& slot : slots_) {
+    if (slot->finished_.load(std::memory_order_acquire)) {
+      continue;
+    }
+    auto busy = slot->BusyMicros();
+    auto wall = MicrosBetween(slot->last_sample_at_, now);
+    if (wall == 0) {
+      continue;
+    }
+    auto delta = busy > slot->last_busy_us_ ? busy - slot->last_busy_us_ : 0;
+    auto permille = std::min<std::uint64_t>(1000, delta * 1000 / wall);
+    slot->recent_permille_.store(static_cast<std::uint32_t>(permille), std::memory_order_relaxed);
+    slot->last_busy_us_ = busy;
+    slot->last_sample_at_ = now;
+  }
+}
+
+double LoopMonitor::AverageUtilization() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::uint64_t sum = 0;
+  std::size_t running = 0;
+  for (const auto& slot : slots_) {
+    if (slot->finished_.load(std::memory_order_acquire)) {
+      continue;
+    }
+    sum += slot->recent_permille_.load(std::memory_order_relaxed);
+    ++running;
+  }
+  return running == 0 ? 0.0 : static_cast<double>(sum) / static_cast<double>(running) / 1000.0;
+}
+
+nlohmann::json LoopMonitor::ToJson() const {
+  auto now = std::chrono::steady_clock::now();
+  nlohmann::json workers = nlohmann::json::array();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& slot : slots_) {
+      auto wall = MicrosBetween(slot->started_at_, now);
+      auto busy = std::min(slot->BusyMicros(), wall);
+      workers.push_back({{"index", slot->index_},
+                         {"running", !slot->finished_.load(std::memory_order_acquire)},
+                         {"handlers", slot->handlers_.load(std::memory_order_relaxed)},
+                         {"busyMs", static_cast<double>(busy) / 1000.0},
+                         {"idleMs", static_cast<double>(wall - busy) / 1000.0},
+                         {"utilization", slot->recent_permille_.load(std::memory_order_relaxed) / 1000.0}});
+    }
+  }
+  return {{"lastLagMs", static_cast<double>(LastLagMicros()) / 1000.0},
+          {"lag", lag_.ToJson(1000.0, "Ms")},
+          {"workers", workers}};
+}
+
+}  // namespace server
@@ -1,108 +1,416 @@
 /*
- * 설명: 매칭 큐 입장/취소/타임아웃을 관리하고 페어링 시 세션을 생성한다.
- * 버전: v0.8.0
+ * 설명: 매칭 큐 입장/취소/타임아웃을 matchmaker 스레드 하나에서 처리하고 페어링 시 세션을 생성한다.
+ * 버전: v1.0.0
  * 관련 문서: design/server/v0.5.0-match-session.md
  * 테스트: server/tests/e2e/session_flow_test.cpp
  */
 #include "server/match_queue.hpp"
 
+#include <algorithm>
+
 namespace server {
 
-MatchQueueService::MatchQueueService(boost::asio::io_context& ioc, std::shared_ptr<SessionManager> session_manager,
+MatchQueueService::MatchQueueService(std::shared_ptr<SessionManager> session_manager,
                                      std::shared_ptr<RealtimeCoordinator> coordinator, std::chrono::seconds default_timeout)
-    : timer_(ioc), session_manager_(std::move(session_manager)), coordinator_(std::move(coordinator)),
+    : session_manager_(std::move(session_manager)), coordinator_(std::move(coordinator)),
       default_timeout_(default_timeout) {}
 
-bool MatchQueueService::Join(const AuthUser& user, std::chrono::seconds timeout, std::string& error_code,
-                             std::string& error_message) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  if (user_index_.count(user.user_id) > 0 || session_manager_->IsUserInSession(user.user_id)) {
-    error_code = "queue_duplicate";
-    error_message = "이미 큐에 있거나 세션에 참여 중입니다";
-    return false;
+MatchQueueService::~MatchQueueService() { Stop(); }
+
+void MatchQueueService::SetSessionSize(std::size_t size) {
+  session_size_ = std::clamp<std::size_t>(size, 2, SessionManager::kMaxSessionPlayers);
+}
+
+void MatchQueueService::SetMatchmakingConfig(const MatchmakingConfig& config) { index_ = MatchmakingIndex(config); }
+
+void MatchQueueService::SetMode(const std::string& mode, std::size_t mode_index,
+                                const std::shared_ptr<QueueMembership>& membership) {
+  mode_ = mode;
+  mode_index_ = mode_index;
+  membership_ = membership;
+  if (observability_) {
+    metrics_mode_ = observability_->RegisterQueueMode(mode);
   }
-  if (timeout.count() <= 0) {
-    timeout = default_timeout_;
+}
+
+void MatchQueueService::Start() {
+  if (running_.exchange(true)) {
+    return;
   }
-  auto now = std::chrono::steady_clock::now();
-  queue_.push_back(QueueEntry{user, now + timeout, now});
-  auto it = std::prev(queue_.end());
-  user_index_[user.user_id] = it;
-  EnsureTimer();
-  return true;
+  next_recheck_ = std::chrono::steady_clock::now() + kRecheckInterval;
+  matchmaker_ = std::thread([this]() { RunMatchmaker(); });
 }
 
-bool MatchQueueService::Cancel(int user_id, std::string& error_code, std::string& error_message) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  auto it = user_index_.find(user_id);
-  if (it == user_index_.end()) {
-    error_code = "queue_not_found";
-    error_message = "대기열에 존재하지 않습니다";
-    return false;
+void MatchQueueService::Stop() {
+  stopped_.store(true, std::memory_order_release);
+  if (running_.exchange(false)) {
+    wake_.Notify();
+    if (matchmaker_.joinable()) {
+      matchmaker_.join();
+    }
   }
-  queue_.erase(it->second);
-  user_index_.erase(it);
-  return true;
+  // 시작되지 않았거나 matchmaker의 마지막 Drain 뒤에 들어온 명령도 응답 없이 버리지 않는다.
+  RejectPending();
+}
+
+void MatchQueueService::Join(const AuthUser& user, std::chrono::seconds timeout, const std::string& trace_id,
+                             QueueCompletion done) {
+  QueueCommand command;
+  command.kind = QueueCommand::Kind::kJoin;
+  command.user = user;
+  // 레이팅 잠금은 matchmaker가 아니라 호출 스레드에서 잡는다.
+  command.rating = RatingOf(user.user_id);
+  command.timeout = timeout.count() > 0 ? timeout : default_timeout_;
+  command.trace_id = trace_id;
+  command.done = std::move(done);
+  Submit(std::move(command));
 }
 
-void MatchQueueService::EnsureTimer() {
-  if (timer_active_) {
+void MatchQueueService::Cancel(int user_id, QueueCompletion done) {
+  QueueCommand command;
+  command.kind = QueueCommand::Kind::kCancel;
+  command.user.user_id = user_id;
+  command.done = std::move(done);
+  Submit(std::move(command));
+}
+
+void MatchQueueService::Submit(QueueCommand command) {
+  if (stopped_.load(std::memory_order_acquire)) {
+    command.done(false, "server_stopping", "서버가 종료 중입니다");
     return;
   }
-  timer_active_ = true;
-  timer_.expires_after(std::chrono::seconds(1));
-  auto self = shared_from_this();
-  timer_.async_wait([self](const boost::system::error_code& ec) { self->OnTick(ec); });
+  command.submitted_at = std::chrono::steady_clock::now();
+  auto* node = new Node{std::move(command)};
+  pending_.fetch_add(1, std::memory_order_relaxed);
+  Node* head = head_.load(std::memory_order_relaxed);
+  do {
+    node->next = head;
+  } while (!head_.compare_exchange_weak(head, node));
+  // 빈 스택에 처음 넣은 생산자만 깨운다. 뒤이은 생산자의 명령은 그 신호로 깬 matchmaker가 함께 꺼낸다.
+  if (head == nullptr) {
+    wake_.Notify();
+  }
+}
+
+void MatchQueueService::RejectPending() {
+  Node* node = head_.exchange(nullptr);
+  std::size_t rejected = 0;
+  while (node != nullptr) {
+    Node* next = node->next;
+    node->command.done(false, "server_stopping", "서버가 종료 중입니다");
+    delete node;
+    node = next;
+    ++rejected;
+  }
+  pending_.fetch_sub(rejected, std::memory_order_relaxed);
+}
+
+void MatchQueueService::RunMatchmaker() {
+  while (running_.load(std::memory_order_acquire)) {
+    Drain();
+    const auto now = std::chrono::steady_clock::now();
+    Sweep(now);
+    queue_length_.store(index_.Size(), std::memory_order_relaxed);
+
+    // 다음 만료나 재확인 시각까지 자되, 명령이 들어오면 바로 깬다. 대기자가 없으면 명령만 기다린다.
+    if (index_.Empty()) {
+      wake_.Wait();
+      continue;
+    }
+    auto wake_at = next_recheck_;
+    if (auto deadline = index_.NextDeadline()) {
+      wake_at = std::min(wake_at, *deadline);
+    }
+    wake_.WaitUntil(wake_at);
+  }
+  // 정지 직전에 들어온 명령도 응답을 돌려준다.
+  Drain();
+  queue_length_.store(index_.Size(), std::memory_order_relaxed);
 }
 
-void MatchQueueService::OnTick(const boost::system::error_code& ec) {
-  if (ec) {
+std::size_t MatchQueueService::Drain() {
+  Node* node = head_.exchange(nullptr);
+  if (node == nullptr) {
+    return 0;
+  }
+  // 스택은 최신 명령이 앞이므로 뒤집어 제출 순서대로 처리한다. 같은 사용자의 입장 → 취소 순서가 유지된다.
+  Node* ordered = nullptr;
+  while (node != nullptr) {
+    Node* next = node->next;
+    node->next = ordered;
+    ordered = node;
+    node = next;
+  }
+
+  std::size_t drained = 0;
+  while (ordered != nullptr) {
+    Node* next = ordered->next;
+    auto& command = ordered->command;
+    if (observability_) {
+      observability_->RecordMatchmakerCommand(std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - command.submitted_at));
+    }
+    if (command.kind == QueueCommand::Kind::kJoin) {
+      HandleJoin(command);
+    } else {
+      HandleCancel(command);
+    }
+    delete ordered;
+    ordered = next;
+    ++drained;
+  }
+  pending_.fetch_sub(drained, std::memory_order_relaxed);
+  return drained;
+}
+
+void MatchQueueService::HandleJoin(QueueCommand& command) {
+  const int user_id = command.user.user_id;
+  // 다른 모드 큐에 이미 있는 사용자도 중복으로 본다. 티켓이 큐를 떠날 때(매치/취소/만료) 놓는다.
+  // 점유를 먼저 잡아야 다른 모드의 StartMatch가 세션 등록 후 점유를 놓는 사이에 끼어들어도 세션 확인에서 걸린다.
+  if (membership_ && !membership_->Claim(user_id, mode_index_)) {
+    command.done(false, "queue_duplicate", "이미 큐에 있거나 세션에 참여 중입니다");
+    return;
+  }
+  if (index_.Contains(user_id) || session_manager_->IsUserInSession(user_id)) {
+    ReleaseClaim(user_id);
+    command.done(false, "queue_duplicate", "이미 큐에 있거나 세션에 참여 중입니다");
+    return;
+  }
+  const auto verdict = CheckAdmission();
+  if (verdict != AdmissionVerdict::kAdmit) {
+    ReleaseClaim(user_id);
+    if (observability_) {
+      observability_->RecordAdmission(verdict, false);
+    }
+    command.done(false, "server_overloaded", std::string("서버가 과부하 상태입니다: ") + AdmissionVerdictName(verdict));
+    return;
+  }
+  const auto joined_at = command.submitted_at;
+  index_.Add(MatchTicket{user_id, std::move(command.user.username), command.rating, joined_at,
+                         joined_at + command.timeout});
+  if (observability_) {
+    observability_->Tracer().RecordJoin(user_id, command.trace_id);
+  }
+  PairOnJoin(user_id, std::chrono::steady_clock::now());
+  // 응답을 받은 클라이언트가 /metrics에서 방금 반영된 대기 인원을 보도록 먼저 갱신한다.
+  queue_length_.store(index_.Size(), std::memory_order_relaxed);
+  command.done(true, "", "");
+}
+
+void MatchQueueService::HandleCancel(QueueCommand& command) {
+  const int user_id = command.user.user_id;
+  if (!index_.Remove(user_id)) {
+    command.done(false, "queue_not_found", "대기열에 존재하지 않습니다");
     return;
   }
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    HandleTimeouts();
-    PairIfPossible();
+  ReleaseClaim(user_id);
+  if (observability_) {
+    observability_->Tracer().DropJoin(user_id);
+  }
+  queue_length_.store(index_.Size(), std::memory_order_relaxed);
+  command.done(true, "", "");
+}
+
+void MatchQueueService::Sweep(std::chrono::steady_clock::time_point now) {
+  expired_.clear();
+  index_.RemoveExpired(now, expired_);
+  NotifyTimeouts(expired_);
+  if (now < next_recheck_) {
+    return;
+  }
+  next_recheck_ = now + kRecheckInterval;
+  PairIfPossible();
+}
+
+void MatchQueueService::PairOnJoin(int user_id, std::chrono::steady_clock::time_point now) {
+  if (index_.Size() < session_size_) {
+    return;
+  }
+  // 여유가 없으면 대기자를 큐에 둔 채 다음 재확인에서 다시 본다.
+  const auto verdict = CheckAdmission();
+  if (verdict != AdmissionVerdict::kAdmit) {
+    if (observability_) {
+      observability_->RecordAdmission(verdict, true);
+    }
+    return;
+  }
+  if (index_.PopMatchFor(user_id, now, session_size_, matched_)) {
+    StartMatch(now);
   }
-  timer_.expires_after(std::chrono::seconds(1));
-  auto self = shared_from_this();
-  timer_.async_wait([self](const boost::system::error_code& next_ec) { self->OnTick(next_ec); });
 }
 
 void MatchQueueService::PairIfPossible() {
-  while (queue_.size() >= 2) {
-    auto first_it = queue_.begin();
-    auto first = *first_it;
-    queue_.erase(first_it);
-    auto second_it = queue_.begin();
-    auto second = *second_it;
-    queue_.erase(second_it);
-    user_index_.erase(first.user.user_id);
-    user_index_.erase(second.user.user_id);
-    std::vector<SessionParticipant> participants{{first.user.user_id, first.user.username},
-                                                 {second.user.user_id, second.user.username}};
-    session_manager_->CreateSession(participants);
-  }
-}
-
-void MatchQueueService::HandleTimeouts() {
-  auto now = std::chrono::steady_clock::now();
-  auto it = queue_.begin();
-  while (it != queue_.end()) {
-    if (it->expires_at > now) {
-      ++it;
-      continue;
+  const auto now = std::chrono::steady_clock::now();
+  // 이번 재확인에서 실패한 앵커는 다시 보지 않는다. 다음 재확인에서 넓어진 창으로 처음부터 본다.
+  MatchmakingIndex::Scan scan;
+  while (index_.Size() >= session_size_) {
+    // 여유가 없으면 대기자를 큐에 둔 채 다음 재확인에서 다시 본다. 타임아웃은 그대로 적용된다.
+    const auto verdict = CheckAdmission();
+    if (verdict != AdmissionVerdict::kAdmit) {
+      if (observability_) {
+        observability_->RecordAdmission(verdict, true);
+      }
+      return;
+    }
+    // 레이팅 창 안에 인원이 모이지 않았으면 다음 재확인에서 넓어진 창으로 다시 본다.
+    if (!index_.PopMatch(now, session_size_, matched_, scan)) {
+      return;
+    }
+    StartMatch(now);
+  }
+}
+
+void MatchQueueService::StartMatch(std::chrono::steady_clock::time_point now) {
+  std::vector<SessionParticipant> participants;
+  participants.reserve(matched_.size());
+  int lowest = matched_.front().rating;
+  int highest = lowest;
+  for (const auto& ticket : matched_) {
+    participants.push_back(SessionParticipant{ticket.user_id, ticket.username});
+    lowest = std::min(lowest, ticket.rating);
+    highest = std::max(highest, ticket.rating);
+    if (observability_) {
+      observability_->RecordMatchmakingWait(
+          metrics_mode_, std::chrono::duration_cast<std::chrono::microseconds>(now - ticket.joined_at));
+    }
+  }
+  if (observability_) {
+    observability_->RecordMatchFormed(metrics_mode_, highest - lowest);
+  }
+  // 세션 등록은 CreateSession 안에서 끝나므로, 점유를 놓은 뒤 들어온 다른 모드 입장은 점유를 먼저 잡고
+  // IsUserInSession에서 걸린다.
+  if (session_manager_->CreateSession(participants) != kInvalidSessionId) {
+    for (const auto& ticket : matched_) {
+      ReleaseClaim(ticket.user_id);
+    }
+    return;
+  }
+  // 다른 경로(세션 이전 등)로 이미 세션에 들어간 참가자가 있으면 세션을 만들지 않는다.
+  // 그 참가자만 큐에서 빼고 나머지는 원래 대기 시각/마감 그대로 큐에 되돌린다.
+  for (auto& ticket : matched_) {
+    if (session_manager_->IsUserInSession(ticket.user_id)) {
+      ReleaseClaim(ticket.user_id);
+      if (observability_) {
+        observability_->Tracer().DropJoin(ticket.user_id);
+      }
+    } else {
+      index_.Add(std::move(ticket));
+    }
+  }
+}
+
+void MatchQueueService::ReleaseClaim(int user_id) {
+  if (membership_) {
+    membership_->Release(user_id);
+  }
+}
+
+int MatchQueueService::RatingOf(int user_id) const {
+  if (!rating_service_) {
+    return RatingService::kInitialRating;
+  }
+  auto summary = rating_service_->GetSummary(user_id);
+  return summary ? summary->rating : RatingService::kInitialRating;
+}
+
+AdmissionVerdict MatchQueueService::CheckAdmission() const {
+  if (!admission_ || !admission_->Enabled()) {
+    return AdmissionVerdict::kAdmit;
+  }
+  AdmissionSignals signals;
+  signals.active_sessions = session_manager_->ActiveSessionCount();
+  signals.tick_lateness = admission_->TickLateness();
+  if (observability_) {
+    signals.loop_lag = std::chrono::microseconds(observability_->Loop().LastLagMicros());
+  }
+  return admission_->Evaluate(signals);
+}
+
+void MatchQueueService::NotifyTimeouts(const std::vector<MatchTicket>& expired) {
+  for (const auto& ticket : expired) {
+    ReleaseClaim(ticket.user_id);
+    if (observability_) {
+      observability_->Tracer().DropJoin(ticket.user_id);
+    }
+    coordinator_->SendErrorToUser(ticket.user_id, "queue_timeout", "매칭 타임아웃이 발생했습니다");
+  }
+}
+
+bool QueueMembership::Claim(int user_id, std::size_t mode_index) {
+  auto& shard = ShardFor(user_id);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  return shard.users.emplace(user_id, mode_index).second;
+}
+
+void QueueMembership::Release(int user_id) {
+  auto& shard = ShardFor(user_id);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  shard.users.erase(user_id);
+}
+
+std::optional<std::size_t> QueueMembership::ModeOf(int user_id) const {
+  auto& shard = ShardFor(user_id);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.users.find(user_id);
+  if (it == shard.users.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+bool MatchQueues::Add(const std::shared_ptr<MatchQueueService>& queue, const std::string& mode) {
+  if (Find(mode)) {
+    return false;
+  }
+  queue->SetMode(mode, queues_.size(), membership_);
+  queues_.push_back(queue);
+  return true;
+}
+
+std::shared_ptr<MatchQueueService> MatchQueues::Find(const std::string& mode) const {
+  for (const auto& queue : queues_) {
+    if (queue->Mode() == mode) {
+      return queue;
     }
-    int uid = it->user.user_id;
-    user_index_.erase(uid);
-    it = queue_.erase(it);
-    coordinator_->SendErrorToUser(uid, "queue_timeout", "매칭 타임아웃이 발생했습니다");
+  }
+  return nullptr;
+}
+
+std::shared_ptr<MatchQueueService> MatchQueues::FindByUser(int user_id) const {
+  auto mode_index = membership_->ModeOf(user_id);
+  if (!mode_index || *mode_index >= queues_.size()) {
+    return nullptr;
+  }
+  return queues_[*mode_index];
+}
+
+void MatchQueues::Start() {
+  for (const auto& queue : queues_) {
+    queue->Start();
   }
 }
 
-std::size_t MatchQueueService::QueueLength() {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return queue_.size();
+void MatchQueues::Stop() {
+  for (const auto& queue : queues_) {
+    queue->Stop();
+  }
+}
+
+std::vector<QueueModeSnapshot> MatchQueues::Snapshot() const {
+  std::vector<QueueModeSnapshot> snapshots;
+  snapshots.reserve(queues_.size());
+  for (const auto& queue : queues_) {
+    snapshots.push_back(QueueModeSnapshot{queue->Mode(), queue->QueueLength(), queue->PendingCommands()});
+  }
+  return snapshots;
+}
+
+std::size_t MatchQueues::PendingCommands() const {
+  std::size_t pending = 0;
+  for (const auto& queue : queues_) {
+    pending += queue->PendingCommands();
+  }
+  return pending;
 }
 
 }  // namespace server
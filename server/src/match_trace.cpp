@@ -0,0 +1,177 @@
+/*
+ * 설명: 매치 수명주기 이벤트를 구간 지연 히스토그램과 샘플 트레이스로 변환한다.
+ * 버전: v1.0.0
+ * 관련 문서: design/ops/v0.7.0-observability.md, design/protocol/contract.md
+ * 테스트: server/tests/unit/match_trace_test.cpp, server/tests/e2e/metrics_ops_test.cpp
+ */
+#include "server/match_trace.hpp"
+
+namespace server {
+
+const char* MatchEventName(MatchEvent event) {
+  switch (event) {
+    case MatchEvent::kCreated:
+      return "session.created";
+    case MatchEvent::kStarted:
+      return "session.started";
+    case MatchEvent::kFirstTick:
+      return "session.first_tick";
+    case MatchEvent::kInput:
+      return "session.input";
+    case MatchEvent::kEnded:
+      return "session.ended";
+    case MatchEvent::kRatingApplied:
+      return "rating.applied";
+  }
+  return "unknown";
+}
+
+MatchTracer::MatchTracer(std::size_t sample_every, std::size_t max_samples)
+    : sample_every_(sample_every), max_samples_(max_samples) {}
+
+std::uint64_t MatchTracer::Micros(Clock::duration d) {
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+  return us < 0 ? 0 : static_cast<std::uint64_t>(us);
+}
+
+void MatchTracer::RecordJoin(int user_id, const std::string& trace_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  pending_joins_[user_id] = PendingJoin{trace_id, Clock::now()};
+}
+
+void MatchTracer::DropJoin(int user_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  pending_joins_.erase(user_id);
+}
+
+bool MatchTracer::OpenSession(const std::string& session_id, const std::string& trace_id,
+                              const std::vector<int>& user_ids) {
+  auto now = Clock::now();
+  std::lock_guard<std::mutex> lock(mutex_);
+  ActiveTrace trace;
+  trace.trace_id = trace_id;
+  trace.session_id = session_id;
+  trace.paired_at = now;
+  trace.sampled = sample_every_ > 0 && opened_ % sample_every_ == 0;
+  ++opened_;
+  for (int uid : user_ids) {
+    auto it = pending_joins_.find(uid);
+    if (it == pending_joins_.end()) {
+      continue;
+    }
+    join_to_pair_.Record(Micros(now - it->second.joined_at));
+    trace.joins.emplace_back(uid, std::move(it->second));
+    pending_joins_.erase(it);
+  }
+  bool sampled = trace.sampled;
+  active_[session_id] = std::move(trace);
+  return sampled;
+}
+
+void MatchTracer::AppendEvent(ActiveTrace& trace, MatchEvent event, Clock::time_point now,
+                              std::optional<int> user_id) {
+  if (!trace.sampled || trace.events.size() >= kMaxEventsPerTrace) {
+    return;
+  }
+  auto offset = std::chrono::duration_cast<std::chrono::microseconds>(now - trace.paired_at).count();
+  trace.events.push_back(TraceEvent{MatchEventName(event), offset, user_id});
+}
+
+void MatchTracer::Mark(const std::string& session_id, MatchEvent event, std::optional<int> user_id) {
+  auto now = Clock::now();
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = active_.find(session_id);
+  if (it == active_.end()) {
+    return;
+  }
+  auto& trace = it->second;
+  switch (event) {
+    case MatchEvent::kCreated:
+      trace.created_at = now;
+      pair_to_created_.Record(Micros(now - trace.paired_at));
+      break;
+    case MatchEvent::kStarted:
+      for (const auto& join : trace.joins) {
+        queue_to_start_.Record(Micros(now - join.second.joined_at));
+      }
+      break;
+    case MatchEvent::kFirstTick:
+      if (trace.first_tick_seen) {
+        return;
+      }
+      trace.first_tick_seen = true;
+      created_to_first_tick_.Record(Micros(now - trace.created_at.value_or(trace.paired_at)));
+      break;
+    case MatchEvent::kInput:
+      break;
+    case MatchEvent::kEnded:
+      trace.ended_at = now;
+      break;
+    case MatchEvent::kRatingApplied:
+      end_to_rating_applied_.Record(Micros(now - trace.ended_at.value_or(now)));
+      AppendEvent(trace, event, now, user_id);
+      Retire(it);
+      return;
+  }
+  AppendEvent(trace, event, now, user_id);
+}
+
+void MatchTracer::CloseSession(const std::string& session_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = active_.find(session_id);
+  if (it != active_.end()) {
+    Retire(it);
+  }
+}
+
+void MatchTracer::Retire(std::unordered_map<std::string, ActiveTrace>::iterator it) {
+  auto& trace = it->second;
+  if (trace.sampled && max_samples_ > 0) {
+    nlohmann::json joins = nlohmann::json::array();
+    for (const auto& join : trace.joins) {
+      auto offset =
+          std::chrono::duration_cast<std::chrono::microseconds>(join.second.joined_at - trace.paired_at).count();
+      joins.push_back({{"userId", join.first}, {"traceId", join.second.trace_id}, {"offsetUs", offset}});
+    }
+    nlohmann::json events = nlohmann::json::array();
+    for (const auto& evt : trace.events) {
+      nlohmann::json item{{"name", evt.name}, {"offsetUs", evt.offset_us}};
+      if (evt.user_id) {
+        item["userId"] = *evt.user_id;
+      }
+      events.push_back(std::move(item));
+    }
+    samples_.push_back({{"traceId", trace.trace_id},
+                        {"sessionId", trace.session_id},
+                        {"joins", joins},
+                        {"events", events}});
+    while (samples_.size() > max_samples_) {
+      samples_.pop_front();
+    }
+  }
+  active_.erase(it);
+}
+
+nlohmann::json MatchTracer::HistogramsJson() const {
+  return {{"joinToPair", join_to_pair_.ToJson(1000.0, "Ms")},
+          {"pairToCreated", pair_to_created_.ToJson(1000.0, "Ms")},
+          {"createdToFirstTick", created_to_first_tick_.ToJson(1000.0, "Ms")},
+          {"queueToStart", queue_to_start_.ToJson(1000.0, "Ms")},
+          {"endToRatingApplied", end_to_rating_applied_.ToJson(1000.0, "Ms")}};
+}
+
+nlohmann::json MatchTracer::SampledTracesJson() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  nlohmann::json traces = nlohmann::json::array();
+  for (auto it = samples_.rbegin(); it != samples_.rend(); ++it) {
+    traces.push_back(*it);
+  }
+  return traces;
+}
+
+std::size_t MatchTracer::OpenTraceCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return active_.size();
+}
+
+}  // namespace server
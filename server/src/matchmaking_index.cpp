@@ -0,0 +1,191 @@
+/*
+ * 설명: 대기 중인 플레이어를 레이팅 순으로 색인하고, 대기 시간에 따라 넓어지는 레이팅 창 안에서 매치를 만든다.
+ * 버전: v1.0.0
+ * 관련 문서: design/server/v0.5.0-match-session.md
+ * 테스트: server/tests/unit/matchmaking_index_test.cpp
+ */
+#include "server/matchmaking_index.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <limits>
+
+namespace server {
+
+MatchmakingIndex::MatchmakingIndex(const MatchmakingConfig& config) : config_(config) {}
+
+bool MatchmakingIndex::Add(MatchTicket ticket) {
+  if (seq_of_user_.count(ticket.user_id) > 0) {
+    return false;
+  }
+  const auto seq = next_seq_++;
+  seq_of_user_.emplace(ticket.user_id, seq);
+  by_rating_.emplace(ticket.rating, seq);
+  by_joined_.emplace(ticket.joined_at, seq);
+  PushDeadline(ticket.expires_at, seq);
+  tickets_.emplace(seq, std::move(ticket));
+  return true;
+}
+
+void MatchmakingIndex::PushDeadline(std::chrono::steady_clock::time_point expires_at, std::uint64_t seq) {
+  if (deadlines_.size() >= 2 * tickets_.size() + 64) {
+    deadlines_.erase(std::remove_if(deadlines_.begin(), deadlines_.end(),
+                                    [this](const Deadline& deadline) { return tickets_.count(deadline.second) == 0; }),
+                     deadlines_.end());
+    std::make_heap(deadlines_.begin(), deadlines_.end(), std::greater<>());
+  }
+  deadlines_.emplace_back(expires_at, seq);
+  std::push_heap(deadlines_.begin(), deadlines_.end(), std::greater<>());
+}
+
+bool MatchmakingIndex::Remove(int user_id) {
+  auto it = seq_of_user_.find(user_id);
+  if (it == seq_of_user_.end()) {
+    return false;
+  }
+  Erase(it->second);
+  return true;
+}
+
+void MatchmakingIndex::Erase(std::uint64_t seq) {
+  auto it = tickets_.find(seq);
+  if (it == tickets_.end()) {
+    return;
+  }
+  by_rating_.erase(RatingKey{it->second.rating, seq});
+  by_joined_.erase({it->second.joined_at, seq});
+  seq_of_user_.erase(it->second.user_id);
+  tickets_.erase(it);
+}
+
+int MatchmakingIndex::WindowFor(std::chrono::steady_clock::duration wait) const {
+  const auto waited_ms = std::max<std::int64_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(wait).count(), 0);
+  const std::int64_t window =
+      static_cast<std::int64_t>(config_.base_window) + config_.widen_per_second * waited_ms / 1000;
+  if (config_.max_window > 0) {
+    return static_cast<int>(std::min<std::int64_t>(window, config_.max_window));
+  }
+  return static_cast<int>(std::min<std::int64_t>(window, std::numeric_limits<int>::max()));
+}
+
+bool MatchmakingIndex::PopMatch(std::chrono::steady_clock::time_point now, std::size_t size,
+                                std::vector<MatchTicket>& out, Scan& scan) {
+  if (size == 0 || tickets_.size() < size) {
+    return false;
+  }
+  // 오래 기다린 티켓일수록 창이 넓으므로 앞에서부터 앵커로 시도한다. 이미 실패한 앵커는 scan 앞에 있다.
+  for (auto it = tickets_.lower_bound(scan.next_seq); it != tickets_.end(); ++it) {
+    const auto seq = it->first;
+    if (TryAnchor(seq, now, size, false, out)) {
+      scan.next_seq = seq + 1;
+      return true;
+    }
+  }
+  scan.next_seq = next_seq_;
+  return false;
+}
+
+bool MatchmakingIndex::PopMatchFor(int user_id, std::chrono::steady_clock::time_point now, std::size_t size,
+                                   std::vector<MatchTicket>& out) {
+  if (size == 0 || tickets_.size() < size) {
+    return false;
+  }
+  auto it = seq_of_user_.find(user_id);
+  if (it == seq_of_user_.end()) {
+    return false;
+  }
+  return TryAnchor(it->second, now, size, true, out);
+}
+
+bool MatchmakingIndex::TryAnchor(std::uint64_t anchor_seq, std::chrono::steady_clock::time_point now,
+                                 std::size_t size, bool candidate_window, std::vector<MatchTicket>& out) {
+  const auto& anchor = tickets_.at(anchor_seq);
+  const std::int64_t window = WindowFor(now - anchor.joined_at);
+  const auto anchor_pos = by_rating_.find(RatingKey{anchor.rating, anchor_seq});
+  const auto allowed = [&](std::set<RatingKey>::const_iterator pos) -> std::int64_t {
+    if (!candidate_window) {
+      return window;
+    }
+    return std::max<std::int64_t>(window, WindowFor(now - tickets_.at(pos->second).joined_at));
+  };
+
+  // 앵커 위치에서 아래/위로 레이팅 차이가 작은 쪽부터 한 칸씩 넓히며 허용 범위 안의 후보를 고른다. 같으면 낮은 쪽을 먼저 본다.
+  // 후보 창 모드에서는 가까운 후보가 범위 밖이어도 더 멀리 있는 오래 기다린 후보의 창이 앵커를 덮을 수 있으므로,
+  // 지금 대기자 중 가장 넓은 창(가장 오래 기다린 티켓의 창)까지는 범위 밖 후보를 건너뛰며 계속 본다.
+  // max_window가 0(제한 없음)이어도 이 범위 밖은 보지 않으므로 짝이 없는 입장이 색인 전체를 훑지 않는다.
+  constexpr std::int64_t kOut = std::numeric_limits<std::int64_t>::max();
+  std::int64_t reach = window;
+  if (candidate_window) {
+    reach = std::max<std::int64_t>(window, WindowFor(now - by_joined_.begin()->first));
+  }
+  picked_.clear();
+  picked_.push_back(anchor_pos);
+  auto below = anchor_pos;
+  auto above = std::next(anchor_pos);
+  while (picked_.size() < size) {
+    std::int64_t gap_below = kOut;
+    if (below != by_rating_.begin()) {
+      const auto gap = static_cast<std::int64_t>(anchor.rating) - std::prev(below)->first;
+      gap_below = gap <= reach ? gap : kOut;
+    }
+    std::int64_t gap_above = kOut;
+    if (above != by_rating_.end()) {
+      const auto gap = static_cast<std::int64_t>(above->first) - anchor.rating;
+      gap_above = gap <= reach ? gap : kOut;
+    }
+    if (gap_below == kOut && gap_above == kOut) {
+      return false;
+    }
+    const bool take_below = gap_below <= gap_above;
+    const auto pos = take_below ? --below : above++;
+    if ((take_below ? gap_below : gap_above) <= allowed(pos)) {
+      picked_.push_back(pos);
+    }
+  }
+
+  out.clear();
+  out.reserve(size);
+  for (const auto& pos : picked_) {
+    out.push_back(std::move(tickets_.at(pos->second)));
+  }
+  for (std::size_t i = 0; i < picked_.size(); ++i) {
+    const auto seq = picked_[i]->second;
+    by_rating_.erase(picked_[i]);
+    by_joined_.erase({out[i].joined_at, seq});
+    seq_of_user_.erase(out[i].user_id);
+    tickets_.erase(seq);
+  }
+  return true;
+}
+
+std::size_t MatchmakingIndex::RemoveExpired(std::chrono::steady_clock::time_point now,
+                                            std::vector<MatchTicket>& expired) {
+  std::size_t removed = 0;
+  while (!deadlines_.empty() && deadlines_.front().first <= now) {
+    const auto seq = deadlines_.front().second;
+    std::pop_heap(deadlines_.begin(), deadlines_.end(), std::greater<>());
+    deadlines_.pop_back();
+    auto it = tickets_.find(seq);
+    if (it == tickets_.end()) {
+      continue;
+    }
+    by_rating_.erase(RatingKey{it->second.rating, seq});
+    by_joined_.erase({it->second.joined_at, seq});
+    seq_of_user_.erase(it->second.user_id);
+    expired.push_back(std::move(it->second));
+    tickets_.erase(it);
+    ++removed;
+  }
+  return removed;
+}
+
+std::optional<std::chrono::steady_clock::time_point> MatchmakingIndex::NextDeadline() const {
+  if (deadlines_.empty()) {
+    return std::nullopt;
+  }
+  return deadlines_.front().first;
+}
+
+}  // namespace server
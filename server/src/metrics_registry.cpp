@@ -0,0 +1,72 @@
+/*
+ * 설명: 스레드별 캐시 라인 정렬 슬롯에 카운터를 누적하고 조회 시에만 합산하는 메트릭 레지스트리.
+ * 버전: v1.0.0
+ * 관련 문서: design/ops/v0.7.0-observability.md
+ * 테스트: server/tests/unit/metrics_registry_test.cpp
+ */
+#include "server/metrics_registry.hpp"
+
+#include <utility>
+
+namespace server {
+
+namespace {
+
+std::atomic<std::uint64_t> g_next_registry_id{1};
+
+// 스레드가 접근한 레지스트리별 슬롯 캐시. 레지스트리 id는 재사용되지 않으므로
+// 소멸된 레지스트리 항목이 남아 있어도 다시 일치하지 않는다.
+struct LocalShardCache {
+  std::uint64_t last_id{0};
+  void* last_shard{nullptr};
+  std::vector<std::pair<std::uint64_t, void*>> entries;
+};
+
+thread_local LocalShardCache t_shard_cache;
+
+}  // namespace
+
+MetricsRegistry::MetricsRegistry() : id_(g_next_registry_id.fetch_add(1)) {}
+
+MetricsRegistry::Shard& MetricsRegistry::LocalShard() {
+  auto& cache = t_shard_cache;
+  if (cache.last_id == id_) {
+    return *static_cast<Shard*>(cache.last_shard);
+  }
+  Shard* shard = nullptr;
+  for (const auto& entry : cache.entries) {
+    if (entry.first == id_) {
+      shard = static_cast<Shard*>(entry.second);
+      break;
+    }
+  }
+  if (shard == nullptr) {
+    shard = &RegisterShard();
+    cache.entries.emplace_back(id_, shard);
+  }
+  cache.last_id = id_;
+  cache.last_shard = shard;
+  return *shard;
+}
+
+MetricsRegistry::Shard& MetricsRegistry::RegisterShard() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  shards_.push_back(std::make_unique<Shard>());
+  return *shards_.back();
+}
+
+std::int64_t MetricsRegistry::Sum(Counter counter) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::int64_t total = 0;
+  for (const auto& shard : shards_) {
+    total += shard->values[static_cast<std::size_t>(counter)].load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+std::size_t MetricsRegistry::ShardCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return shards_.size();
+}
+
+}  // namespace server
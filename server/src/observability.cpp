@@ -19,22 +19,277 @@ std::string Observability::NextTraceId() {
   return oss.str();
 }
 
-void Observability::IncrementRequest() { request_total_.fetch_add(1); }
+void Observability::IncrementRequest() { metrics_.Add(Counter::kRequestTotal); }
 
-void Observability::IncrementError() { request_errors_.fetch_add(1); }
+void Observability::IncrementError() { metrics_.Add(Counter::kRequestErrors); }
 
-void Observability::SetWebsocketActive(std::uint64_t count) { websocket_active_.store(count); }
+void Observability::WebsocketOpened() { metrics_.Add(Counter::kWebsocketActive, 1); }
 
-MetricsSnapshot Observability::Snapshot(std::uint64_t active_sessions, std::uint64_t queue_length) const {
+void Observability::WebsocketClosed() { metrics_.Add(Counter::kWebsocketActive, -1); }
+
+void Observability::SessionDegraded(bool degraded) { metrics_.Add(Counter::kDegradedSessions, degraded ? 1 : -1); }
+
+void Observability::RecordStateFrame(bool full) {
+  metrics_.Add(full ? Counter::kFullStateFrames : Counter::kHashStateFrames);
+}
+
+void Observability::RecordDesyncReport(bool confirmed) {
+  metrics_.Add(Counter::kDesyncReports);
+  if (confirmed) {
+    metrics_.Add(Counter::kDesyncConfirmed);
+  }
+}
+
+void Observability::RecordFanout(std::size_t recipients, std::size_t player_entries,
+                                 std::chrono::microseconds elapsed) {
+  metrics_.Add(Counter::kFanoutFrames, static_cast<std::int64_t>(recipients));
+  metrics_.Add(Counter::kFanoutPlayerEntries, static_cast<std::int64_t>(player_entries));
+  fanout_latency_.Record(static_cast<std::uint64_t>(elapsed.count()));
+}
+
+void Observability::RecordTickPass(std::size_t sessions, std::chrono::microseconds step,
+                                   std::chrono::microseconds pass) {
+  metrics_.Add(Counter::kTickPasses);
+  metrics_.Add(Counter::kTickPassSessions, static_cast<std::int64_t>(sessions));
+  tick_step_latency_.Record(static_cast<std::uint64_t>(step.count()));
+  tick_pass_latency_.Record(static_cast<std::uint64_t>(pass.count()));
+}
+
+void Observability::RecordSessionPool(bool hit) {
+  metrics_.Add(hit ? Counter::kSessionPoolHits : Counter::kSessionPoolMisses);
+}
+
+void Observability::RecordResultBatch(std::size_t applied, std::size_t duplicates) {
+  metrics_.Add(Counter::kResultBatches);
+  metrics_.Add(Counter::kResultRecords, static_cast<std::int64_t>(applied));
+  metrics_.Add(Counter::kResultDuplicates, static_cast<std::int64_t>(duplicates));
+}
+
+void Observability::RecordResultLag(std::chrono::microseconds lag) {
+  result_lag_.Record(static_cast<std::uint64_t>(lag.count()));
+}
+
+void Observability::RecordMigration(MigrationOutcome outcome) {
+  switch (outcome) {
+    case MigrationOutcome::kExported:
+      metrics_.Add(Counter::kMigrationsExported);
+      break;
+    case MigrationOutcome::kImported:
+      metrics_.Add(Counter::kMigrationsImported);
+      break;
+    case MigrationOutcome::kFailed:
+      metrics_.Add(Counter::kMigrationsFailed);
+      break;
+    case MigrationOutcome::kInDoubt:
+      metrics_.Add(Counter::kMigrationsInDoubt);
+      break;
+    case MigrationOutcome::kAborted:
+      metrics_.Add(Counter::kMigrationsAborted);
+      break;
+  }
+}
+
+void Observability::RecordMigrationPause(std::uint64_t ticks) { migration_pause_ticks_.Record(ticks); }
+
+void Observability::RecordAdmission(AdmissionVerdict verdict, bool deferred_pair) {
+  if (deferred_pair) {
+    metrics_.Add(Counter::kAdmissionDeferredPairs);
+    return;
+  }
+  switch (verdict) {
+    case AdmissionVerdict::kAdmit:
+      break;
+    case AdmissionVerdict::kTooManySessions:
+      metrics_.Add(Counter::kAdmissionRejectedSessions);
+      break;
+    case AdmissionVerdict::kTickLateness:
+      metrics_.Add(Counter::kAdmissionRejectedTickLateness);
+      break;
+    case AdmissionVerdict::kLoopLag:
+      metrics_.Add(Counter::kAdmissionRejectedLoopLag);
+      break;
+  }
+}
+
+void Observability::RecordResimulation(int ticks, std::chrono::microseconds elapsed) {
+  metrics_.Add(Counter::kRollbackCorrections);
+  metrics_.Add(Counter::kResimulatedTicks, ticks);
+  resimulation_latency_.Record(static_cast<std::uint64_t>(elapsed.count()));
+}
+
+namespace {
+
+std::uint64_t NonNegative(std::int64_t value) { return value > 0 ? static_cast<std::uint64_t>(value) : 0; }
+
+}  // namespace
+
+std::uint64_t MetricsSnapshot::QueueLengthTotal() const {
+  std::uint64_t total = 0;
+  for (const auto& queue : queues) {
+    total += queue.length;
+  }
+  return total;
+}
+
+MetricsSnapshot Observability::Snapshot(std::uint64_t active_sessions, std::vector<QueueModeSnapshot> queues) const {
   MetricsSnapshot snapshot;
-  snapshot.request_total = request_total_.load();
-  snapshot.request_errors = request_errors_.load();
-  snapshot.websocket_active = websocket_active_.load();
+  snapshot.request_total = NonNegative(metrics_.Sum(Counter::kRequestTotal));
+  snapshot.request_errors = NonNegative(metrics_.Sum(Counter::kRequestErrors));
+  // 연결/해제가 서로 다른 스레드 슬롯에 기록되므로 합산 시점에 따라 일시적으로 음수일 수 있다.
+  snapshot.websocket_active = NonNegative(metrics_.Sum(Counter::kWebsocketActive));
   snapshot.active_sessions = active_sessions;
-  snapshot.queue_length = queue_length;
+  snapshot.degraded_sessions = NonNegative(metrics_.Sum(Counter::kDegradedSessions));
+  snapshot.queues = std::move(queues);
   return snapshot;
 }
 
+nlohmann::json Observability::RollbackJson() const {
+  return nlohmann::json{{"corrections", NonNegative(metrics_.Sum(Counter::kRollbackCorrections))},
+                        {"resimulatedTicks", NonNegative(metrics_.Sum(Counter::kResimulatedTicks))},
+                        {"latency", resimulation_latency_.ToJson(1000.0, "Ms")}};
+}
+
+nlohmann::json Observability::StateSyncJson() const {
+  return nlohmann::json{{"fullFrames", NonNegative(metrics_.Sum(Counter::kFullStateFrames))},
+                        {"hashFrames", NonNegative(metrics_.Sum(Counter::kHashStateFrames))},
+                        {"desyncReports", NonNegative(metrics_.Sum(Counter::kDesyncReports))},
+                        {"desyncConfirmed", NonNegative(metrics_.Sum(Counter::kDesyncConfirmed))}};
+}
+
+nlohmann::json Observability::FanoutJson() const {
+  const auto frames = NonNegative(metrics_.Sum(Counter::kFanoutFrames));
+  const auto entries = NonNegative(metrics_.Sum(Counter::kFanoutPlayerEntries));
+  return nlohmann::json{{"frames", frames},
+                        {"playerEntries", entries},
+                        {"playersPerFrame", frames == 0 ? 0.0 : static_cast<double>(entries) / static_cast<double>(frames)},
+                        {"latency", fanout_latency_.ToJson(1000.0, "Ms")}};
+}
+
+nlohmann::json Observability::TickBatchJson() const {
+  const auto passes = NonNegative(metrics_.Sum(Counter::kTickPasses));
+  const auto sessions = NonNegative(metrics_.Sum(Counter::kTickPassSessions));
+  return nlohmann::json{{"passes", passes},
+                        {"sessions", sessions},
+                        {"sessionsPerPass", passes == 0 ? 0.0 : static_cast<double>(sessions) / static_cast<double>(passes)},
+                        {"stepLatency", tick_step_latency_.ToJson(1000.0, "Ms")},
+                        {"passLatency", tick_pass_latency_.ToJson(1000.0, "Ms")}};
+}
+
+nlohmann::json Observability::SessionPoolJson(std::uint64_t pooled, std::uint64_t high_water) const {
+  return nlohmann::json{{"hits", NonNegative(metrics_.Sum(Counter::kSessionPoolHits))},
+                        {"misses", NonNegative(metrics_.Sum(Counter::kSessionPoolMisses))},
+                        {"pooled", pooled},
+                        {"highWater", high_water}};
+}
+
+nlohmann::json Observability::ResultFinalizerJson(std::uint64_t pending) const {
+  const auto batches = NonNegative(metrics_.Sum(Counter::kResultBatches));
+  const auto records = NonNegative(metrics_.Sum(Counter::kResultRecords));
+  return nlohmann::json{{"pending", pending},
+                        {"batches", batches},
+                        {"records", records},
+                        {"duplicates", NonNegative(metrics_.Sum(Counter::kResultDuplicates))},
+                        {"recordsPerBatch", batches == 0 ? 0.0 : static_cast<double>(records) / static_cast<double>(batches)},
+                        {"lag", result_lag_.ToJson(1000.0, "Ms")}};
+}
+
+nlohmann::json Observability::MigrationJson() const {
+  return nlohmann::json{{"exported", NonNegative(metrics_.Sum(Counter::kMigrationsExported))},
+                        {"imported", NonNegative(metrics_.Sum(Counter::kMigrationsImported))},
+                        {"failed", NonNegative(metrics_.Sum(Counter::kMigrationsFailed))},
+                        {"inDoubt", NonNegative(metrics_.Sum(Counter::kMigrationsInDoubt))},
+                        {"aborted", NonNegative(metrics_.Sum(Counter::kMigrationsAborted))},
+                        {"pauseTicks", migration_pause_ticks_.ToJson(1.0, "Ticks")}};
+}
+
+nlohmann::json Observability::AdmissionJson(std::chrono::microseconds tick_lateness) const {
+  return nlohmann::json{{"rejected",
+                         {{"sessions", NonNegative(metrics_.Sum(Counter::kAdmissionRejectedSessions))},
+                          {"tickLateness", NonNegative(metrics_.Sum(Counter::kAdmissionRejectedTickLateness))},
+                          {"loopLag", NonNegative(metrics_.Sum(Counter::kAdmissionRejectedLoopLag))}}},
+                        {"deferredPairs", NonNegative(metrics_.Sum(Counter::kAdmissionDeferredPairs))},
+                        {"tickLatenessMs", static_cast<double>(tick_lateness.count()) / 1000.0}};
+}
+
+void Observability::SpectatorJoined() { metrics_.Add(Counter::kSpectatorsActive, 1); }
+
+void Observability::SpectatorsLeft(std::size_t count) {
+  if (count > 0) {
+    metrics_.Add(Counter::kSpectatorsActive, -static_cast<std::int64_t>(count));
+  }
+}
+
+void Observability::RecordSpectatorFanout(std::size_t frames, std::size_t dropped, std::chrono::microseconds elapsed) {
+  metrics_.Add(Counter::kSpectatorFrames, static_cast<std::int64_t>(frames));
+  metrics_.Add(Counter::kSpectatorFramesDropped, static_cast<std::int64_t>(dropped));
+  spectator_fanout_latency_.Record(static_cast<std::uint64_t>(elapsed.count()));
+}
+
+nlohmann::json Observability::SpectatorJson() const {
+  return nlohmann::json{{"active", NonNegative(metrics_.Sum(Counter::kSpectatorsActive))},
+                        {"frames", NonNegative(metrics_.Sum(Counter::kSpectatorFrames))},
+                        {"dropped", NonNegative(metrics_.Sum(Counter::kSpectatorFramesDropped))},
+                        {"latency", spectator_fanout_latency_.ToJson(1000.0, "Ms")}};
+}
+
+std::size_t Observability::RegisterQueueMode(const std::string& mode) {
+  for (std::size_t i = 0; i < queue_modes_.size(); ++i) {
+    if (queue_modes_[i]->mode == mode) {
+      return i;
+    }
+  }
+  auto metrics = std::make_unique<QueueModeMetrics>();
+  metrics->mode = mode;
+  queue_modes_.push_back(std::move(metrics));
+  return queue_modes_.size() - 1;
+}
+
+void Observability::RecordMatchmakingWait(std::size_t mode, std::chrono::microseconds wait) {
+  const auto micros = static_cast<std::uint64_t>(std::max<std::int64_t>(wait.count(), 0));
+  matchmaking_wait_.Record(micros);
+  if (mode < queue_modes_.size()) {
+    queue_modes_[mode]->wait.Record(micros);
+  }
+}
+
+void Observability::RecordMatchFormed(std::size_t mode, int rating_gap) {
+  metrics_.Add(Counter::kMatchesFormed);
+  match_rating_gap_.Record(static_cast<std::uint64_t>(std::max(rating_gap, 0)));
+  if (mode < queue_modes_.size()) {
+    queue_modes_[mode]->matches.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+nlohmann::json Observability::QueueJson(const std::vector<QueueModeSnapshot>& queues) const {
+  std::uint64_t total = 0;
+  nlohmann::json modes = nlohmann::json::object();
+  for (const auto& queue : queues) {
+    total += queue.length;
+    nlohmann::json mode{{"length", queue.length}, {"pendingCommands", queue.pending_commands}};
+    for (const auto& metrics : queue_modes_) {
+      if (metrics->mode == queue.mode) {
+        mode["matches"] = metrics->matches.load(std::memory_order_relaxed);
+        mode["wait"] = metrics->wait.ToJson(1000.0, "Ms");
+        break;
+      }
+    }
+    modes[queue.mode] = std::move(mode);
+  }
+  return nlohmann::json{{"length", total}, {"modes", std::move(modes)}};
+}
+
+void Observability::RecordMatchmakerCommand(std::chrono::microseconds lag) {
+  matchmaker_command_lag_.Record(static_cast<std::uint64_t>(std::max<std::int64_t>(lag.count(), 0)));
+}
+
+nlohmann::json Observability::MatchmakingJson(std::uint64_t pending_commands) const {
+  return nlohmann::json{{"matches", NonNegative(metrics_.Sum(Counter::kMatchesFormed))},
+                        {"wait", matchmaking_wait_.ToJson(1000.0, "Ms")},
+                        {"ratingGap", match_rating_gap_.ToJson(1.0, "")},
+                        {"pendingCommands", pending_commands},
+                        {"commandLag", matchmaker_command_lag_.ToJson(1000.0, "Ms")}};
+}
+
 void Observability::Log(const LogContext& ctx) const {
   nlohmann::json log_json;
   log_json["traceId"] = ctx.trace_id;
@@ -0,0 +1,202 @@
+/*
+ * 설명: ITIMER_PROF/SIGPROF로 등록된 워커 스레드의 호출 스택을 샘플링하고 심볼화해 folded stack을 만든다.
+ * 버전: v1.0.0
+ * 관련 문서: design/ops/v1.0.0-runbook.md, design/protocol/contract.md
+ * 테스트: server/tests/e2e/metrics_ops_test.cpp
+ */
+#include "server/profiler.hpp"
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+namespace server {
+namespace {
+
+struct Sample {
+  std::atomic<bool> ready{false};
+  int worker_index{-1};
+  int depth{0};
+  void* frames[SamplingProfiler::kMaxDepth];
+};
+
+// 핸들러 자신과 시그널 트램펄린 프레임은 결과에서 제외한다.
+constexpr int kSkipFrames = 2;
+
+thread_local int t_worker_index = -1;
+
+std::unique_ptr<Sample[]> g_samples;
+std::atomic<bool> g_active{false};
+std::atomic<int> g_inflight{0};
+std::atomic<std::size_t> g_next{0};
+std::atomic<std::size_t> g_dropped{0};
+int g_frequency_hz = 0;
+std::mutex g_control_mutex;
+bool g_handler_installed = false;
+
+void OnProfSignal(int /*signo*/, siginfo_t* /*info*/, void* /*ucontext*/) {
+  const int saved_errno = errno;
+  // Stop()과 store→load 핸드셰이크를 이루므로 양쪽 모두 seq_cst여야 한다. acquire/release로는
+  // 핸들러가 active를 보면서 Stop()이 inflight 0을 보는 재배열이 허용된다.
+  g_inflight.fetch_add(1);
+  if (g_active.load()) {
+    if (t_worker_index < 0) {
+      g_dropped.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      auto index = g_next.fetch_add(1, std::memory_order_relaxed);
+      if (index < SamplingProfiler::kMaxSamples) {
+        auto& sample = g_samples[index];
+        sample.worker_index = t_worker_index;
+        sample.depth = backtrace(sample.frames, SamplingProfiler::kMaxDepth);
+        sample.ready.store(true, std::memory_order_release);
+      } else {
+        g_dropped.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  }
+  g_inflight.fetch_sub(1);
+  errno = saved_errno;
+}
+
+std::string Symbolize(void* address) {
+  Dl_info info{};
+  if (dladdr(address, &info) == 0) {
+    std::ostringstream oss;
+    oss << address;
+    return oss.str();
+  }
+  std::string name;
+  if (info.dli_sname != nullptr) {
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+    name = (status == 0 && demangled != nullptr) ? demangled : info.dli_sname;
+    std::free(demangled);
+  } else {
+    // 심볼이 없으면 모듈+오프셋으로 남겨 오프라인(addr2line) 심볼화가 가능하게 한다.
+    std::string module = info.dli_fname != nullptr ? info.dli_fname : "?";
+    auto slash = module.rfind('/');
+    if (slash != std::string::npos) {
+      module = module.substr(slash + 1);
+    }
+    std::ostringstream oss;
+    oss << module << "+0x" << std::hex
+        << (reinterpret_cast<std::uintptr_t>(address) - reinterpret_cast<std::uintptr_t>(info.dli_fbase));
+    name = oss.str();
+  }
+  for (auto& ch : name) {
+    if (ch == ';' || ch == '\n') {
+      ch = ':';
+    }
+  }
+  return name;
+}
+
+}  // namespace
+
+void SamplingProfiler::RegisterCurrentThread(int worker_index) { t_worker_index = worker_index; }
+
+bool SamplingProfiler::Start(int frequency_hz) {
+  std::lock_guard<std::mutex> lock(g_control_mutex);
+  if (g_active.load()) {
+    return false;
+  }
+  if (!g_samples) {
+    g_samples = std::make_unique<Sample[]>(kMaxSamples);
+    // backtrace는 첫 호출 때 libgcc를 로드하므로 시그널 핸들러 밖에서 미리 한 번 호출한다.
+    void* warmup[2];
+    backtrace(warmup, 2);
+  }
+  for (std::size_t i = 0; i < kMaxSamples; ++i) {
+    g_samples[i].ready.store(false, std::memory_order_relaxed);
+  }
+  g_next.store(0);
+  g_dropped.store(0);
+  g_frequency_hz = frequency_hz > 0 ? frequency_hz : kDefaultFrequencyHz;
+
+  if (!g_handler_installed) {
+    // 타이머 정지 후 늦게 도착한 SIGPROF가 프로세스를 종료시키지 않도록 핸들러는 계속 유지한다.
+    struct sigaction action {};
+    action.sa_sigaction = &OnProfSignal;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, nullptr) != 0) {
+      return false;
+    }
+    g_handler_installed = true;
+  }
+
+  g_active.store(true);
+  itimerval timer{};
+  timer.it_interval.tv_sec = 0;
+  timer.it_interval.tv_usec = 1'000'000 / g_frequency_hz;
+  timer.it_value = timer.it_interval;
+  if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+    g_active.store(false);
+    return false;
+  }
+  return true;
+}
+
+ProfileResult SamplingProfiler::Stop() {
+  std::lock_guard<std::mutex> lock(g_control_mutex);
+  ProfileResult result;
+  if (!g_active.load()) {
+    return result;
+  }
+  itimerval disabled{};
+  setitimer(ITIMER_PROF, &disabled, nullptr);
+  // 핸들러의 inflight 증가 → active 확인과 짝을 이룬다(seq_cst). 이 뒤로는 새 핸들러가 버퍼를 쓰지 않는다.
+  g_active.store(false);
+  while (g_inflight.load() != 0) {
+    std::this_thread::yield();
+  }
+
+  const auto collected = std::min(g_next.load(), kMaxSamples);
+  std::unordered_map<void*, std::string> symbols;
+  std::map<std::string, std::size_t> stacks;
+  for (std::size_t i = 0; i < collected; ++i) {
+    const auto& sample = g_samples[i];
+    if (!sample.ready.load(std::memory_order_acquire)) {
+      continue;
+    }
+    std::string line = "worker-" + std::to_string(sample.worker_index);
+    for (int f = sample.depth - 1; f >= kSkipFrames; --f) {
+      auto* address = sample.frames[f];
+      auto it = symbols.find(address);
+      if (it == symbols.end()) {
+        it = symbols.emplace(address, Symbolize(address)).first;
+      }
+      line += ';';
+      line += it->second;
+    }
+    ++stacks[line];
+    ++result.samples;
+  }
+
+  std::ostringstream folded;
+  for (const auto& entry : stacks) {
+    folded << entry.first << ' ' << entry.second << '\n';
+  }
+  result.folded = folded.str();
+  result.dropped = g_dropped.load();
+  result.frequency_hz = g_frequency_hz;
+  return result;
+}
+
+bool SamplingProfiler::Running() { return g_active.load(); }
+
+}  // namespace server
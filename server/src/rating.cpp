@@ -15,9 +15,13 @@ RatingService::RatingService() = default;
 
 void RatingService::EnsureUser(int user_id, const std::string& username) {
   std::lock_guard<std::mutex> lock(mutex_);
+  EnsureUserLocked(user_id, username);
+}
+
+void RatingService::EnsureUserLocked(int user_id, const std::string& username) {
   auto it = entries_.find(user_id);
   if (it == entries_.end()) {
-    entries_.emplace(user_id, Entry{username, initial_rating_, 0, 0});
+    entries_.emplace(user_id, Entry{username, kInitialRating, 0, 0});
     return;
   }
   if (!username.empty()) {
@@ -26,28 +30,68 @@ void RatingService::EnsureUser(int user_id, const std::string& username) {
 }
 
 RatingSummary RatingService::ApplyMatchResult(int winner_id, int loser_id) {
+  return ApplyRankedResult({winner_id, loser_id}).front();
+}
+
+std::vector<RatingSummary> RatingService::ApplyRankedResult(const std::vector<int>& ranked_user_ids) {
+  std::vector<RatingSummary> summaries;
   std::lock_guard<std::mutex> lock(mutex_);
-  auto ensure = [this](int user_id) -> Entry& {
+  ApplyRankedLocked(ranked_user_ids, &summaries);
+  return summaries;
+}
+
+void RatingService::ApplyRankedResults(const std::vector<RankedMatchResult>& results) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& result : results) {
+    for (const auto& user : result.users) {
+      EnsureUserLocked(user.first, user.second);
+    }
+    ApplyRankedLocked(result.ranked_user_ids, nullptr);
+  }
+}
+
+void RatingService::ApplyRankedLocked(const std::vector<int>& ranked_user_ids, std::vector<RatingSummary>* summaries) {
+  if (ranked_user_ids.empty()) {
+    return;
+  }
+  std::vector<Entry*> players;
+  players.reserve(ranked_user_ids.size());
+  for (int user_id : ranked_user_ids) {
     auto it = entries_.find(user_id);
     if (it == entries_.end()) {
-      auto inserted = entries_.emplace(user_id, Entry{"", initial_rating_, 0, 0});
-      return inserted.first->second;
+      it = entries_.emplace(user_id, Entry{"", kInitialRating, 0, 0}).first;
     }
-    return it->second;
-  };
-
-  Entry& winner = ensure(winner_id);
-  Entry& loser = ensure(loser_id);
-
-  double expected_winner = ExpectedScore(winner.rating, loser.rating);
-  double expected_loser = ExpectedScore(loser.rating, winner.rating);
+    players.push_back(&it->second);
+  }
 
-  winner.rating = ApplyElo(winner.rating, expected_winner, 1.0);
-  loser.rating = ApplyElo(loser.rating, expected_loser, 0.0);
-  winner.wins += 1;
-  loser.losses += 1;
+  // 기대 점수는 모두 경기 전 레이팅으로 계산한 뒤 한 번에 반영한다.
+  const std::size_t n = players.size();
+  const double pair_k = n > 1 ? static_cast<double>(k_factor_) / static_cast<double>(n - 1) : 0.0;
+  std::vector<double> deltas(n, 0.0);
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = i + 1; j < n; ++j) {
+      const double expected_i = ExpectedScore(players[i]->rating, players[j]->rating);
+      const double expected_j = ExpectedScore(players[j]->rating, players[i]->rating);
+      deltas[i] += pair_k * (1.0 - expected_i);
+      deltas[j] += pair_k * (0.0 - expected_j);
+    }
+  }
 
-  return RatingSummary{winner_id, winner.username, winner.rating, winner.wins, winner.losses};
+  if (summaries) {
+    summaries->reserve(n);
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    Entry& entry = *players[i];
+    entry.rating = static_cast<int>(std::round(static_cast<double>(entry.rating) + deltas[i]));
+    if (i == 0) {
+      entry.wins += 1;
+    } else {
+      entry.losses += 1;
+    }
+    if (summaries) {
+      summaries->push_back(RatingSummary{ranked_user_ids[i], entry.username, entry.rating, entry.wins, entry.losses});
+    }
+  }
 }
 
 std::optional<RatingSummary> RatingService::GetSummary(int user_id) {
@@ -93,10 +137,4 @@ double RatingService::ExpectedScore(int rating_a, int rating_b) const {
   return 1.0 / (1.0 + std::pow(10.0, exponent));
 }
 
-int RatingService::ApplyElo(int rating, double expected, double score) const {
-  double delta = static_cast<double>(k_factor_) * (score - expected);
-  int next = static_cast<int>(std::round(static_cast<double>(rating) + delta));
-  return next;
-}
-
 }  // namespace server
@@ -11,24 +11,27 @@
 namespace server {
 
 void RealtimeCoordinator::Register(int user_id, const std::shared_ptr<WebSocketSession>& session) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  connections_[user_id] = Entry{session, session.get()};
-  if (observability_) {
-    observability_->SetWebsocketActive(connections_.size());
+  bool inserted = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    inserted = connections_.insert_or_assign(user_id, Entry{session, session.get()}).second;
+  }
+  if (inserted && observability_) {
+    observability_->WebsocketOpened();
   }
 }
 
 void RealtimeCoordinator::Unregister(int user_id, const WebSocketSession* session) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  auto it = connections_.find(user_id);
-  if (it == connections_.end()) {
-    return;
-  }
-  if (it->second.raw == session) {
-    connections_.erase(it);
-    if (observability_) {
-      observability_->SetWebsocketActive(connections_.size());
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = connections_.find(user_id);
+    if (it == connections_.end() || it->second.raw != session) {
+      return;
     }
+    connections_.erase(it);
+  }
+  if (observability_) {
+    observability_->WebsocketClosed();
   }
 }
 
@@ -62,6 +65,21 @@ void RealtimeCoordinator::SendErrorToUser(int user_id, const std::string& code,
   }
 }
 
+void RealtimeCoordinator::SendFrameToUser(int user_id, const SharedFrame& frame) {
+  std::shared_ptr<WebSocketSession> session_ptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = connections_.find(user_id);
+    if (it == connections_.end()) {
+      return;
+    }
+    session_ptr = it->second.session.lock();
+  }
+  if (session_ptr) {
+    session_ptr->SendServerFrame(frame);
+  }
+}
+
 std::size_t RealtimeCoordinator::ActiveConnections() const {
   std::lock_guard<std::mutex> lock(mutex_);
   return connections_.size();
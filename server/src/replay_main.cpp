@@ -0,0 +1,109 @@
+/*
+ * 설명: 입력 저널을 Simulation으로 재생해 최종 스냅샷을 출력/검증하는 오프라인 도구.
+ *       사용법: replay <journal.bin> [expected_snapshot.json] [--repeat N] [--max-ticks N]
+ * 버전: v1.0.0
+ * 관련 문서: design/server/v0.3.0-tick-loop.md, design/ops/v1.0.0-runbook.md
+ * 테스트: server/tests/unit/input_journal_test.cpp
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+#include "server/input_journal.hpp"
+#include "server/simulation.hpp"
+
+namespace {
+
+bool ReadFile(const std::string& path, std::string& out) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return false;
+  }
+  out.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  return true;
+}
+
+int Usage() {
+  std::cerr << "사용법: replay <journal.bin> [expected_snapshot.json] [--repeat N] [--max-ticks N]\n";
+  return 2;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  using namespace server;
+  std::string journal_path;
+  std::string expected_path;
+  long repeat = 1;
+  // 도착 틱이 이 값을 넘는 저널은 재생하지 않고 tick_out_of_range로 거절한다.
+  int max_ticks = std::numeric_limits<int>::max();
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--repeat" && i + 1 < argc) {
+      repeat = std::max(1L, std::strtol(argv[++i], nullptr, 10));
+    } else if (arg == "--max-ticks" && i + 1 < argc) {
+      max_ticks = static_cast<int>(
+          std::clamp(std::strtol(argv[++i], nullptr, 10), 0L, static_cast<long>(std::numeric_limits<int>::max())));
+    } else if (journal_path.empty()) {
+      journal_path = arg;
+    } else if (expected_path.empty()) {
+      expected_path = arg;
+    } else {
+      return Usage();
+    }
+  }
+  if (journal_path.empty()) {
+    return Usage();
+  }
+
+  std::string journal;
+  if (!ReadFile(journal_path, journal)) {
+    std::cerr << "저널을 읽을 수 없습니다: " << journal_path << "\n";
+    return 2;
+  }
+
+  nlohmann::json snapshot;
+  ReplayResult result;
+  long long total_ticks = 0;
+  const auto started = std::chrono::steady_clock::now();
+  for (long i = 0; i < repeat; ++i) {
+    Simulation simulation;
+    result = ReplayJournal(journal, simulation, nullptr, max_ticks);
+    if (!result.ok) {
+      std::cerr << "재생 실패: " << result.error << " (적용 입력 " << result.inputs << "개)\n";
+      return 1;
+    }
+    total_ticks += result.final_tick;
+    if (i + 1 == repeat) {
+      snapshot = simulation.Snapshot();
+    }
+  }
+  const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+  std::cout << snapshot.dump() << "\n";
+  std::cerr << "inputs=" << result.inputs << " ticks=" << result.final_tick << " bytes=" << journal.size()
+            << " repeat=" << repeat << " ticksPerSec=" << (elapsed > 0 ? total_ticks / elapsed : 0.0) << "\n";
+
+  if (!expected_path.empty()) {
+    std::string expected_raw;
+    if (!ReadFile(expected_path, expected_raw)) {
+      std::cerr << "기대 스냅샷을 읽을 수 없습니다: " << expected_path << "\n";
+      return 2;
+    }
+    auto expected = nlohmann::json::parse(expected_raw, nullptr, false);
+    if (expected.is_discarded() || expected != snapshot) {
+      std::cerr << "스냅샷 불일치\n";
+      return 1;
+    }
+    std::cerr << "스냅샷 일치\n";
+  }
+  return 0;
+}
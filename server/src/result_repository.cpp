@@ -17,6 +17,30 @@ bool ResultRepository::SaveIfAbsent(const MatchResultRecord& record) {
   return true;
 }
 
+std::size_t ResultRepository::SaveAllIfAbsent(std::vector<MatchResultRecord>&& records) {
+  std::size_t saved = 0;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& record : records) {
+    if (records_.count(record.session_id) > 0) {
+      continue;
+    }
+    auto key = record.session_id;
+    records_.emplace(std::move(key), std::move(record));
+    ++saved;
+  }
+  return saved;
+}
+
+std::vector<bool> ResultRepository::ExistsAll(const std::vector<std::string>& session_ids) const {
+  std::vector<bool> exists;
+  exists.reserve(session_ids.size());
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& session_id : session_ids) {
+    exists.push_back(records_.count(session_id) > 0);
+  }
+  return exists;
+}
+
 bool ResultRepository::Exists(const std::string& session_id) const {
   std::lock_guard<std::mutex> lock(mutex_);
   return records_.count(session_id) > 0;
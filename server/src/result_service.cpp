@@ -2,31 +2,155 @@
  * 설명: 세션 결과를 저장하고 레이팅 반영을 단일 경로로 처리한다.
  * 버전: v1.0.0
  * 관련 문서: design/protocol/contract.md, design/server/v0.6.0-rating-leaderboard.md
- * 테스트: server/tests/e2e/rating_leaderboard_test.cpp
+ * 테스트: server/tests/unit/result_service_test.cpp, server/tests/e2e/rating_leaderboard_test.cpp
  */
 #include "server/result_service.hpp"
 
-#include "server/session_manager.hpp"
+#include <unordered_set>
 
 namespace server {
 
 ResultService::ResultService(std::shared_ptr<ResultRepository> repository, std::shared_ptr<RatingService> rating_service)
     : repository_(std::move(repository)), rating_service_(std::move(rating_service)) {}
 
+ResultService::~ResultService() {
+  Stop();
+  Drain();
+}
+
+void ResultService::Start() {
+  if (running_.exchange(true)) {
+    return;
+  }
+  finalizer_ = std::thread([this]() { RunFinalizer(); });
+}
+
+void ResultService::Stop() {
+  if (!running_.exchange(false)) {
+    return;
+  }
+  wake_.Notify();
+  if (finalizer_.joinable()) {
+    finalizer_.join();
+  }
+}
+
+void ResultService::Submit(MatchResultRecord record, std::vector<SessionParticipant> participants) {
+  auto* node = new Node{PendingResult{std::move(record), std::move(participants), std::chrono::steady_clock::now()}};
+  pending_.fetch_add(1, std::memory_order_relaxed);
+  Node* head = head_.load(std::memory_order_relaxed);
+  do {
+    node->next = head;
+  } while (!head_.compare_exchange_weak(head, node));
+
+  // push와 running_ 확인은 seq_cst로 두어, Stop 이후의 마지막 Drain이 이 항목을 못 보면 여기서 직접 반영하게 한다.
+  if (!running_.load()) {
+    Drain();
+    return;
+  }
+  // 빈 스택에 처음 넣은 생산자만 깨운다. 뒤이은 생산자의 항목은 그 신호로 깬 finalizer가 함께 꺼낸다.
+  if (head == nullptr) {
+    wake_.Notify();
+  }
+}
+
 bool ResultService::FinalizeResult(const MatchResultRecord& record, const std::vector<SessionParticipant>& participants) {
-  if (!repository_->SaveIfAbsent(record)) {
-    return false;
+  std::vector<PendingResult> batch;
+  batch.push_back(PendingResult{record, participants, std::chrono::steady_clock::now()});
+  return ApplyBatch(batch) == 1;
+}
+
+void ResultService::RunFinalizer() {
+  while (running_.load(std::memory_order_acquire)) {
+    if (Drain() > 0) {
+      continue;
+    }
+    wake_.Wait();
   }
+  // 정지 직전에 들어온 결과도 버리지 않는다.
+  Drain();
+}
 
-  for (const auto& participant : participants) {
-    rating_service_->EnsureUser(participant.user_id, participant.username);
+std::size_t ResultService::Drain() {
+  Node* node = head_.exchange(nullptr);
+  if (node == nullptr) {
+    return 0;
+  }
+  // 스택은 최신 항목이 앞이므로 뒤집어 제출 순서대로 반영한다.
+  Node* ordered = nullptr;
+  while (node != nullptr) {
+    Node* next = node->next;
+    node->next = ordered;
+    ordered = node;
+    node = next;
   }
-  rating_service_->EnsureUser(record.user1_id, "");
-  rating_service_->EnsureUser(record.user2_id, "");
 
-  int loser_id = record.winner_user_id == record.user1_id ? record.user2_id : record.user1_id;
-  rating_service_->ApplyMatchResult(record.winner_user_id, loser_id);
-  return true;
+  std::size_t drained = 0;
+  std::vector<PendingResult> batch;
+  batch.reserve(kMaxBatchSize);
+  while (ordered != nullptr) {
+    while (ordered != nullptr && batch.size() < kMaxBatchSize) {
+      Node* next = ordered->next;
+      batch.push_back(std::move(ordered->item));
+      delete ordered;
+      ordered = next;
+    }
+    ApplyBatch(batch);
+    drained += batch.size();
+    pending_.fetch_sub(batch.size(), std::memory_order_relaxed);
+    batch.clear();
+  }
+  return drained;
+}
+
+std::size_t ResultService::ApplyBatch(std::vector<PendingResult>& batch) {
+  std::lock_guard<std::mutex> lock(apply_mutex_);
+  std::vector<std::string> session_ids;
+  session_ids.reserve(batch.size());
+  for (const auto& pending : batch) {
+    session_ids.push_back(pending.record.session_id);
+  }
+  // 저장소 잠금 한 번으로 이미 반영된 결과를 거르고, 같은 배치 안의 중복도 첫 항목만 남긴다.
+  const auto exists = repository_->ExistsAll(session_ids);
+  std::unordered_set<std::string> seen;
+  std::vector<RankedMatchResult> ratings;
+  std::vector<MatchResultRecord> records;
+  std::vector<std::size_t> applied_index;
+  ratings.reserve(batch.size());
+  records.reserve(batch.size());
+  applied_index.reserve(batch.size());
+  for (std::size_t i = 0; i < batch.size(); ++i) {
+    auto& pending = batch[i];
+    if (exists[i] || !seen.insert(session_ids[i]).second) {
+      if (observability_) {
+        observability_->Tracer().CloseSession(session_ids[i]);
+      }
+      continue;
+    }
+    RankedMatchResult rating{{}, pending.record.ranked_user_ids};
+    rating.users.reserve(pending.participants.size());
+    for (auto& participant : pending.participants) {
+      rating.users.emplace_back(participant.user_id, std::move(participant.username));
+    }
+    ratings.push_back(std::move(rating));
+    records.push_back(std::move(pending.record));
+    applied_index.push_back(i);
+  }
+
+  // 레이팅을 저장보다 먼저 반영해, 결과가 조회되면 레이팅도 이미 반영된 상태가 되게 한다.
+  rating_service_->ApplyRankedResults(ratings);
+  repository_->SaveAllIfAbsent(std::move(records));
+
+  const std::size_t applied = applied_index.size();
+  if (observability_) {
+    const auto now = std::chrono::steady_clock::now();
+    for (std::size_t i : applied_index) {
+      observability_->Tracer().Mark(session_ids[i], MatchEvent::kRatingApplied);
+      observability_->RecordResultLag(std::chrono::duration_cast<std::chrono::microseconds>(now - batch[i].submitted_at));
+    }
+    observability_->RecordResultBatch(applied, batch.size() - applied);
+  }
+  return applied;
 }
 
 }  // namespace server
@@ -6,25 +6,30 @@
  */
 #include "server/session_manager.hpp"
 
+#include <algorithm>
+#include <array>
+#include <charconv>
 #include <chrono>
 #include <ctime>
 #include <future>
 #include <iomanip>
 #include <limits>
 #include <sstream>
+#include <string_view>
 
 #include <boost/asio/bind_executor.hpp>
+#include <boost/asio/post.hpp>
+
+#include "server/api_response.hpp"
+#include "server/websocket_session.hpp"
 
 namespace server {
+
+// 세션 저널은 재생(세션 이전/검증) 시 헤더 플레이어 수를 InputJournal::kMaxPlayers로 제한한다.
+static_assert(SessionManager::kMaxSessionPlayers == InputJournal::kMaxPlayers);
+
 namespace {
-nlohmann::json BuildStatePayload(const Simulation& simulation) {
-  nlohmann::json players_json = nlohmann::json::array();
-  auto snapshot = simulation.Snapshot();
-  for (const auto& player : snapshot["players"]) {
-    players_json.push_back(player);
-  }
-  return {{"tick", snapshot["tick"]}, {"players", players_json}};
-}
+nlohmann::json BuildStatePayload(const Simulation& simulation) { return SnapshotToJson(simulation.View()); }
 
 std::string ToIsoString(std::chrono::system_clock::time_point tp) {
   auto tt = std::chrono::system_clock::to_time_t(tp);
@@ -33,67 +38,304 @@ std::string ToIsoString(std::chrono::system_clock::time_point tp) {
   oss << std::put_time(&tm, "%FT%TZ");
   return oss.str();
 }
+
+// uint64 해시는 JSON 숫자로 보내면 JS 등에서 정밀도가 손실되므로 16자리 소문자 hex 문자열로 보낸다.
+std::string FormatStateHash(std::uint64_t hash) {
+  std::ostringstream oss;
+  oss << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return oss.str();
+}
 }  // namespace
 
 SessionManager::SessionManager(boost::asio::io_context& ioc, std::shared_ptr<RealtimeCoordinator> coordinator,
                                std::shared_ptr<ResultService> result_service, std::chrono::milliseconds tick_interval,
                                std::size_t max_ticks)
     : ioc_(ioc), coordinator_(std::move(coordinator)), result_service_(std::move(result_service)),
-      tick_interval_(tick_interval), max_ticks_(max_ticks) {}
+      tick_interval_(tick_interval), max_ticks_(max_ticks) {
+  governor_config_.base_interval = tick_interval;
+  governor_config_.max_interval = tick_interval;
+  for (auto& shard : shards_) {
+    shard.spare_session_nodes.reserve(kPoolCapacityPerShard);
+    shard.spare_user_nodes.reserve(kPoolCapacityPerShard * 2);
+    shard.idle_contexts.reserve(kPoolCapacityPerShard);
+  }
+  lanes_.reserve(kTickLanes);
+  for (std::size_t i = 0; i < kTickLanes; ++i) {
+    lanes_.push_back(std::make_unique<TickLane>(ioc_));
+  }
+}
+
+std::string FormatSessionId(SessionId id) {
+  std::string out;
+  FormatSessionId(id, out);
+  return out;
+}
+
+void FormatSessionId(SessionId id, std::string& out) {
+  constexpr std::string_view kPrefix = "session-";
+  std::array<char, 20> digits{};
+  auto result = std::to_chars(digits.data(), digits.data() + digits.size(), id);
+  out.assign(kPrefix.data(), kPrefix.size());
+  out.append(digits.data(), result.ptr);
+}
+
+SessionId ParseSessionId(std::string_view wire_id) {
+  constexpr std::string_view kPrefix = "session-";
+  if (wire_id.size() <= kPrefix.size() || wire_id.substr(0, kPrefix.size()) != kPrefix) {
+    return kInvalidSessionId;
+  }
+  SessionId id = kInvalidSessionId;
+  const auto digits = wire_id.substr(kPrefix.size());
+  auto [end, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), id);
+  if (ec != std::errc() || end != digits.data() + digits.size()) {
+    return kInvalidSessionId;
+  }
+  return id;
+}
+
+void SessionManager::SessionContext::Reset(const TickGovernorConfig& governor_config) {
+  trace_id.clear();
+  trace_sampled = false;
+  participants.clear();
+  participant_ids.clear();
+  simulation.Reset();
+  tick_sent = 0;
+  ended = false;
+  migration = MigrationState::kNone;
+  awaiting_resume.clear();
+  migration_id.clear();
+  migration_target.clear();
+  governor = TickGovernor(governor_config);
+  tick_interval = governor_config.base_interval;
+  std::fill(hash_history.begin(), hash_history.end(), TickHash{});
+  correction.from_tick = 0;
+  correction.players.clear();
+  pass_stepped = false;
+  interest_scratch.clear();
+  spectators.clear();
+  spectator_frames.clear();
+}
 
-std::string SessionManager::CreateSession(const std::vector<SessionParticipant>& participants) {
-  auto ctx = std::make_shared<SessionContext>(ioc_, tick_interval_);
+std::shared_ptr<SessionManager::SessionContext> SessionManager::AcquireContext(SessionId id) {
+  std::shared_ptr<SessionContext> ctx;
+  // 자기 샤드부터 살펴 경합을 줄이되, 비어 있으면 다른 샤드의 유휴 컨텍스트도 가져온다. 잠금은 하나씩만 잡는다.
+  for (std::size_t offset = 0; offset < kShardCount && !ctx; ++offset) {
+    auto& shard = shards_[(id + offset) % kShardCount];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto& idle = shard.idle_contexts;
+    // 풀만 참조하는 컨텍스트는 다른 스레드가 새 참조를 얻을 수 없으므로 안전하게 꺼낼 수 있다.
+    auto it = std::find_if(idle.begin(), idle.end(), [](const auto& candidate) { return candidate.use_count() == 1; });
+    if (it != idle.end()) {
+      ctx = std::move(*it);
+      *it = std::move(idle.back());
+      idle.pop_back();
+      pooled_contexts_.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+  if (observability_) {
+    observability_->RecordSessionPool(ctx != nullptr);
+  }
+  if (!ctx) {
+    return std::make_shared<SessionContext>(ioc_, LaneFor(id).strand, governor_config_);
+  }
+  // 풀의 컨텍스트는 다른 레인에서 왔을 수 있으므로 새 id의 레인 strand로 바꾼다.
+  ctx->strand = LaneFor(id).strand;
+  ctx->Reset(governor_config_);
+  return ctx;
+}
+
+void SessionManager::ReleaseContext(const std::shared_ptr<SessionContext>& ctx) {
   {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::ostringstream oss;
-    oss << "session-" << next_session_id_++;
-    ctx->id = oss.str();
-    ctx->participants = participants;
-    for (const auto& p : participants) {
-      ctx->participant_map[p.user_id] = p;
-      user_to_session_[p.user_id] = ctx->id;
-      ctx->simulation.AddPlayer(p.user_id);
+    auto& shard = SessionShardFor(ctx->id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.idle_contexts.size() >= kPoolCapacityPerShard) {
+      return;
     }
-    sessions_[ctx->id] = ctx;
+    shard.idle_contexts.push_back(ctx);
+  }
+  const auto pooled = pooled_contexts_.fetch_add(1, std::memory_order_relaxed) + 1;
+  auto high = pool_high_water_.load(std::memory_order_relaxed);
+  while (pooled > high && !pool_high_water_.compare_exchange_weak(high, pooled, std::memory_order_relaxed)) {
+  }
+}
+
+SessionId SessionManager::CreateSession(const std::vector<SessionParticipant>& participants) {
+  if (participants.empty() || participants.size() > kMaxSessionPlayers) {
+    return kInvalidSessionId;
+  }
+  const SessionId id = next_session_id_.fetch_add(1, std::memory_order_relaxed);
+  auto ctx = AcquireContext(id);
+  ctx->id = id;
+  FormatSessionId(id, ctx->wire_id);
+  ctx->participants = participants;
+  for (const auto& p : participants) {
+    ctx->participant_ids.push_back(p.user_id);
+  }
+  std::sort(ctx->participant_ids.begin(), ctx->participant_ids.end());
+  ctx->simulation.EnableRollback(rollback_window_ticks_);
+  for (int user_id : ctx->participant_ids) {
+    ctx->simulation.AddPlayer(user_id);
+  }
+  ctx->journal.Begin(ctx->participant_ids, ctx->simulation.RollbackWindow());
+  if (!RegisterSession(ctx)) {
+    ReleaseContext(ctx);
+    return kInvalidSessionId;
+  }
+  ctx->opened_at = std::chrono::steady_clock::now();
+  if (observability_) {
+    ctx->trace_id = observability_->NextTraceId();
+    ctx->trace_sampled = observability_->Tracer().OpenSession(ctx->wire_id, ctx->trace_id, ctx->participant_ids);
   }
 
   boost::asio::dispatch(ctx->strand, [self = shared_from_this(), ctx]() { self->StartSession(ctx); });
   return ctx->id;
 }
 
+bool SessionManager::RegisterSession(const std::shared_ptr<SessionContext>& ctx) {
+  const SessionId id = ctx->id;
+  // 사용자 매핑을 먼저 건다. 이미 다른 세션에 매핑된 참가자가 있으면 덮어쓰지 않고 건 매핑을 되돌린다.
+  // 각 샤드 잠금은 하나씩만 잡으므로 잠금 순서 문제가 없다.
+  std::size_t mapped = 0;
+  for (; mapped < ctx->participants.size(); ++mapped) {
+    const int user_id = ctx->participants[mapped].user_id;
+    auto& shard = UserShardFor(user_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.user_to_session.count(user_id) > 0) {
+      break;
+    }
+    if (!shard.spare_user_nodes.empty()) {
+      auto node = std::move(shard.spare_user_nodes.back());
+      shard.spare_user_nodes.pop_back();
+      node.key() = user_id;
+      node.mapped() = id;
+      shard.user_to_session.insert(std::move(node));
+    } else {
+      shard.user_to_session.emplace(user_id, id);
+    }
+  }
+  if (mapped < ctx->participants.size()) {
+    UnmapUsers(ctx, mapped);
+    return false;
+  }
+  {
+    auto& shard = SessionShardFor(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (!shard.spare_session_nodes.empty()) {
+      auto node = std::move(shard.spare_session_nodes.back());
+      shard.spare_session_nodes.pop_back();
+      node.key() = id;
+      node.mapped() = ctx;
+      shard.sessions.insert(std::move(node));
+    } else {
+      shard.sessions.emplace(id, ctx);
+    }
+  }
+  active_sessions_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void SessionManager::UnmapUsers(const std::shared_ptr<SessionContext>& ctx, std::size_t count) {
+  for (std::size_t i = 0; i < count; ++i) {
+    const int user_id = ctx->participants[i].user_id;
+    auto& shard = UserShardFor(user_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    // 같은 사용자가 이미 다른 세션에 매핑됐다면 그 매핑은 지우지 않는다.
+    auto it = shard.user_to_session.find(user_id);
+    if (it != shard.user_to_session.end() && it->second == ctx->id) {
+      auto node = shard.user_to_session.extract(it);
+      if (shard.spare_user_nodes.size() < shard.spare_user_nodes.capacity()) {
+        shard.spare_user_nodes.push_back(std::move(node));
+      }
+    }
+  }
+}
+
+void SessionManager::UnregisterSession(const std::shared_ptr<SessionContext>& ctx) {
+  UnmapUsers(ctx, ctx->participants.size());
+  {
+    auto& shard = SessionShardFor(ctx->id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto node = shard.sessions.extract(ctx->id);
+    if (!node.empty() && shard.spare_session_nodes.size() < shard.spare_session_nodes.capacity()) {
+      node.mapped().reset();
+      shard.spare_session_nodes.push_back(std::move(node));
+    }
+  }
+  active_sessions_.fetch_sub(1, std::memory_order_relaxed);
+  ReleaseContext(ctx);
+}
+
+std::shared_ptr<SessionManager::SessionContext> SessionManager::FindSession(const std::string& session_id,
+                                                                            std::string& error_code,
+                                                                            std::string& error_message) const {
+  const SessionId id = ParseSessionId(session_id);
+  if (id != kInvalidSessionId) {
+    const auto& shard = SessionShardFor(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.sessions.find(id);
+    if (it != shard.sessions.end()) {
+      return it->second;
+    }
+  }
+  error_code = "session_not_found";
+  error_message = "세션을 찾을 수 없습니다";
+  return nullptr;
+}
+
 bool SessionManager::IsUserInSession(int user_id) const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return user_to_session_.count(user_id) > 0;
+  const auto& shard = UserShardFor(user_id);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  return shard.user_to_session.count(user_id) > 0;
 }
 
-bool SessionManager::SubmitInput(const SessionInput& input, std::string& error_code, std::string& error_message) {
-  std::shared_ptr<SessionContext> ctx;
+std::shared_ptr<SessionManager::SessionContext> SessionManager::FindUserSession(int user_id, std::string& error_code,
+                                                                                std::string& error_message) const {
+  SessionId session_id = kInvalidSessionId;
   {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = user_to_session_.find(input.user_id);
-    if (it == user_to_session_.end()) {
-      error_code = "session_not_found";
-      error_message = "세션을 찾을 수 없습니다";
-      return false;
+    const auto& shard = UserShardFor(user_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.user_to_session.find(user_id);
+    if (it != shard.user_to_session.end()) {
+      session_id = it->second;
     }
-    auto ctx_it = sessions_.find(it->second);
-    if (ctx_it == sessions_.end()) {
-      error_code = "session_not_found";
-      error_message = "세션을 찾을 수 없습니다";
-      return false;
+  }
+  if (session_id != kInvalidSessionId) {
+    const auto& shard = SessionShardFor(session_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.sessions.find(session_id);
+    if (it != shard.sessions.end()) {
+      return it->second;
     }
-    ctx = ctx_it->second;
+  }
+  error_code = "session_not_found";
+  error_message = "세션을 찾을 수 없습니다";
+  return nullptr;
+}
+
+bool SessionManager::SubmitInput(const SessionInput& input, std::string& error_code, std::string& error_message) {
+  auto ctx = FindUserSession(input.user_id, error_code, error_message);
+  if (!ctx) {
+    return false;
   }
 
   std::promise<bool> done;
-  boost::asio::dispatch(ctx->strand, [ctx, input, &error_code, &error_message, &done]() {
+  auto observability = observability_;
+  boost::asio::dispatch(ctx->strand, [ctx, input, observability, &error_code, &error_message, &done]() {
     if (ctx->ended) {
       error_code = "session_closed";
       error_message = "세션이 이미 종료되었습니다";
       done.set_value(false);
       return;
     }
-    if (ctx->participant_map.count(input.user_id) == 0) {
+    // 이전 단위를 만든 뒤의 입력은 대상 서버로 넘어가지 않으므로 받지 않는다.
+    if (ctx->migration == SessionContext::MigrationState::kExporting ||
+        ctx->migration == SessionContext::MigrationState::kInDoubt) {
+      error_code = "session_migrating";
+      error_message = "세션이 다른 서버로 이전 중입니다";
+      done.set_value(false);
+      return;
+    }
+    if (!ctx->IsParticipant(input.user_id)) {
       error_code = "not_participant";
       error_message = "세션 참가자가 아닙니다";
       done.set_value(false);
@@ -111,6 +353,50 @@ bool SessionManager::SubmitInput(const SessionInput& input, std::string& error_c
       done.set_value(false);
       return;
     }
+    ctx->journal.Append(ctx->simulation.CurrentTick(), command);
+    if (observability && ctx->trace_sampled) {
+      observability->Tracer().Mark(ctx->wire_id, MatchEvent::kInput, input.user_id);
+    }
+    done.set_value(true);
+  });
+
+  return done.get_future().get();
+}
+
+bool SessionManager::ReportDesync(const StateHashReport& report, std::string& error_code,
+                                  std::string& error_message) {
+  auto ctx = FindUserSession(report.user_id, error_code, error_message);
+  if (!ctx) {
+    return false;
+  }
+
+  std::promise<bool> done;
+  boost::asio::dispatch(ctx->strand, [this, ctx, report, &error_code, &error_message, &done]() {
+    if (ctx->ended) {
+      error_code = "session_closed";
+      error_message = "세션이 이미 종료되었습니다";
+      done.set_value(false);
+      return;
+    }
+    if (!ctx->IsParticipant(report.user_id)) {
+      error_code = "not_participant";
+      error_message = "세션 참가자가 아닙니다";
+      done.set_value(false);
+      return;
+    }
+    // 보관 범위를 벗어났거나 롤백으로 바뀐 틱은 비교할 수 없으므로 전체 상태만 다시 보낸다.
+    const auto& known = ctx->hash_history[static_cast<std::size_t>(report.tick) % kHashHistoryTicks];
+    const bool confirmed = report.tick > 0 && known.tick == report.tick && known.hash != report.state_hash;
+    const auto view = ctx->simulation.View();
+    coordinator_->SendFrameToUser(report.user_id,
+                                  std::make_shared<const std::string>(
+                                      ToWsJson(WsEnvelope{"event", "session.state", 0,
+                                                          StatePayload(ctx, view, HashSnapshot(view))})
+                                          .dump()));
+    if (observability_) {
+      observability_->RecordDesyncReport(confirmed);
+      observability_->RecordStateFrame(true);
+    }
     done.set_value(true);
   });
 
@@ -118,98 +404,956 @@ bool SessionManager::SubmitInput(const SessionInput& input, std::string& error_c
 }
 
 void SessionManager::StartSession(const std::shared_ptr<SessionContext>& ctx) {
-  nlohmann::json created_payload{{"sessionId", ctx->id}, {"createdAt", ToIsoString(std::chrono::system_clock::now())}};
+  nlohmann::json created_payload{{"sessionId", ctx->wire_id}, {"createdAt", ToIsoString(std::chrono::system_clock::now())}};
   nlohmann::json participants_json = nlohmann::json::array();
   for (const auto& p : ctx->participants) {
     participants_json.push_back({{"userId", p.user_id}, {"username", p.username}});
   }
   created_payload["participants"] = participants_json;
-  BroadcastToParticipants(ctx, "session.created", created_payload);
+  BroadcastToParticipants(ctx, "session.created", std::move(created_payload));
+  TraceSessionEvent(ctx, MatchEvent::kCreated);
 
-  nlohmann::json started_payload{{"sessionId", ctx->id}, {"tick", 0}, {"tickIntervalMs", tick_interval_.count()},
+  nlohmann::json started_payload{{"sessionId", ctx->wire_id}, {"tick", 0}, {"tickIntervalMs", tick_interval_.count()},
                                  {"state", BuildStatePayload(ctx->simulation)}};
-  BroadcastToParticipants(ctx, "session.started", started_payload);
+  BroadcastToParticipants(ctx, "session.started", std::move(started_payload));
+  TraceSessionEvent(ctx, MatchEvent::kStarted);
   ScheduleTick(ctx);
 }
 
-void SessionManager::BroadcastToParticipants(const std::shared_ptr<SessionContext>& ctx, const std::string& event,
-                                             const nlohmann::json& payload) {
+SharedFrame SessionManager::BroadcastToParticipants(const std::shared_ptr<SessionContext>& ctx,
+                                                    const std::string& event, nlohmann::json payload) {
+  // 서버 이벤트 프레임은 수신자와 무관하므로 한 번만 직렬화해 모든 참가자가 같은 버퍼를 공유한다.
+  auto frame = std::make_shared<const std::string>(ToWsJson(WsEnvelope{"event", event, 0, std::move(payload)}).dump());
   for (const auto& p : ctx->participants) {
-    coordinator_->SendEventToUser(p.user_id, event, payload);
+    coordinator_->SendFrameToUser(p.user_id, frame);
   }
+  return frame;
 }
 
 void SessionManager::ScheduleTick(const std::shared_ptr<SessionContext>& ctx) {
-  ctx->timer.expires_after(ctx->tick_interval);
-  auto self = shared_from_this();
-  ctx->timer.async_wait(boost::asio::bind_executor(
-      ctx->strand, [self, ctx](const boost::system::error_code& ec) {
+  auto& lane = LaneFor(ctx->id);
+  // now + 간격을 격자로 내림하므로 다음 틱은 항상 now 이후 한 간격 안이다.
+  const auto now = std::chrono::steady_clock::now();
+  const auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(ctx->tick_interval);
+  ctx->tick_deadline =
+      interval.count() > 0
+          ? std::chrono::steady_clock::time_point(interval * ((now + interval).time_since_epoch() / interval))
+          : now;
+  if (ctx->lane_slot == kNotScheduled) {
+    ctx->lane_slot = lane.sessions.size();
+    lane.sessions.push_back(ctx);
+  }
+  if (!lane.stepping && ctx->tick_deadline < lane.armed_at) {
+    ArmLane(ctx->id % kTickLanes, ctx->tick_deadline);
+  }
+}
+
+void SessionManager::UnscheduleTick(const std::shared_ptr<SessionContext>& ctx) {
+  const auto slot = ctx->lane_slot;
+  if (slot == kNotScheduled) {
+    return;
+  }
+  ctx->lane_slot = kNotScheduled;
+  // 남은 세션의 다음 틱은 그대로이므로 타이머는 두고, 빈 레인이면 다음 만기에 할 일 없이 끝난다.
+  auto& sessions = LaneFor(ctx->id).sessions;
+  if (slot + 1 != sessions.size()) {
+    sessions[slot] = std::move(sessions.back());
+    sessions[slot]->lane_slot = slot;
+  }
+  sessions.pop_back();
+}
+
+void SessionManager::ArmLane(std::size_t lane_index, std::chrono::steady_clock::time_point at) {
+  auto& lane = *lanes_[lane_index];
+  lane.armed_at = at;
+  // 기다리던 대기는 operation_aborted로 끝나고 새 시각으로 다시 기다린다.
+  lane.timer.expires_at(at);
+  lane.timer.async_wait(boost::asio::bind_executor(
+      lane.strand, [self = shared_from_this(), lane_index](const boost::system::error_code& ec) {
         if (!ec) {
-          self->HandleTick(ctx);
+          self->RunTickLane(lane_index);
         }
       }));
 }
 
-void SessionManager::HandleTick(const std::shared_ptr<SessionContext>& ctx) {
-  if (ctx->ended) {
+void SessionManager::RunTickLane(std::size_t lane_index) {
+  auto& lane = *lanes_[lane_index];
+  lane.armed_at = std::chrono::steady_clock::time_point::max();
+  const auto now = std::chrono::steady_clock::now();
+  lane.due.clear();
+  for (const auto& ctx : lane.sessions) {
+    if (ctx->tick_deadline <= now) {
+      // 지연은 패스 시작 시각으로 잰다. 전파 단계에서 재면 앞 세션의 직렬화/전송 시간이 뒤 세션 지연에 더해져
+      // 간격 조절과 입장 제한이 바쁜 레인의 뒤쪽 세션만 과하게 늦춘다.
+      ctx->tick_lateness = std::chrono::duration_cast<std::chrono::microseconds>(now - ctx->tick_deadline);
+      lane.due.push_back(ctx);
+    }
+  }
+  lane.stepping = true;
+  lane.publishing = false;
+  lane.cursor = 0;
+  lane.pass_started = now;
+  lane.step_busy = std::chrono::steady_clock::duration::zero();
+  RunLaneSlice(lane_index);
+}
+
+void SessionManager::RunLaneSlice(std::size_t lane_index) {
+  auto& lane = *lanes_[lane_index];
+  const auto started = std::chrono::steady_clock::now();
+  const auto slice_end = std::min(lane.due.size(), lane.cursor + kLaneSliceSessions);
+  // 조각 사이에 같은 strand의 다른 핸들러(종료, 이전 정지/재개)가 돌 수 있으므로 세션마다 아직 진행할 상태인지 본다.
+  if (!lane.publishing) {
+    // 만기된 세션을 먼저 모두 진행한다. 직렬화/전송과 섞지 않아 시뮬레이션 상태만 연속으로 다룬다.
+    for (; lane.cursor < slice_end; ++lane.cursor) {
+      const auto& ctx = lane.due[lane.cursor];
+      if (!ctx->ended && ctx->migration == SessionContext::MigrationState::kNone &&
+          ctx->lane_slot != kNotScheduled && ctx->tick_deadline <= lane.pass_started) {
+        StepSession(ctx);
+        ctx->pass_stepped = true;
+      }
+    }
+    lane.step_busy += std::chrono::steady_clock::now() - started;
+    if (lane.cursor == lane.due.size()) {
+      lane.publishing = true;
+      lane.cursor = 0;
+    }
+  } else {
+    for (; lane.cursor < slice_end; ++lane.cursor) {
+      const auto& ctx = lane.due[lane.cursor];
+      const bool stepped = ctx->pass_stepped;
+      ctx->pass_stepped = false;
+      if (stepped && !ctx->ended && ctx->migration == SessionContext::MigrationState::kNone) {
+        PublishTick(ctx);
+      }
+    }
+  }
+
+  if (!lane.publishing || lane.cursor < lane.due.size()) {
+    boost::asio::post(lane.strand, [self = shared_from_this(), lane_index]() { self->RunLaneSlice(lane_index); });
     return;
   }
+
+  if (!lane.due.empty() && observability_) {
+    observability_->RecordTickPass(
+        lane.due.size(), std::chrono::duration_cast<std::chrono::microseconds>(lane.step_busy),
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - lane.pass_started));
+  }
+  // 종료된 세션의 컨텍스트가 풀에서 재사용될 수 있도록 참조를 바로 놓는다.
+  lane.due.clear();
+  lane.stepping = false;
+
+  auto next = std::chrono::steady_clock::time_point::max();
+  for (const auto& ctx : lane.sessions) {
+    next = std::min(next, ctx->tick_deadline);
+  }
+  if (next != std::chrono::steady_clock::time_point::max()) {
+    ArmLane(lane_index, next);
+  }
+}
+
+void SessionManager::StepSession(const std::shared_ptr<SessionContext>& ctx) {
+  ApplyCorrection(ctx);
   ctx->simulation.TickOnce();
   ctx->tick_sent++;
-  auto snapshot = ctx->simulation.Snapshot();
-  nlohmann::json state_payload{{"sessionId", ctx->id},
-                               {"tick", snapshot["tick"]},
-                               {"players", snapshot["players"]},
-                               {"issuedAt", ToIsoString(std::chrono::system_clock::now())}};
-  BroadcastToParticipants(ctx, "session.state", state_payload);
+}
+
+void SessionManager::PublishTick(const std::shared_ptr<SessionContext>& ctx) {
+  if (ctx->tick_sent == 1 && observability_) {
+    observability_->Tracer().Mark(ctx->wire_id, MatchEvent::kFirstTick);
+  }
+  if (ctx->correction.from_tick != 0) {
+    PublishCorrection(ctx);
+  }
+  const auto view = ctx->simulation.View();
+  const auto state_hash = HashSnapshot(view);
+  ctx->hash_history[static_cast<std::size_t>(view.Tick()) % kHashHistoryTicks] = TickHash{view.Tick(), state_hash};
+  const bool full = IsFullStateTick(ctx, view.Tick());
+  SharedFrame state_frame;
+  if (full) {
+    state_frame = FanOutState(ctx, view, state_hash);
+  } else {
+    // 정상 상태에서는 해시만 보내고 클라이언트가 자체 시뮬레이션 결과와 비교한다.
+    BroadcastToParticipants(ctx, "session.hash",
+                            nlohmann::json{{"sessionId", ctx->wire_id},
+                                           {"tick", view.Tick()},
+                                           {"stateHash", FormatStateHash(state_hash)}});
+  }
+  if (observability_) {
+    observability_->RecordStateFrame(full);
+  }
+  if (!ctx->spectators.empty()) {
+    FanOutSpectators(ctx, view, state_hash, std::move(state_frame));
+  }
 
   if (ctx->tick_sent >= max_ticks_) {
     FinishSession(ctx);
     return;
   }
+  if (admission_) {
+    admission_->RecordTickLateness(ctx->tick_lateness);
+  }
+  GovernTickRate(ctx, ctx->tick_lateness);
   ScheduleTick(ctx);
 }
 
+SharedFrame SessionManager::FanOutState(const std::shared_ptr<SessionContext>& ctx, const SnapshotView& view,
+                                        std::uint64_t state_hash) {
+  const auto started = std::chrono::steady_clock::now();
+  std::size_t player_entries = 0;
+  SharedFrame shared;
+  if (interest_filter_->Broadcast()) {
+    auto payload = StatePayload(ctx, view, state_hash);
+    player_entries = payload["players"].size() * ctx->participants.size();
+    shared = BroadcastToParticipants(ctx, "session.state", std::move(payload));
+  } else {
+    // 수신자마다 목록이 달라 프레임을 따로 직렬화한다. 공통 필드는 한 번만 만든다.
+    nlohmann::json base{{"sessionId", ctx->wire_id},
+                        {"tick", view.Tick()},
+                        {"tickIntervalMs", ctx->tick_interval.count()},
+                        {"stateHash", FormatStateHash(state_hash)},
+                        {"issuedAt", ToIsoString(std::chrono::system_clock::now())}};
+    auto& selected = ctx->interest_scratch;
+    for (const auto& p : ctx->participants) {
+      SelectInterestedPlayers(view, p.user_id, *interest_filter_, selected);
+      nlohmann::json players = nlohmann::json::array();
+      for (const auto& player : selected) {
+        players.push_back(PlayerToJson(player));
+      }
+      player_entries += selected.size();
+      auto payload = base;
+      payload["players"] = std::move(players);
+      coordinator_->SendFrameToUser(p.user_id, std::make_shared<const std::string>(
+                                                   ToWsJson(WsEnvelope{"event", "session.state", 0, std::move(payload)})
+                                                       .dump()));
+    }
+  }
+  if (observability_) {
+    observability_->RecordFanout(
+        ctx->participants.size(), player_entries,
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started));
+  }
+  return shared;
+}
+
+void SessionManager::FanOutSpectators(const std::shared_ptr<SessionContext>& ctx, const SnapshotView& view,
+                                      std::uint64_t state_hash, SharedFrame participant_frame) {
+  const auto started = std::chrono::steady_clock::now();
+  // 관전자는 자체 시뮬레이션이 없으므로 해시 전용 틱에도 전체 상태를 받고, 관심 필터 없이 모든 플레이어를 본다.
+  if (!participant_frame) {
+    participant_frame = std::make_shared<const std::string>(
+        ToWsJson(WsEnvelope{"event", "session.state", 0, StatePayload(ctx, view, state_hash)}).dump());
+  }
+  const int tick = view.Tick();
+  int longest_delay = 0;
+  for (const auto& spectator : ctx->spectators) {
+    longest_delay = std::max(longest_delay, spectator.options.delay_ticks);
+  }
+  if (longest_delay > 0) {
+    ctx->spectator_frames.push_back(SpectatorFrame{tick, participant_frame});
+    while (ctx->spectator_frames.size() > static_cast<std::size_t>(longest_delay) + 1) {
+      ctx->spectator_frames.pop_front();
+    }
+  } else {
+    ctx->spectator_frames.clear();
+  }
+
+  std::size_t sent = 0;
+  std::size_t dropped = 0;
+  std::size_t left = 0;
+  for (std::size_t i = 0; i < ctx->spectators.size();) {
+    auto& spectator = ctx->spectators[i];
+    auto session = spectator.session.lock();
+    if (!session) {
+      // 연결이 끊긴 관전자는 여기서 정리한다. 순서는 의미가 없으므로 마지막 원소와 바꿔 지운다.
+      spectator = std::move(ctx->spectators.back());
+      ctx->spectators.pop_back();
+      ++left;
+      continue;
+    }
+    ++i;
+    const int frame_tick = tick - spectator.options.delay_ticks;
+    if (frame_tick <= 0 || frame_tick % spectator.options.interval_ticks != 0) {
+      continue;
+    }
+    const SharedFrame* frame = &participant_frame;
+    if (spectator.options.delay_ticks > 0) {
+      // 보관 프레임은 틱 순서로 연속이므로 뒤에서부터 지연 틱만큼 떨어진 위치에 있다.
+      const auto back = static_cast<std::size_t>(spectator.options.delay_ticks);
+      if (ctx->spectator_frames.size() <= back ||
+          ctx->spectator_frames[ctx->spectator_frames.size() - 1 - back].tick != frame_tick) {
+        continue;
+      }
+      frame = &ctx->spectator_frames[ctx->spectator_frames.size() - 1 - back].frame;
+    }
+    if (!session->SendSpectatorFrame(*frame)) {
+      ++dropped;
+    }
+    ++sent;
+  }
+  if (observability_) {
+    observability_->SpectatorsLeft(left);
+    observability_->RecordSpectatorFanout(
+        sent, dropped,
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started));
+  }
+}
+
+void SessionManager::DropSpectators(const std::shared_ptr<SessionContext>& ctx, const SharedFrame& frame) {
+  if (ctx->spectators.empty()) {
+    return;
+  }
+  for (const auto& spectator : ctx->spectators) {
+    if (auto session = spectator.session.lock()) {
+      session->SendServerFrame(frame);
+    }
+  }
+  if (observability_) {
+    observability_->SpectatorsLeft(ctx->spectators.size());
+  }
+  ctx->spectators.clear();
+  ctx->spectator_frames.clear();
+}
+
+bool SessionManager::Spectate(const std::string& session_id, int user_id,
+                              const std::shared_ptr<WebSocketSession>& viewer, const SpectateOptions& options,
+                              std::string& error_code, std::string& error_message) {
+  if (options.interval_ticks < 1 || options.delay_ticks < 0 || options.delay_ticks > max_spectator_delay_ticks_) {
+    error_code = "bad_request";
+    error_message = "intervalTicks는 1 이상, delayTicks는 0~" + std::to_string(max_spectator_delay_ticks_) +
+                    " 범위여야 합니다";
+    return false;
+  }
+  auto ctx = FindSession(session_id, error_code, error_message);
+  if (!ctx) {
+    return false;
+  }
+
+  std::promise<bool> done;
+  boost::asio::dispatch(ctx->strand, [this, ctx, user_id, &viewer, &options, &error_code, &error_message, &done]() {
+    if (ctx->ended) {
+      error_code = "session_closed";
+      error_message = "세션이 이미 종료되었습니다";
+      done.set_value(false);
+      return;
+    }
+    // 참가자는 이미 같은 상태를 받으므로 자기 세션을 관전하지 않는다.
+    if (ctx->IsParticipant(user_id)) {
+      error_code = "already_participant";
+      error_message = "세션 참가자는 관전할 수 없습니다";
+      done.set_value(false);
+      return;
+    }
+    auto existing = std::find_if(ctx->spectators.begin(), ctx->spectators.end(),
+                                 [&viewer](const Spectator& s) { return s.raw == viewer.get(); });
+    if (existing == ctx->spectators.end() && ctx->spectators.size() >= max_spectators_per_session_) {
+      error_code = "spectators_full";
+      error_message = "세션 관전자 수가 한도에 도달했습니다";
+      done.set_value(false);
+      return;
+    }
+    // 첫 관전 프레임보다 먼저 도착하도록 strand 안에서 확인 이벤트를 보낸다.
+    viewer->SendServerEvent("session.spectating", nlohmann::json{{"sessionId", ctx->wire_id},
+                                                                 {"tick", ctx->simulation.CurrentTick()},
+                                                                 {"tickIntervalMs", ctx->tick_interval.count()},
+                                                                 {"intervalTicks", options.interval_ticks},
+                                                                 {"delayTicks", options.delay_ticks}});
+    if (existing != ctx->spectators.end()) {
+      // 같은 연결이 다시 요청하면 옵션만 바꾼다.
+      existing->options = options;
+    } else {
+      ctx->spectators.push_back(Spectator{viewer, viewer.get(), user_id, options});
+      if (observability_) {
+        observability_->SpectatorJoined();
+      }
+    }
+    done.set_value(true);
+  });
+
+  return done.get_future().get();
+}
+
+void SessionManager::Unspectate(const std::string& session_id, const WebSocketSession* viewer) {
+  std::string error_code;
+  std::string error_message;
+  auto ctx = FindSession(session_id, error_code, error_message);
+  if (!ctx) {
+    return;
+  }
+  auto self = shared_from_this();
+  boost::asio::dispatch(ctx->strand, [self, ctx, viewer]() {
+    auto it = std::find_if(ctx->spectators.begin(), ctx->spectators.end(),
+                           [viewer](const Spectator& s) { return s.raw == viewer; });
+    if (it == ctx->spectators.end()) {
+      return;
+    }
+    ctx->spectators.erase(it);
+    if (self->observability_) {
+      self->observability_->SpectatorsLeft(1);
+    }
+  });
+}
+
+bool SessionManager::IsFullStateTick(const std::shared_ptr<SessionContext>& ctx, int tick) const {
+  // 첫 틱은 클라이언트가 비교 기준을 잡을 수 있도록 항상 전체 상태를 보낸다.
+  return full_state_every_ <= 1 || ctx->tick_sent == 1 ||
+         static_cast<std::size_t>(tick) % full_state_every_ == 0;
+}
+
+nlohmann::json SessionManager::StatePayload(const std::shared_ptr<SessionContext>& ctx, const SnapshotView& view,
+                                            std::uint64_t state_hash) const {
+  return nlohmann::json{{"sessionId", ctx->wire_id},
+                        {"tick", view.Tick()},
+                        {"tickIntervalMs", ctx->tick_interval.count()},
+                        {"stateHash", FormatStateHash(state_hash)},
+                        {"players", PlayersToJson(view)},
+                        {"issuedAt", ToIsoString(std::chrono::system_clock::now())}};
+}
+
+void SessionManager::GovernTickRate(const std::shared_ptr<SessionContext>& ctx, std::chrono::microseconds lateness) {
+  if (!ctx->governor.Enabled()) {
+    return;
+  }
+  std::chrono::microseconds loop_lag{0};
+  if (observability_) {
+    loop_lag = std::chrono::microseconds(observability_->Loop().LastLagMicros());
+  }
+  const bool was_degraded = ctx->governor.Degraded();
+  if (!ctx->governor.Observe(lateness, loop_lag)) {
+    return;
+  }
+  // 벽시계 주기만 바뀌며 틱 번호 기반 시뮬레이션 결과는 그대로다. 새 간격은 다음 session.state로 알린다.
+  ctx->tick_interval = ctx->governor.Interval();
+  if (observability_ && was_degraded != ctx->governor.Degraded()) {
+    observability_->SessionDegraded(ctx->governor.Degraded());
+  }
+}
+
+void SessionManager::ApplyCorrection(const std::shared_ptr<SessionContext>& ctx) {
+  const int from_tick = ctx->simulation.PendingCorrectionTick();
+  if (from_tick == 0) {
+    return;
+  }
+  const auto started = std::chrono::steady_clock::now();
+  const int ticks = ctx->simulation.Resimulate();
+  if (observability_) {
+    observability_->RecordResimulation(
+        ticks, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started));
+  }
+  // 이미 전송한 틱 상태가 바뀌었으므로 정정된 현재 틱 상태를 담아 두고, 전파 단계에서 틱 상태보다 먼저 보낸다.
+  const auto view = ctx->simulation.View();
+  const auto state_hash = HashSnapshot(view);
+  // 재계산된 과거 틱 해시는 더 이상 클라이언트가 받은 값과 비교할 수 없으므로 무효화한다.
+  for (auto& entry : ctx->hash_history) {
+    if (entry.tick >= from_tick) {
+      entry = TickHash{};
+    }
+  }
+  ctx->hash_history[static_cast<std::size_t>(view.Tick()) % kHashHistoryTicks] = TickHash{view.Tick(), state_hash};
+  auto& correction = ctx->correction;
+  correction.from_tick = from_tick;
+  correction.tick = view.Tick();
+  correction.resimulated_ticks = ticks;
+  correction.state_hash = state_hash;
+  correction.players.clear();
+  view.ForEachPlayer([&correction](const PlayerView& player) { correction.players.push_back(player); });
+}
+
+void SessionManager::PublishCorrection(const std::shared_ptr<SessionContext>& ctx) {
+  auto& correction = ctx->correction;
+  nlohmann::json players = nlohmann::json::array();
+  for (const auto& player : correction.players) {
+    players.push_back(PlayerToJson(player));
+  }
+  nlohmann::json correction_payload{{"sessionId", ctx->wire_id},
+                                    {"fromTick", correction.from_tick},
+                                    {"tick", correction.tick},
+                                    {"resimulatedTicks", correction.resimulated_ticks},
+                                    {"stateHash", FormatStateHash(correction.state_hash)},
+                                    {"players", std::move(players)}};
+  correction.from_tick = 0;
+  BroadcastToParticipants(ctx, "session.correction", std::move(correction_payload));
+}
+
 void SessionManager::FinishSession(const std::shared_ptr<SessionContext>& ctx) {
   if (ctx->ended) {
     return;
   }
   ctx->ended = true;
-  auto snapshot = ctx->simulation.Snapshot();
-  int winner_user_id = 0;
-  int best_position = std::numeric_limits<int>::min();
-  for (const auto& player : snapshot["players"]) {
-    int pos = player["position"].get<int>();
-    int uid = player["userId"].get<int>();
-    if (pos > best_position) {
-      best_position = pos;
-      winner_user_id = uid;
-    }
-  }
-  nlohmann::json result_payload{{"sessionId", ctx->id},
-                                {"reason", "completed"},
-                                {"result", {{"winnerUserId", winner_user_id}, {"ticks", snapshot["tick"].get<int>()}}}};
-  BroadcastToParticipants(ctx, "session.ended", result_payload);
-
-  MatchResultRecord record{ctx->id,
-                           ctx->participants.at(0).user_id,
-                           ctx->participants.at(1).user_id,
+  UnscheduleTick(ctx);
+  if (observability_ && ctx->governor.Degraded()) {
+    observability_->SessionDegraded(false);
+  }
+  const auto view = ctx->simulation.View();
+  // 위치 내림차순, 동점은 user_id 오름차순(뷰 순회 순서)으로 순위를 매긴다. 참가자만 순위에 넣는다.
+  std::vector<std::pair<int, int>> standings;
+  standings.reserve(ctx->participants.size());
+  view.ForEachPlayer([&](const PlayerView& player) {
+    if (ctx->IsParticipant(player.user_id)) {
+      standings.emplace_back(player.position, player.user_id);
+    }
+  });
+  std::stable_sort(standings.begin(), standings.end(),
+                   [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+  std::vector<int> ranked_user_ids;
+  ranked_user_ids.reserve(standings.size());
+  for (const auto& standing : standings) {
+    ranked_user_ids.push_back(standing.second);
+  }
+  const int winner_user_id = ranked_user_ids.empty() ? 0 : ranked_user_ids.front();
+  nlohmann::json result_payload{
+      {"sessionId", ctx->wire_id},
+      {"reason", "completed"},
+      {"result", {{"winnerUserId", winner_user_id}, {"ranking", ranked_user_ids}, {"ticks", view.Tick()}}}};
+  // 관전자도 참가자와 같은 종료 프레임을 받고 구독이 끝난다.
+  DropSpectators(ctx, BroadcastToParticipants(ctx, "session.ended", std::move(result_payload)));
+  TraceSessionEvent(ctx, MatchEvent::kEnded);
+
+  MatchResultRecord record{ctx->wire_id,
+                           std::move(ranked_user_ids),
                            winner_user_id,
-                           snapshot["tick"].get<int>(),
+                           view.Tick(),
                            std::chrono::system_clock::now(),
-                           snapshot};
-  result_service_->FinalizeResult(record, ctx->participants);
+                           SnapshotToJson(view),
+                           {}};
+  ctx->journal.Finish(view.Tick());
+  // 저널 버퍼 용량은 컨텍스트와 함께 재사용하므로 결과 기록에는 복사본을 넘긴다.
+  record.input_journal = ctx->journal.Bytes();
+  // 저장/레이팅 반영은 finalizer 스레드가 배치로 처리하므로 strand는 해당 잠금을 기다리지 않는다.
+  result_service_->Submit(std::move(record), ctx->participants);
+  UnregisterSession(ctx);
+}
 
-  std::lock_guard<std::mutex> lock(mutex_);
-  for (const auto& p : ctx->participants) {
-    user_to_session_.erase(p.user_id);
+bool SessionManager::PauseForMigration(const std::string& session_id, const std::string& target, SessionExport& out,
+                                       bool& retrying, std::string& error_code, std::string& error_message) {
+  auto ctx = FindSession(session_id, error_code, error_message);
+  if (!ctx) {
+    return false;
+  }
+
+  std::promise<bool> done;
+  boost::asio::dispatch(ctx->strand, [this, ctx, &target, &out, &retrying, &error_code, &error_message, &done]() {
+    if (ctx->ended) {
+      error_code = "session_closed";
+      error_message = "세션이 이미 종료되었습니다";
+      done.set_value(false);
+      return;
+    }
+    retrying = ctx->migration == SessionContext::MigrationState::kInDoubt;
+    if (retrying) {
+      // 앞선 시도가 대상에 남았을 수 있으므로 다른 대상으로 보내면 사본이 둘이 될 수 있다.
+      if (target != ctx->migration_target) {
+        error_code = "migration_in_doubt";
+        error_message = "결과를 알 수 없는 이전은 같은 대상(" + ctx->migration_target + ")으로만 다시 보낼 수 있습니다";
+        done.set_value(false);
+        return;
+      }
+    } else if (ctx->migration != SessionContext::MigrationState::kNone) {
+      error_code = "session_migrating";
+      error_message = "세션이 이미 이전 중입니다";
+      done.set_value(false);
+      return;
+    } else {
+      UnscheduleTick(ctx);
+      ctx->paused_at = std::chrono::system_clock::now();
+      ctx->migration_id = NewMigrationId();
+      ctx->migration_target = target;
+    }
+    ctx->migration = SessionContext::MigrationState::kExporting;
+    // 결과를 모르던 세션은 틱과 입력이 멈춰 있었으므로 다시 만든 이전 단위가 앞선 시도와 같다.
+    // 진행 중인 저널은 실패 시 이어 써야 하므로 복사본에만 종료 표시를 붙인다.
+    InputJournal journal = ctx->journal;
+    journal.Finish(ctx->simulation.CurrentTick());
+    out.migration_id = ctx->migration_id;
+    out.session_id = ctx->wire_id;
+    out.tick = ctx->simulation.CurrentTick();
+    out.participants = ctx->participants;
+    out.journal = journal.TakeBytes();
+    out.state_hash = ctx->simulation.StateHash();
+    out.paused_at_ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(ctx->paused_at.time_since_epoch()).count();
+    done.set_value(true);
+  });
+
+  return done.get_future().get();
+}
+
+void SessionManager::AbortMigration(const std::string& session_id) {
+  std::string error_code;
+  std::string error_message;
+  auto ctx = FindSession(session_id, error_code, error_message);
+  if (!ctx) {
+    return;
+  }
+  boost::asio::dispatch(ctx->strand, [self = shared_from_this(), ctx]() {
+    if (ctx->ended || ctx->migration != SessionContext::MigrationState::kExporting) {
+      return;
+    }
+    ctx->migration = SessionContext::MigrationState::kNone;
+    ctx->migration_id.clear();
+    ctx->migration_target.clear();
+    if (self->observability_) {
+      self->observability_->RecordMigration(MigrationOutcome::kFailed);
+    }
+    self->ScheduleTick(ctx);
+  });
+}
+
+void SessionManager::MarkMigrationInDoubt(const std::string& session_id) {
+  std::string error_code;
+  std::string error_message;
+  auto ctx = FindSession(session_id, error_code, error_message);
+  if (!ctx) {
+    return;
+  }
+  boost::asio::dispatch(ctx->strand, [self = shared_from_this(), ctx]() {
+    if (ctx->ended || ctx->migration != SessionContext::MigrationState::kExporting) {
+      return;
+    }
+    ctx->migration = SessionContext::MigrationState::kInDoubt;
+    if (self->observability_) {
+      self->observability_->RecordMigration(MigrationOutcome::kInDoubt);
+    }
+  });
+}
+
+bool SessionManager::CompleteMigration(const std::string& session_id, const MigrationAccepted& accepted,
+                                       const std::string& target_host, std::string& error_code,
+                                       std::string& error_message) {
+  auto ctx = FindSession(session_id, error_code, error_message);
+  if (!ctx) {
+    return false;
+  }
+
+  std::promise<bool> done;
+  boost::asio::dispatch(ctx->strand, [this, ctx, &accepted, &target_host, &error_code, &error_message, &done]() {
+    if (ctx->ended || ctx->migration != SessionContext::MigrationState::kExporting) {
+      error_code = "session_not_migrating";
+      error_message = "이전 대기 중인 세션이 아닙니다";
+      done.set_value(false);
+      return;
+    }
+    // 토큰은 참가자마다 다르므로 각자에게 따로 보낸다.
+    for (const auto& ticket : accepted.tickets) {
+      if (!ctx->IsParticipant(ticket.user_id)) {
+        continue;
+      }
+      coordinator_->SendEventToUser(ticket.user_id, "session.migrated",
+                                    nlohmann::json{{"sessionId", ctx->wire_id},
+                                                   {"targetSessionId", accepted.session_id},
+                                                   {"tick", accepted.tick},
+                                                   {"target", {{"host", target_host}, {"port", accepted.port}}},
+                                                   {"accessToken", ticket.access_token},
+                                                   {"resumeToken", ticket.resume_token}});
+    }
+    // 관전 구독은 이전 대상으로 넘기지 않는다. 관전자는 대상 서버에서 다시 관전을 요청한다.
+    DropSpectators(ctx, std::make_shared<const std::string>(
+                            ToWsJson(WsEnvelope{"event", "session.unspectated", 0,
+                                                {{"sessionId", ctx->wire_id}, {"reason", "migrated"}}})
+                                .dump()));
+    ctx->ended = true;
+    if (observability_) {
+      if (ctx->governor.Degraded()) {
+        observability_->SessionDegraded(false);
+      }
+      observability_->Tracer().CloseSession(ctx->wire_id);
+      observability_->RecordMigration(MigrationOutcome::kExported);
+    }
+    UnregisterSession(ctx);
+    done.set_value(true);
+  });
+
+  return done.get_future().get();
+}
+
+SessionId SessionManager::ImportSession(const SessionExport& exported, std::string& error_code,
+                                        std::string& error_message) {
+  if (exported.participants.empty() || exported.participants.size() > kMaxSessionPlayers) {
+    error_code = "migration_invalid";
+    error_message = "참가자 수가 올바르지 않습니다";
+    return kInvalidSessionId;
+  }
+  if (exported.migration_id.empty()) {
+    error_code = "migration_invalid";
+    error_message = "migrationId가 필요합니다";
+    return kInvalidSessionId;
+  }
+  std::vector<int> participant_ids;
+  participant_ids.reserve(exported.participants.size());
+  for (const auto& p : exported.participants) {
+    participant_ids.push_back(p.user_id);
+  }
+  std::sort(participant_ids.begin(), participant_ids.end());
+  // 같은 이전 시도는 한 번만 받는다. 원본이 응답을 받지 못해 다시 보내면 이미 받은 세션을 돌려준다.
+  {
+    std::lock_guard<std::mutex> lock(imports_mutex_);
+    const auto now = std::chrono::steady_clock::now();
+    PruneImportRecords(now);
+    auto [it, inserted] = imports_.try_emplace(
+        exported.migration_id, ImportRecord{ImportRecord::State::kImporting, kInvalidSessionId, participant_ids, now});
+    if (!inserted) {
+      switch (it->second.state) {
+        case ImportRecord::State::kImported:
+          // 호출자는 이 참가자들에게 토큰을 다시 발급하므로 처음 받은 참가자와 같을 때만 돌려준다.
+          if (it->second.participant_ids != participant_ids) {
+            error_code = "migration_invalid";
+            error_message = "이미 받은 이전과 참가자가 다릅니다";
+            return kInvalidSessionId;
+          }
+          return it->second.session_id;
+        case ImportRecord::State::kAborted:
+          error_code = "migration_aborted";
+          error_message = "원본이 취소한 이전입니다";
+          return kInvalidSessionId;
+        case ImportRecord::State::kImporting:
+          error_code = "migration_in_progress";
+          error_message = "같은 이전을 받는 중입니다";
+          return kInvalidSessionId;
+      }
+    }
+  }
+  // 받지 못하면 기록을 지워 원본이 같은 id로 다시 시도할 수 있게 한다. 그새 취소됐으면 취소 표시는 남긴다.
+  const auto forget = [this, &exported]() {
+    std::lock_guard<std::mutex> lock(imports_mutex_);
+    auto it = imports_.find(exported.migration_id);
+    if (it != imports_.end() && it->second.state == ImportRecord::State::kImporting) {
+      imports_.erase(it);
+    }
+  };
+
+  // 저널은 요청 본문에서 온다. 재생 전에 헤더 참가자가 이전 단위의 참가자와 같은지 대조한다.
+  JournalHeader header;
+  std::string header_error;
+  if (!ReadJournalHeader(exported.journal, header, header_error)) {
+    error_code = "migration_invalid";
+    error_message = "저널을 재생할 수 없습니다: " + header_error;
+    forget();
+    return kInvalidSessionId;
+  }
+  if (participant_ids != header.user_ids) {
+    error_code = "migration_invalid";
+    error_message = "저널 참가자가 이전 대상 참가자와 다릅니다";
+    forget();
+    return kInvalidSessionId;
+  }
+  // 여기서는 빠른 거절만 한다. 실제 중복 판정은 RegisterSession이 매핑을 걸면서 한다.
+  for (const auto& p : exported.participants) {
+    if (IsUserInSession(p.user_id)) {
+      error_code = "migration_conflict";
+      error_message = "이미 다른 세션에 참가 중인 사용자가 있습니다";
+      forget();
+      return kInvalidSessionId;
+    }
+  }
+
+  const SessionId id = next_session_id_.fetch_add(1, std::memory_order_relaxed);
+  auto ctx = AcquireContext(id);
+  ctx->id = id;
+  FormatSessionId(id, ctx->wire_id);
+  ctx->participants = exported.participants;
+  ctx->participant_ids.assign(participant_ids.begin(), participant_ids.end());
+  // 저널 재생으로 SoA 상태, 미래 틱 대기 입력, 롤백 저장 상태를 복원하고 이후 입력은 같은 저널에 이어 쓴다.
+  // 세션 최대 틱을 넘는 도착 틱은 진행하기 전에 거절되므로 잘못된 저널이 워커를 붙잡지 않는다.
+  const auto replay = ReplayJournal(exported.journal, ctx->simulation, &ctx->journal,
+                                    static_cast<int>(std::min<std::size_t>(max_ticks_, std::numeric_limits<int>::max())));
+  if (!replay.ok) {
+    error_code = "migration_invalid";
+    error_message = "저널을 재생할 수 없습니다: " + replay.error;
+    ReleaseContext(ctx);
+    forget();
+    return kInvalidSessionId;
+  }
+  if (ctx->simulation.CurrentTick() != exported.tick || ctx->simulation.StateHash() != exported.state_hash) {
+    error_code = "migration_state_mismatch";
+    error_message = "복원한 상태가 원본과 다릅니다";
+    ReleaseContext(ctx);
+    forget();
+    return kInvalidSessionId;
+  }
+  ctx->tick_sent = static_cast<std::size_t>(exported.tick);
+  ctx->hash_history[static_cast<std::size_t>(exported.tick) % kHashHistoryTicks] =
+      TickHash{exported.tick, exported.state_hash};
+  ctx->migration = SessionContext::MigrationState::kAwaitingResume;
+  ctx->awaiting_resume = ctx->participant_ids;
+  ctx->paused_at = std::chrono::system_clock::time_point(std::chrono::milliseconds(exported.paused_at_ms));
+  ctx->opened_at = std::chrono::steady_clock::now();
+  if (observability_) {
+    ctx->trace_id = observability_->NextTraceId();
+  }
+  // 재생하는 동안 원본이 취소했을 수 있다. 취소 확인과 등록을 한 잠금 안에서 해 취소 응답 뒤에 세션이 생기지 않게 한다.
+  {
+    std::lock_guard<std::mutex> lock(imports_mutex_);
+    auto& record = imports_[exported.migration_id];
+    if (record.state == ImportRecord::State::kAborted) {
+      error_code = "migration_aborted";
+      error_message = "원본이 취소한 이전입니다";
+      ReleaseContext(ctx);
+      return kInvalidSessionId;
+    }
+    if (!RegisterSession(ctx)) {
+      error_code = "migration_conflict";
+      error_message = "이미 다른 세션에 참가 중인 사용자가 있습니다";
+      ReleaseContext(ctx);
+      imports_.erase(exported.migration_id);
+      return kInvalidSessionId;
+    }
+    record = ImportRecord{ImportRecord::State::kImported, id, participant_ids, std::chrono::steady_clock::now()};
+  }
+  if (observability_) {
+    observability_->RecordMigration(MigrationOutcome::kImported);
+  }
+
+  // 복귀하지 않는 참가자가 있어도 대기 시간이 지나면 틱을 재개한다.
+  boost::asio::dispatch(ctx->strand, [self = shared_from_this(), ctx]() {
+    ctx->timer.expires_after(self->migration_resume_timeout_);
+    ctx->timer.async_wait(boost::asio::bind_executor(ctx->strand, [self, ctx](const boost::system::error_code& ec) {
+      if (!ec && !ctx->ended && ctx->migration == SessionContext::MigrationState::kAwaitingResume) {
+        self->ResumeAfterMigration(ctx);
+      }
+    }));
+  });
+  return id;
+}
+
+bool SessionManager::AbortImport(const std::string& migration_id, std::string& error_code,
+                                 std::string& error_message) {
+  SessionId imported = kInvalidSessionId;
+  {
+    std::lock_guard<std::mutex> lock(imports_mutex_);
+    const auto now = std::chrono::steady_clock::now();
+    PruneImportRecords(now);
+    auto [it, inserted] =
+        imports_.try_emplace(migration_id, ImportRecord{ImportRecord::State::kAborted, kInvalidSessionId, {}, now});
+    if (!inserted && it->second.state == ImportRecord::State::kImported) {
+      imported = it->second.session_id;
+    }
+    // 세션을 내리는 동안 같은 id로 다시 온 요청도 받지 않는다.
+    it->second.state = ImportRecord::State::kAborted;
+    it->second.updated_at = now;
+  }
+  if (imported == kInvalidSessionId || DropImportedSession(imported)) {
+    return true;
+  }
+  {
+    std::lock_guard<std::mutex> lock(imports_mutex_);
+    auto& record = imports_[migration_id];
+    record.state = ImportRecord::State::kImported;
+    record.updated_at = std::chrono::steady_clock::now();
+  }
+  error_code = "migration_committed";
+  error_message = "이전받은 세션이 이미 진행 중이거나 끝났습니다";
+  return false;
+}
+
+bool SessionManager::DropImportedSession(SessionId id) {
+  std::string error_code;
+  std::string error_message;
+  auto ctx = FindSession(FormatSessionId(id), error_code, error_message);
+  if (!ctx) {
+    return false;
   }
-  sessions_.erase(ctx->id);
+
+  std::promise<bool> done;
+  boost::asio::dispatch(ctx->strand, [this, ctx, &done]() {
+    // 복귀한 참가자가 있거나 틱을 재개했으면 이 서버의 세션이 이미 진행 중인 유일한 사본이다.
+    if (ctx->ended || ctx->migration != SessionContext::MigrationState::kAwaitingResume ||
+        ctx->awaiting_resume.size() != ctx->participant_ids.size()) {
+      done.set_value(false);
+      return;
+    }
+    DropSpectators(ctx, std::make_shared<const std::string>(
+                            ToWsJson(WsEnvelope{"event", "session.unspectated", 0,
+                                                {{"sessionId", ctx->wire_id}, {"reason", "migration_aborted"}}})
+                                .dump()));
+    ctx->ended = true;
+    ctx->timer.cancel();
+    if (observability_) {
+      observability_->RecordMigration(MigrationOutcome::kAborted);
+    }
+    UnregisterSession(ctx);
+    done.set_value(true);
+  });
+
+  return done.get_future().get();
+}
+
+void SessionManager::PruneImportRecords(std::chrono::steady_clock::time_point now) {
+  for (auto it = imports_.begin(); it != imports_.end();) {
+    if (it->second.state != ImportRecord::State::kImporting && now - it->second.updated_at > kImportRecordTtl) {
+      it = imports_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+bool SessionManager::ResumeMigratedUser(int user_id, const std::string& session_id, std::string& error_code,
+                                        std::string& error_message) {
+  auto ctx = FindUserSession(user_id, error_code, error_message);
+  if (!ctx) {
+    return false;
+  }
+  if (ctx->wire_id != session_id) {
+    error_code = "session_not_found";
+    error_message = "세션을 찾을 수 없습니다";
+    return false;
+  }
+
+  std::promise<bool> done;
+  boost::asio::dispatch(ctx->strand, [this, ctx, user_id, &error_code, &error_message, &done]() {
+    if (ctx->ended) {
+      error_code = "session_closed";
+      error_message = "세션이 이미 종료되었습니다";
+      done.set_value(false);
+      return;
+    }
+    if (!ctx->IsParticipant(user_id)) {
+      error_code = "not_participant";
+      error_message = "세션 참가자가 아닙니다";
+      done.set_value(false);
+      return;
+    }
+    const auto view = ctx->simulation.View();
+    nlohmann::json payload{{"sessionId", ctx->wire_id},
+                           {"tick", view.Tick()},
+                           {"tickIntervalMs", ctx->tick_interval.count()},
+                           {"stateHash", FormatStateHash(HashSnapshot(view))},
+                           {"players", PlayersToJson(view)}};
+    coordinator_->SendEventToUser(user_id, "session.resumed", payload);
+    auto& awaiting = ctx->awaiting_resume;
+    awaiting.erase(std::remove(awaiting.begin(), awaiting.end(), user_id), awaiting.end());
+    if (ctx->migration == SessionContext::MigrationState::kAwaitingResume && awaiting.empty()) {
+      ResumeAfterMigration(ctx);
+    }
+    done.set_value(true);
+  });
+
+  return done.get_future().get();
+}
+
+void SessionManager::ResumeAfterMigration(const std::shared_ptr<SessionContext>& ctx) {
+  ctx->migration = SessionContext::MigrationState::kNone;
+  ctx->awaiting_resume.clear();
+  // 원본에서 틱을 멈춘 시점부터 대상에서 재개하기까지 놓친 틱 수(올림)를 정지 시간으로 본다.
+  const auto paused = std::chrono::system_clock::now() - ctx->paused_at;
+  const auto interval = std::chrono::duration_cast<std::chrono::system_clock::duration>(ctx->tick_interval);
+  const std::int64_t pause_ticks =
+      interval.count() > 0 ? (paused + interval - std::chrono::system_clock::duration(1)) / interval : 0;
+  if (observability_) {
+    observability_->RecordMigrationPause(static_cast<std::uint64_t>(std::max<std::int64_t>(pause_ticks, 0)));
+  }
+  // 복귀 대기 타이머를 멈추고 다음 틱을 레인에 예약한다.
+  ctx->timer.cancel();
+  ScheduleTick(ctx);
 }
 
-std::size_t SessionManager::ActiveSessionCount() const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return sessions_.size();
+void SessionManager::TraceSessionEvent(const std::shared_ptr<SessionContext>& ctx, MatchEvent event) {
+  if (!observability_) {
+    return;
+  }
+  observability_->Tracer().Mark(ctx->wire_id, event);
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - ctx->opened_at)
+                     .count();
+  observability_->Log(LogContext{ctx->trace_id, std::nullopt, ctx->wire_id, MatchEventName(event), elapsed});
 }
 
 }  // namespace server
@@ -0,0 +1,304 @@
+/*
+ * 설명: 세션 이전 형식의 JSON 변환과 로컬 TCP 요청/응답 전송을 구현한다.
+ * 버전: v1.0.0
+ * 관련 문서: design/server/v0.5.0-match-session.md, design/protocol/contract.md
+ * 테스트: server/tests/e2e/session_migration_test.cpp
+ */
+#include "server/session_migration.hpp"
+
+#include <charconv>
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/streambuf.hpp>
+#include <boost/asio/write.hpp>
+#include <openssl/crypto.h>
+#include <openssl/rand.h>
+
+#include "server/input_journal.hpp"
+
+namespace server {
+namespace {
+
+bool HasInt(const nlohmann::json& json, const char* key) { return json.contains(key) && json[key].is_number_integer(); }
+
+bool HasString(const nlohmann::json& json, const char* key) { return json.contains(key) && json[key].is_string(); }
+
+std::string HashToHex(std::uint64_t hash) {
+  char buffer[16];
+  auto result = std::to_chars(buffer, buffer + sizeof(buffer), hash, 16);
+  return std::string(buffer, result.ptr);
+}
+
+// 연결 하나에서 요청 한 줄을 읽고 응답 한 줄을 쓴 뒤 닫는다.
+class MigrationConnection : public std::enable_shared_from_this<MigrationConnection> {
+ public:
+  MigrationConnection(boost::asio::ip::tcp::socket socket, MigrationListener::Handler handler)
+      : socket_(std::move(socket)), handler_(std::move(handler)), buffer_(kMaxMigrationBytes) {}
+
+  void Run() {
+    auto self = shared_from_this();
+    boost::asio::async_read_until(socket_, buffer_, '\n',
+                                  [self](const boost::system::error_code& ec, std::size_t bytes) {
+                                    self->OnRead(ec, bytes);
+                                  });
+  }
+
+ private:
+  void OnRead(const boost::system::error_code& ec, std::size_t bytes) {
+    if (ec) {
+      return;
+    }
+    std::string line(boost::asio::buffers_begin(buffer_.data()), boost::asio::buffers_begin(buffer_.data()) + bytes);
+    nlohmann::json reply;
+    try {
+      reply = handler_(nlohmann::json::parse(line));
+    } catch (const std::exception&) {
+      reply = nlohmann::json{{"ok", false}, {"code", "bad_request"}, {"message", "이전 요청을 해석할 수 없습니다"}};
+    }
+    reply_ = reply.dump();
+    reply_.push_back('\n');
+    auto self = shared_from_this();
+    boost::asio::async_write(socket_, boost::asio::buffer(reply_),
+                             [self](const boost::system::error_code&, std::size_t) {
+                               boost::system::error_code ignored;
+                               self->socket_.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignored);
+                             });
+  }
+
+  boost::asio::ip::tcp::socket socket_;
+  MigrationListener::Handler handler_;
+  boost::asio::streambuf buffer_;
+  std::string reply_;
+};
+
+// 원본 측 이전 요청 하나. 소켓과 타이머를 호출자 executor에 두고, 응답과 시간 초과 중 먼저 끝나는 쪽이 결과를 한 번만 알린다.
+class MigrationClient : public std::enable_shared_from_this<MigrationClient> {
+ public:
+  MigrationClient(const boost::asio::ip::tcp::socket::executor_type& executor, std::string line,
+                  MigrationReplyHandler done)
+      : socket_(executor), timer_(executor), buffer_(kMaxMigrationBytes), line_(std::move(line)),
+        done_(std::move(done)) {}
+
+  void Run(const boost::asio::ip::tcp::endpoint& endpoint, std::chrono::milliseconds timeout) {
+    auto self = shared_from_this();
+    timer_.expires_after(timeout);
+    timer_.async_wait([self](const boost::system::error_code& ec) {
+      if (ec) {
+        return;
+      }
+      self->Finish(false, nullptr,
+                   self->connected_ ? "이전 대상 응답 시간이 초과되었습니다" : "이전 대상에 연결하지 못했습니다");
+    });
+    socket_.async_connect(endpoint, [self](const boost::system::error_code& ec) { self->OnConnect(ec); });
+  }
+
+ private:
+  void OnConnect(const boost::system::error_code& ec) {
+    if (ec) {
+      return Fail(ec);
+    }
+    connected_ = true;
+    auto self = shared_from_this();
+    boost::asio::async_write(socket_, boost::asio::buffer(line_),
+                             [self](const boost::system::error_code& write_ec, std::size_t) {
+                               self->OnWrite(write_ec);
+                             });
+  }
+
+  void OnWrite(const boost::system::error_code& ec) {
+    if (ec) {
+      return Fail(ec);
+    }
+    auto self = shared_from_this();
+    boost::asio::async_read_until(socket_, buffer_, '\n',
+                                  [self](const boost::system::error_code& read_ec, std::size_t bytes) {
+                                    self->OnRead(read_ec, bytes);
+                                  });
+  }
+
+  void OnRead(const boost::system::error_code& ec, std::size_t bytes) {
+    if (ec) {
+      return Fail(ec);
+    }
+    nlohmann::json reply;
+    try {
+      reply = nlohmann::json::parse(std::string(boost::asio::buffers_begin(buffer_.data()),
+                                                boost::asio::buffers_begin(buffer_.data()) + bytes));
+    } catch (const std::exception&) {
+      return Finish(false, nullptr, "이전 대상 응답을 해석할 수 없습니다");
+    }
+    Finish(true, reply, "");
+  }
+
+  void Fail(const boost::system::error_code& ec) {
+    Finish(false, nullptr, "이전 대상과 통신하지 못했습니다: " + ec.message());
+  }
+
+  // 시간 초과로 소켓을 닫으면 진행 중이던 작업이 operation_aborted로 끝나 다시 들어오므로 한 번만 알린다.
+  void Finish(bool ok, const nlohmann::json& reply, const std::string& error_message) {
+    if (finished_) {
+      return;
+    }
+    finished_ = true;
+    timer_.cancel();
+    boost::system::error_code ignored;
+    socket_.close(ignored);
+    done_(ok, connected_, reply, error_message);
+  }
+
+  boost::asio::ip::tcp::socket socket_;
+  boost::asio::steady_timer timer_;
+  boost::asio::streambuf buffer_;
+  std::string line_;
+  MigrationReplyHandler done_;
+  bool connected_{false};
+  bool finished_{false};
+};
+
+}  // namespace
+
+std::string NewMigrationId() {
+  unsigned char bytes[16];
+  RAND_bytes(bytes, sizeof(bytes));
+  static constexpr char kDigits[] = "0123456789abcdef";
+  std::string id;
+  id.reserve(sizeof(bytes) * 2);
+  for (const unsigned char byte : bytes) {
+    id.push_back(kDigits[byte >> 4]);
+    id.push_back(kDigits[byte & 0x0f]);
+  }
+  return id;
+}
+
+bool MigrationTokenMatches(const std::string& expected, const nlohmann::json& request) {
+  if (expected.empty() || !HasString(request, "migrationToken")) {
+    return false;
+  }
+  const auto& presented = request["migrationToken"].get_ref<const std::string&>();
+  return presented.size() == expected.size() && CRYPTO_memcmp(presented.data(), expected.data(), expected.size()) == 0;
+}
+
+nlohmann::json SessionExportToJson(const SessionExport& exported) {
+  nlohmann::json participants = nlohmann::json::array();
+  for (const auto& p : exported.participants) {
+    participants.push_back({{"userId", p.user_id}, {"username", p.username}});
+  }
+  return nlohmann::json{{"migrationId", exported.migration_id},
+                        {"sessionId", exported.session_id},
+                        {"tick", exported.tick},
+                        {"participants", std::move(participants)},
+                        {"journal", EncodeBase64(exported.journal)},
+                        {"stateHash", HashToHex(exported.state_hash)},
+                        {"pausedAtMs", exported.paused_at_ms}};
+}
+
+bool SessionExportFromJson(const nlohmann::json& json, SessionExport& out, std::string& error_message) {
+  if (!json.is_object() || !HasString(json, "migrationId") || !HasString(json, "sessionId") || !HasInt(json, "tick") ||
+      !json.contains("participants") || !json["participants"].is_array() || !HasString(json, "journal") ||
+      !HasString(json, "stateHash") || !HasInt(json, "pausedAtMs")) {
+    error_message = "이전 세션 필드가 올바르지 않습니다";
+    return false;
+  }
+  out.migration_id = json["migrationId"].get<std::string>();
+  if (out.migration_id.empty() || out.migration_id.size() > kMaxMigrationIdBytes) {
+    error_message = "migrationId 길이가 올바르지 않습니다";
+    return false;
+  }
+  out.session_id = json["sessionId"].get<std::string>();
+  out.tick = json["tick"].get<int>();
+  out.paused_at_ms = json["pausedAtMs"].get<std::int64_t>();
+  out.participants.clear();
+  for (const auto& p : json["participants"]) {
+    if (!p.is_object() || !HasInt(p, "userId") || !HasString(p, "username")) {
+      error_message = "참가자 형식이 올바르지 않습니다";
+      return false;
+    }
+    out.participants.push_back(SessionParticipant{p["userId"].get<int>(), p["username"].get<std::string>()});
+  }
+  if (!DecodeBase64(json["journal"].get_ref<const std::string&>(), out.journal)) {
+    error_message = "journal은 base64여야 합니다";
+    return false;
+  }
+  const auto& hash_text = json["stateHash"].get_ref<const std::string&>();
+  auto [end, ec] = std::from_chars(hash_text.data(), hash_text.data() + hash_text.size(), out.state_hash, 16);
+  if (hash_text.empty() || ec != std::errc() || end != hash_text.data() + hash_text.size()) {
+    error_message = "stateHash는 16진수 문자열이어야 합니다";
+    return false;
+  }
+  return true;
+}
+
+nlohmann::json MigrationAcceptedToJson(const MigrationAccepted& accepted) {
+  nlohmann::json tickets = nlohmann::json::array();
+  for (const auto& ticket : accepted.tickets) {
+    tickets.push_back({{"userId", ticket.user_id},
+                       {"accessToken", ticket.access_token},
+                       {"resumeToken", ticket.resume_token}});
+  }
+  return nlohmann::json{{"sessionId", accepted.session_id},
+                        {"tick", accepted.tick},
+                        {"port", accepted.port},
+                        {"tickets", std::move(tickets)}};
+}
+
+bool MigrationAcceptedFromJson(const nlohmann::json& json, MigrationAccepted& out, std::string& error_message) {
+  if (!json.is_object() || !HasString(json, "sessionId") || !HasInt(json, "tick") || !HasInt(json, "port") ||
+      !json.contains("tickets") || !json["tickets"].is_array()) {
+    error_message = "이전 응답 필드가 올바르지 않습니다";
+    return false;
+  }
+  out.session_id = json["sessionId"].get<std::string>();
+  out.tick = json["tick"].get<int>();
+  out.port = json["port"].get<unsigned short>();
+  out.tickets.clear();
+  for (const auto& t : json["tickets"]) {
+    if (!t.is_object() || !HasInt(t, "userId") || !HasString(t, "accessToken") || !HasString(t, "resumeToken")) {
+      error_message = "접속 정보 형식이 올바르지 않습니다";
+      return false;
+    }
+    out.tickets.push_back(MigrationTicket{t["userId"].get<int>(), t["accessToken"].get<std::string>(),
+                                          t["resumeToken"].get<std::string>()});
+  }
+  return true;
+}
+
+MigrationListener::MigrationListener(boost::asio::io_context& ioc, unsigned short port, Handler handler)
+    : ioc_(ioc),
+      acceptor_(ioc, boost::asio::ip::tcp::endpoint{boost::asio::ip::address_v4::loopback(), port}),
+      handler_(std::move(handler)) {}
+
+void MigrationListener::Run() { DoAccept(); }
+
+void MigrationListener::Stop() {
+  boost::system::error_code ec;
+  acceptor_.close(ec);
+}
+
+void MigrationListener::DoAccept() {
+  acceptor_.async_accept(ioc_, [self = shared_from_this()](const boost::system::error_code& ec,
+                                                           boost::asio::ip::tcp::socket socket) {
+    if (ec) {
+      return;
+    }
+    std::make_shared<MigrationConnection>(std::move(socket), self->handler_)->Run();
+    self->DoAccept();
+  });
+}
+
+void AsyncSendMigration(const boost::asio::ip::tcp::socket::executor_type& executor, const std::string& host,
+                        unsigned short port, const nlohmann::json& request, std::chrono::milliseconds timeout,
+                        MigrationReplyHandler done) {
+  boost::system::error_code address_ec;
+  const auto address = boost::asio::ip::make_address(host, address_ec);
+  if (address_ec) {
+    boost::asio::post(executor,
+                      [done = std::move(done)]() { done(false, false, nullptr, "대상 주소가 올바르지 않습니다"); });
+    return;
+  }
+  auto client = std::make_shared<MigrationClient>(executor, request.dump() + "\n", std::move(done));
+  client->Run({address, port}, timeout);
+}
+
+}  // namespace server
@@ -11,31 +11,129 @@
 
 namespace server {
 
+Simulation::Simulation() : ring_(kInputHorizonTicks) {}
+
+void Simulation::EnableRollback(int window_ticks) {
+  rollback_window_ = std::clamp(window_ticks, 0, kMaxRollbackTicks);
+  // 풀에서 꺼낸 세션은 창 크기가 같으면 사본 배열을 그대로 두고 내용만 비운다.
+  // 창이 바뀌어도 남는 사본의 용량은 유지된다.
+  saved_states_.resize(static_cast<std::size_t>(rollback_window_));
+  ClearSavedStates();
+  for (auto& saved : saved_states_) {
+    saved.positions.reserve(user_ids_.size());
+    saved.last_sequences.reserve(user_ids_.size());
+    saved.visible.reserve(user_ids_.size());
+  }
+}
+
+void Simulation::ClearSavedStates() {
+  for (auto& saved : saved_states_) {
+    saved.tick = 0;
+    saved.positions.clear();
+    saved.last_sequences.clear();
+    saved.visible.clear();
+  }
+}
+
+void Simulation::Reset() {
+  current_tick_ = 0;
+  dirty_from_tick_ = 0;
+  for (auto& bucket : ring_) {
+    bucket.events.clear();
+    bucket.counts.clear();
+  }
+  ClearSavedStates();
+  user_ids_.clear();
+  positions_.clear();
+  last_sequences_.clear();
+  accepted_sequences_.clear();
+  visible_.clear();
+}
+
 ValidationResult Simulation::EnqueueInput(const InputCommand& input) {
   std::string reason;
-  if (!ValidateInput(input, reason)) {
+  if (!ValidateInput(input, FindSlot(input.user_id), reason)) {
     return ValidationResult{false, reason};
   }
 
-  auto& tracker = trackers_[input.user_id];
-  tracker.last_sequence = input.sequence;
-  ++tracker.per_tick_count[input.target_tick];
-  inputs_by_tick_[input.target_tick].push_back(input);
+  const auto slot = EnsureSlot(input.user_id);
+  accepted_sequences_[slot] = input.sequence;
+  auto& bucket = BucketFor(input.target_tick);
+  ++bucket.counts[slot];
+  // 적용 순서(sequence → user_id)대로 삽입해 틱 처리 시 정렬하지 않는다. 용량은 EnsureSlot에서 확보된다.
+  PendingInput pending{slot, input.delta, input.sequence};
+  auto pos = std::upper_bound(bucket.events.begin(), bucket.events.end(), pending,
+                              [](const PendingInput& lhs, const PendingInput& rhs) {
+                                if (lhs.sequence == rhs.sequence) {
+                                  return lhs.slot < rhs.slot;
+                                }
+                                return lhs.sequence < rhs.sequence;
+                              });
+  bucket.events.insert(pos, pending);
+  if (input.target_tick <= current_tick_ &&
+      (dirty_from_tick_ == 0 || input.target_tick < dirty_from_tick_)) {
+    dirty_from_tick_ = input.target_tick;
+  }
   return ValidationResult{true, {}};
 }
 
-void Simulation::AddPlayer(int user_id) {
-  if (players_.count(user_id) == 0) {
-    players_[user_id] = PlayerState{};
+void Simulation::AddPlayer(int user_id) { visible_[EnsureSlot(user_id)] = 1; }
+
+std::size_t Simulation::FindSlot(int user_id) const {
+  auto it = std::lower_bound(user_ids_.begin(), user_ids_.end(), user_id);
+  if (it == user_ids_.end() || *it != user_id) {
+    return kNoSlot;
+  }
+  return static_cast<std::size_t>(it - user_ids_.begin());
+}
+
+std::size_t Simulation::EnsureSlot(int user_id) {
+  auto it = std::lower_bound(user_ids_.begin(), user_ids_.end(), user_id);
+  const auto slot = static_cast<std::size_t>(it - user_ids_.begin());
+  if (it != user_ids_.end() && *it == user_id) {
+    return slot;
+  }
+
+  user_ids_.insert(it, user_id);
+  positions_.insert(positions_.begin() + slot, 0);
+  last_sequences_.insert(last_sequences_.begin() + slot, 0);
+  accepted_sequences_.insert(accepted_sequences_.begin() + slot, 0);
+  visible_.insert(visible_.begin() + slot, 0);
+
+  // 플레이어 추가는 세션 초기화 시점에만 일어나므로 대기 입력 슬롯 재배치와
+  // 버킷 용량 확보를 이때 몰아서 처리해 이후 틱 진행 중에는 할당이 없도록 한다.
+  const auto max_events = user_ids_.size() * kMaxInputsPerTickPerUser;
+  for (auto& bucket : ring_) {
+    for (auto& evt : bucket.events) {
+      if (evt.slot >= slot) {
+        ++evt.slot;
+      }
+    }
+    bucket.counts.insert(bucket.counts.begin() + slot, 0);
+    bucket.events.reserve(max_events);
+  }
+  for (auto& saved : saved_states_) {
+    if (slot <= saved.positions.size()) {
+      saved.positions.insert(saved.positions.begin() + slot, 0);
+      saved.last_sequences.insert(saved.last_sequences.begin() + slot, 0);
+      saved.visible.insert(saved.visible.begin() + slot, 0);
+    }
   }
+  return slot;
 }
 
-bool Simulation::ValidateInput(const InputCommand& input, std::string& reason) const {
-  if (input.target_tick <= current_tick_) {
+bool Simulation::ValidateInput(const InputCommand& input, std::size_t slot, std::string& reason) const {
+  // 롤백 창 안(현재 틱 - 창 < target_tick ≤ 현재 틱)의 늦은 입력은 받아서 재시뮬레이션한다.
+  if (input.target_tick <= current_tick_ - rollback_window_ || input.target_tick <= 0) {
     reason = "stale_tick";
     return false;
   }
 
+  if (input.target_tick - current_tick_ > kInputHorizonTicks - rollback_window_) {
+    reason = "tick_out_of_window";
+    return false;
+  }
+
   if (input.delta > kMaxDelta || input.delta < -kMaxDelta) {
     reason = "delta_out_of_range";
     return false;
@@ -46,15 +144,12 @@ bool Simulation::ValidateInput(const InputCommand& input, std::string& reason) c
     return false;
   }
 
-  const auto tracker_it = trackers_.find(input.user_id);
-  if (tracker_it != trackers_.end()) {
-    if (input.sequence <= tracker_it->second.last_sequence) {
+  if (slot != kNoSlot) {
+    if (input.sequence <= accepted_sequences_[slot]) {
       reason = "sequence_not_monotonic";
       return false;
     }
-    const auto count_it = tracker_it->second.per_tick_count.find(input.target_tick);
-    if (count_it != tracker_it->second.per_tick_count.end() &&
-        count_it->second >= kMaxInputsPerTickPerUser) {
+    if (BucketFor(input.target_tick).counts[slot] >= kMaxInputsPerTickPerUser) {
       reason = "tick_input_limit";
       return false;
     }
@@ -63,32 +158,55 @@ bool Simulation::ValidateInput(const InputCommand& input, std::string& reason) c
   return true;
 }
 
-void Simulation::ApplyEvent(const InputCommand& input) {
-  auto& state = players_[input.user_id];
-  state.position += input.delta;
-  state.last_sequence = input.sequence;
+void Simulation::ApplyEvent(const PendingInput& input) {
+  positions_[input.slot] += input.delta;
+  last_sequences_[input.slot] = input.sequence;
+  visible_[input.slot] = 1;
 }
 
-void Simulation::TickOnce() {
-  ++current_tick_;
-  auto it = inputs_by_tick_.find(current_tick_);
-  if (it == inputs_by_tick_.end()) {
-    return;
+void Simulation::ApplyTick(int tick) {
+  if (rollback_window_ > 0) {
+    // assign은 기존 용량을 재사용하므로 정상 상태에서는 할당 없이 상태를 복사한다.
+    auto& saved = SavedStateFor(tick);
+    saved.tick = tick;
+    saved.positions.assign(positions_.begin(), positions_.end());
+    saved.last_sequences.assign(last_sequences_.begin(), last_sequences_.end());
+    saved.visible.assign(visible_.begin(), visible_.end());
+  }
+  for (const auto& evt : BucketFor(tick).events) {
+    ApplyEvent(evt);
   }
+}
 
-  auto& events = it->second;
-  std::stable_sort(events.begin(), events.end(), [](const InputCommand& lhs, const InputCommand& rhs) {
-    if (lhs.sequence == rhs.sequence) {
-      return lhs.user_id < rhs.user_id;
-    }
-    return lhs.sequence < rhs.sequence;
-  });
+int Simulation::Resimulate() {
+  if (dirty_from_tick_ == 0) {
+    return 0;
+  }
+  const int from = dirty_from_tick_;
+  dirty_from_tick_ = 0;
 
-  for (const auto& evt : events) {
-    ApplyEvent(evt);
+  const auto& saved = SavedStateFor(from);
+  positions_.assign(saved.positions.begin(), saved.positions.end());
+  last_sequences_.assign(saved.last_sequences.begin(), saved.last_sequences.end());
+  visible_.assign(saved.visible.begin(), saved.visible.end());
+  for (int tick = from; tick <= current_tick_; ++tick) {
+    ApplyTick(tick);
   }
+  return current_tick_ - from + 1;
+}
+
+void Simulation::TickOnce() {
+  Resimulate();
+  ++current_tick_;
+  ApplyTick(current_tick_);
 
-  inputs_by_tick_.erase(it);
+  // 버킷은 롤백 창을 벗어날 때 비워 kInputHorizonTicks 뒤의 틱에 재사용한다. clear/fill은 용량을 유지한다.
+  const int expired = current_tick_ - rollback_window_;
+  if (expired > 0) {
+    auto& bucket = BucketFor(expired);
+    bucket.events.clear();
+    std::fill(bucket.counts.begin(), bucket.counts.end(), 0);
+  }
 }
 
 void Simulation::RunForDuration(std::chrono::milliseconds duration) {
@@ -101,21 +219,42 @@ void Simulation::RunForDuration(std::chrono::milliseconds duration) {
   }
 }
 
-nlohmann::json Simulation::Snapshot() const {
-  std::vector<int> user_ids;
-  user_ids.reserve(players_.size());
-  for (const auto& entry : players_) {
-    user_ids.push_back(entry.first);
-  }
-  std::sort(user_ids.begin(), user_ids.end());
+nlohmann::json PlayerToJson(const PlayerView& player) {
+  return nlohmann::json{
+      {"userId", player.user_id}, {"position", player.position}, {"lastSequence", player.last_sequence}};
+}
 
+nlohmann::json PlayersToJson(const SnapshotView& view) {
   nlohmann::json players_json = nlohmann::json::array();
-  for (int user_id : user_ids) {
-    const auto& state = players_.at(user_id);
-    players_json.push_back({{"userId", user_id}, {"position", state.position}, {"lastSequence", state.last_sequence}});
-  }
+  view.ForEachPlayer([&players_json](const PlayerView& player) { players_json.push_back(PlayerToJson(player)); });
+  return players_json;
+}
 
-  return nlohmann::json{{"tick", current_tick_}, {"players", players_json}};
+nlohmann::json SnapshotToJson(const SnapshotView& view) {
+  return nlohmann::json{{"tick", view.Tick()}, {"players", PlayersToJson(view)}};
+}
+
+namespace {
+constexpr std::uint64_t kHashOffset = 0xcbf29ce484222325ULL;
+constexpr std::uint64_t kHashPrime = 0x100000001b3ULL;
+
+// FNV-1a를 바이트 대신 64비트 워드 단위로 적용하고, 곱셈이 상위 비트로만 전파되는 것을 보완해 하위로 다시 접는다.
+std::uint64_t MixWord(std::uint64_t hash, std::uint64_t word) {
+  hash ^= word;
+  hash *= kHashPrime;
+  return hash ^ (hash >> 32);
+}
+}  // namespace
+
+std::uint64_t HashSnapshot(const SnapshotView& view) {
+  // 음수 값은 64비트로 부호 확장해 플랫폼과 무관하게 같은 워드가 되도록 한다.
+  auto hash = MixWord(kHashOffset, static_cast<std::uint64_t>(static_cast<std::int64_t>(view.Tick())));
+  view.ForEachPlayer([&hash](const PlayerView& player) {
+    hash = MixWord(hash, static_cast<std::uint64_t>(static_cast<std::int64_t>(player.user_id)));
+    hash = MixWord(hash, static_cast<std::uint64_t>(static_cast<std::int64_t>(player.position)));
+    hash = MixWord(hash, player.last_sequence);
+  });
+  return hash;
 }
 
 }  // namespace server
@@ -0,0 +1,51 @@
+/*
+ * 설명: 틱 지연과 이벤트 루프 지연을 보고 세션별 틱 간격을 설정 범위 안에서 늘리거나 되돌린다.
+ * 버전: v1.0.0
+ * 관련 문서: design/server/v0.5.0-match-session.md, design/protocol/contract.md
+ * 테스트: server/tests/unit/tick_governor_test.cpp
+ */
+#include "server/tick_governor.hpp"
+
+#include <algorithm>
+
+namespace server {
+
+TickGovernor::TickGovernor(const TickGovernorConfig& config) : config_(config), interval_(config.base_interval) {}
+
+bool TickGovernor::Observe(std::chrono::microseconds tick_lateness, std::chrono::microseconds loop_lag) {
+  if (!Enabled()) {
+    return false;
+  }
+  const double interval_us = static_cast<double>(std::chrono::microseconds(interval_).count());
+  const double signal_us = static_cast<double>(std::max(tick_lateness, loop_lag).count());
+
+  if (signal_us > interval_us * config_.pressure_ratio) {
+    relief_streak_ = 0;
+    if (++pressure_streak_ < config_.pressure_ticks) {
+      return false;
+    }
+    pressure_streak_ = 0;
+    auto next = std::chrono::milliseconds(static_cast<long long>(interval_.count() * config_.step_factor + 0.5));
+    next = std::min(std::max(next, interval_ + std::chrono::milliseconds(1)), config_.max_interval);
+    if (next == interval_) {
+      return false;
+    }
+    interval_ = next;
+    return true;
+  }
+
+  pressure_streak_ = 0;
+  if (signal_us >= interval_us * config_.relief_ratio || !Degraded()) {
+    relief_streak_ = 0;
+    return false;
+  }
+  if (++relief_streak_ < config_.relief_ticks) {
+    return false;
+  }
+  relief_streak_ = 0;
+  auto next = std::chrono::milliseconds(static_cast<long long>(interval_.count() / config_.step_factor));
+  interval_ = std::max(next, config_.base_interval);
+  return true;
+}
+
+}  // namespace server
@@ -0,0 +1,34 @@
+/*
+ * 설명: 소비자 스레드 깨우기 신호를 잠금 안의 표시와 조건 변수로 구현한다.
+ * 버전: v1.0.0
+ * 관련 문서: design/server/v0.5.0-match-session.md, design/server/v0.6.0-rating-leaderboard.md
+ * 테스트: server/tests/unit/result_service_test.cpp, server/tests/e2e/session_flow_test.cpp
+ */
+#include "server/wake_signal.hpp"
+
+namespace server {
+
+void WakeSignal::Notify() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    signaled_ = true;
+  }
+  cv_.notify_one();
+}
+
+void WakeSignal::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this]() { return signaled_; });
+  signaled_ = false;
+}
+
+bool WakeSignal::WaitUntil(Clock::time_point deadline) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!cv_.wait_until(lock, deadline, [this]() { return signaled_; })) {
+    return false;
+  }
+  signaled_ = false;
+  return true;
+}
+
+}  // namespace server
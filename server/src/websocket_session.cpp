@@ -7,6 +7,8 @@
  */
 #include "server/websocket_session.hpp"
 
+#include <algorithm>
+#include <charconv>
 #include <chrono>
 #include <iomanip>
 #include <iostream>
@@ -30,10 +32,11 @@ WebSocketSession::WebSocketSession(boost::beast::websocket::stream<boost::beast:
                                    const AuthSession& session, std::shared_ptr<ReconnectService> reconnect_service,
                                    std::shared_ptr<RealtimeCoordinator> coordinator,
                                    std::shared_ptr<SessionManager> session_manager, std::size_t max_queue_messages,
-                                   std::size_t max_queue_bytes)
+                                   std::size_t max_queue_bytes, std::size_t max_spectator_frames)
     : ws_(std::move(ws)), session_(session), reconnect_service_(std::move(reconnect_service)),
       coordinator_(std::move(coordinator)), session_manager_(std::move(session_manager)),
-      max_queue_messages_(max_queue_messages), max_queue_bytes_(max_queue_bytes) {}
+      max_queue_messages_(max_queue_messages), max_queue_bytes_(max_queue_bytes),
+      max_spectator_frames_(std::max<std::size_t>(max_spectator_frames, 1)) {}
 
 WebSocketSession::~WebSocketSession() { coordinator_->Unregister(session_.user.user_id, this); }
 
@@ -105,6 +108,34 @@ void WebSocketSession::OnRead(boost::beast::error_code ec, std::size_t /*bytes_t
           return DoRead();
         }
         HandleSessionInput(*payload_it, seq);
+      } else if (*event_it == "session.desync") {
+        auto payload_it = message.find("p");
+        if (payload_it == message.end() || !payload_it->is_object()) {
+          SendError("bad_request", "payload가 누락되었습니다", seq);
+          return DoRead();
+        }
+        HandleSessionDesync(*payload_it, seq);
+      } else if (*event_it == "session.resume") {
+        auto payload_it = message.find("p");
+        if (payload_it == message.end() || !payload_it->is_object()) {
+          SendError("bad_request", "payload가 누락되었습니다", seq);
+          return DoRead();
+        }
+        HandleSessionResume(*payload_it, seq);
+      } else if (*event_it == "session.spectate") {
+        auto payload_it = message.find("p");
+        if (payload_it == message.end() || !payload_it->is_object()) {
+          SendError("bad_request", "payload가 누락되었습니다", seq);
+          return DoRead();
+        }
+        HandleSessionSpectate(*payload_it, seq);
+      } else if (*event_it == "session.unspectate") {
+        auto payload_it = message.find("p");
+        if (payload_it == message.end() || !payload_it->is_object()) {
+          SendError("bad_request", "payload가 누락되었습니다", seq);
+          return DoRead();
+        }
+        HandleSessionUnspectate(*payload_it, seq);
       } else {
         SendError("bad_request", "알 수 없는 이벤트", seq);
       }
@@ -162,6 +193,95 @@ void WebSocketSession::HandleSessionInput(const nlohmann::json& message, std::ui
   }
 }
 
+void WebSocketSession::HandleSessionDesync(const nlohmann::json& message, std::uint64_t seq) {
+  if (!message.contains("sessionId") || !message.contains("tick") || !message.contains("stateHash")) {
+    SendError("bad_request", "필수 필드가 없습니다", seq);
+    return;
+  }
+  if (!message["sessionId"].is_string() || !message["tick"].is_number_integer() || !message["stateHash"].is_string()) {
+    SendError("bad_request", "필드 형식이 올바르지 않습니다", seq);
+    return;
+  }
+  const auto& hash_text = message["stateHash"].get_ref<const std::string&>();
+  std::uint64_t state_hash = 0;
+  auto [end, ec] = std::from_chars(hash_text.data(), hash_text.data() + hash_text.size(), state_hash, 16);
+  if (hash_text.empty() || hash_text.size() > 16 || ec != std::errc() || end != hash_text.data() + hash_text.size()) {
+    SendError("bad_request", "stateHash는 16진수 문자열이어야 합니다", seq);
+    return;
+  }
+  StateHashReport report{message["sessionId"].get<std::string>(), session_.user.user_id, message["tick"].get<int>(),
+                         state_hash};
+  std::string error_code;
+  std::string error_message;
+  if (!session_manager_->ReportDesync(report, error_code, error_message)) {
+    SendError(error_code, error_message, seq);
+  }
+}
+
+void WebSocketSession::HandleSessionResume(const nlohmann::json& message, std::uint64_t seq) {
+  if (!message.contains("sessionId") || !message.contains("resumeToken") || !message["sessionId"].is_string() ||
+      !message["resumeToken"].is_string()) {
+    SendError("bad_request", "sessionId와 resumeToken이 필요합니다", seq);
+    return;
+  }
+  const auto session_id = message["sessionId"].get<std::string>();
+  // 이전을 받은 서버가 발급한 토큰만 받는다. 스냅샷에 이전된 세션 id가 담겨 있다.
+  auto snapshot = reconnect_service_->Validate(message["resumeToken"].get<std::string>(), session_.user);
+  if (!snapshot || snapshot->snapshot.value("state", "") != "migrated" ||
+      snapshot->snapshot.value("sessionId", "") != session_id) {
+    SendError("invalid_resume_token", "세션 복귀 토큰이 유효하지 않습니다", seq);
+    return;
+  }
+  std::string error_code;
+  std::string error_message;
+  if (!session_manager_->ResumeMigratedUser(session_.user.user_id, session_id, error_code, error_message)) {
+    SendError(error_code, error_message, seq);
+  }
+}
+
+void WebSocketSession::HandleSessionSpectate(const nlohmann::json& message, std::uint64_t seq) {
+  if (!message.contains("sessionId") || !message["sessionId"].is_string()) {
+    SendError("bad_request", "sessionId가 필요합니다", seq);
+    return;
+  }
+  if ((message.contains("intervalTicks") && !message["intervalTicks"].is_number_integer()) ||
+      (message.contains("delayTicks") && !message["delayTicks"].is_number_integer())) {
+    SendError("bad_request", "필드 형식이 올바르지 않습니다", seq);
+    return;
+  }
+  SpectateOptions options;
+  options.interval_ticks = message.value("intervalTicks", 1);
+  options.delay_ticks = message.value("delayTicks", 0);
+  const auto session_id = message["sessionId"].get<std::string>();
+  if (!spectating_.empty() && spectating_ != session_id) {
+    session_manager_->Unspectate(spectating_, this);
+    spectating_.clear();
+  }
+  std::string error_code;
+  std::string error_message;
+  if (!session_manager_->Spectate(session_id, session_.user.user_id, shared_from_this(), options, error_code,
+                                  error_message)) {
+    SendError(error_code, error_message, seq);
+    return;
+  }
+  spectating_ = session_id;
+}
+
+void WebSocketSession::HandleSessionUnspectate(const nlohmann::json& message, std::uint64_t seq) {
+  if (!message.contains("sessionId") || !message["sessionId"].is_string()) {
+    SendError("bad_request", "sessionId가 필요합니다", seq);
+    return;
+  }
+  const auto session_id = message["sessionId"].get<std::string>();
+  if (session_id != spectating_) {
+    SendError("not_spectating", "관전 중인 세션이 아닙니다", seq);
+    return;
+  }
+  session_manager_->Unspectate(session_id, this);
+  spectating_.clear();
+  SendServerEvent("session.unspectated", {{"sessionId", session_id}, {"reason", "requested"}});
+}
+
 void WebSocketSession::SendError(std::string_view code, std::string_view message, std::uint64_t seq) {
   WsEnvelope env{.type = "error", .event = "", .seq = seq, .payload = {{"code", code}, {"message", message}}};
   EnqueueMessage(ToWsJson(env).dump());
@@ -177,6 +297,27 @@ void WebSocketSession::SendServerError(const std::string& code, const std::strin
   EnqueueMessage(ToWsJson(env).dump());
 }
 
+void WebSocketSession::SendServerFrame(SharedFrame frame) { EnqueueFrame(std::move(frame)); }
+
+bool WebSocketSession::SendSpectatorFrame(SharedFrame frame) {
+  if (closing_) {
+    return false;
+  }
+  bool kept_all = true;
+  // 전송 중인 맨 앞 프레임은 버릴 수 없으므로 대기 중인 프레임만 센다.
+  const std::size_t in_flight = writing_spectator_ ? 1 : 0;
+  if (spectator_queue_.size() - in_flight >= max_spectator_frames_) {
+    // 관전자는 최신 상태만 있으면 되므로 느린 연결에서는 오래된 틱을 건너뛴다.
+    spectator_queue_.erase(spectator_queue_.begin() + static_cast<std::ptrdiff_t>(in_flight));
+    kept_all = false;
+  }
+  spectator_queue_.push_back(std::move(frame));
+  if (!writing_) {
+    WriteNext();
+  }
+  return kept_all;
+}
+
 void WebSocketSession::SendResyncState(std::uint64_t seq) {
   WsEnvelope env{.type = "event",
                  .event = "resync_state",
@@ -197,15 +338,19 @@ void WebSocketSession::SendAuthState() {
 }
 
 void WebSocketSession::EnqueueMessage(std::string message) {
+  EnqueueFrame(std::make_shared<const std::string>(std::move(message)));
+}
+
+void WebSocketSession::EnqueueFrame(SharedFrame frame) {
   if (closing_) {
     return;
   }
-  const auto message_size = message.size();
+  const auto message_size = frame->size();
   if (send_queue_.size() >= max_queue_messages_ || queued_bytes_ + message_size > max_queue_bytes_) {
     TriggerBackpressureClose();
     return;
   }
-  send_queue_.push_back(std::move(message));
+  send_queue_.push_back(std::move(frame));
   queued_bytes_ += message_size;
   if (!writing_) {
     WriteNext();
@@ -213,27 +358,43 @@ void WebSocketSession::EnqueueMessage(std::string message) {
 }
 
 void WebSocketSession::WriteNext() {
-  if (send_queue_.empty() || closing_) {
+  if (closing_) {
+    return;
+  }
+  SharedFrame frame;
+  if (!send_queue_.empty()) {
+    frame = send_queue_.front();
+    writing_spectator_ = false;
+  } else if (!spectator_queue_.empty()) {
+    frame = spectator_queue_.front();
+    writing_spectator_ = true;
+  } else {
     return;
   }
   writing_ = true;
   auto self = shared_from_this();
   ws_.text(true);
-  ws_.async_write(boost::asio::buffer(send_queue_.front()),
-                  [self](boost::beast::error_code ec, std::size_t /*bytes_transferred*/) { self->OnWrite(ec); });
+  // 버퍼는 frame이 소유하므로 큐에서 먼저 빠지더라도 쓰기가 끝날 때까지 유지된다.
+  ws_.async_write(boost::asio::buffer(*frame),
+                  [self, frame](boost::beast::error_code ec, std::size_t /*bytes_transferred*/) { self->OnWrite(ec); });
 }
 
 void WebSocketSession::OnWrite(boost::beast::error_code ec) {
-  if (!send_queue_.empty()) {
-    queued_bytes_ -= send_queue_.front().size();
+  if (writing_spectator_) {
+    if (!spectator_queue_.empty()) {
+      spectator_queue_.pop_front();
+    }
+  } else if (!send_queue_.empty()) {
+    queued_bytes_ -= send_queue_.front()->size();
     send_queue_.pop_front();
   }
+  writing_spectator_ = false;
   if (ec) {
     closing_ = true;
     return;
   }
   writing_ = false;
-  if (!send_queue_.empty()) {
+  if (!send_queue_.empty() || !spectator_queue_.empty()) {
     WriteNext();
   }
 }
@@ -244,6 +405,7 @@ void WebSocketSession::TriggerBackpressureClose() {
   }
   closing_ = true;
   send_queue_.clear();
+  spectator_queue_.clear();
   queued_bytes_ = 0;
   boost::beast::websocket::close_reason reason{boost::beast::websocket::close_code::policy_error};
   reason.reason = "backpressure_exceeded";
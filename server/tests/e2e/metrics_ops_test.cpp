@@ -122,6 +122,13 @@ TEST_F(MetricsOpsFixture, MetricsAndOpsEndpoints) {
   ExpectSuccessEnvelope(first.body);
   EXPECT_TRUE(first.body["data"].contains("requests"));
   auto initial_total = first.body["data"]["requests"]["total"].get<std::uint64_t>();
+  ASSERT_TRUE(first.body["data"].contains("matchLifecycle"));
+  for (const auto* key : {"joinToPair", "pairToCreated", "createdToFirstTick", "queueToStart", "endToRatingApplied"}) {
+    ASSERT_TRUE(first.body["data"]["matchLifecycle"].contains(key)) << key;
+    EXPECT_TRUE(first.body["data"]["matchLifecycle"][key]["count"].is_number_unsigned());
+    EXPECT_TRUE(first.body["data"]["matchLifecycle"][key]["p95Ms"].is_number());
+    EXPECT_TRUE(first.body["data"]["matchLifecycle"][key]["buckets"].is_array());
+  }
 
   auto unauthorized_ops = Get("/ops/status");
   EXPECT_EQ(unauthorized_ops.status, boost::beast::http::status::unauthorized);
@@ -131,6 +138,35 @@ TEST_F(MetricsOpsFixture, MetricsAndOpsEndpoints) {
   ASSERT_EQ(authed_ops.status, boost::beast::http::status::ok);
   ExpectSuccessEnvelope(authed_ops.body);
   EXPECT_TRUE(authed_ops.body["data"].contains("activeSessions"));
+  EXPECT_EQ(authed_ops.body["data"]["queueLengths"]["normal"], authed_ops.body["data"]["queueLength"]);
+  EXPECT_TRUE(authed_ops.body["data"]["loopLagP95Ms"].is_number());
+  EXPECT_TRUE(authed_ops.body["data"]["workerUtilization"].is_number());
+
+  auto unauthorized_traces = Get("/ops/traces");
+  EXPECT_EQ(unauthorized_traces.status, boost::beast::http::status::unauthorized);
+  ExpectErrorEnvelope(unauthorized_traces.body, "unauthorized");
+
+  auto traces = Get("/ops/traces", "X-Ops-Token", config_.ops_token);
+  ASSERT_EQ(traces.status, boost::beast::http::status::ok);
+  ExpectSuccessEnvelope(traces.body);
+  EXPECT_TRUE(traces.body["data"]["traces"].is_array());
+
+  auto unauthorized_profile = Get("/ops/profile?seconds=1");
+  EXPECT_EQ(unauthorized_profile.status, boost::beast::http::status::unauthorized);
+  ExpectErrorEnvelope(unauthorized_profile.body, "unauthorized");
+
+  auto invalid_profile = Get("/ops/profile?seconds=0", "X-Ops-Token", config_.ops_token);
+  EXPECT_EQ(invalid_profile.status, boost::beast::http::status::bad_request);
+  ExpectErrorEnvelope(invalid_profile.body, "bad_request");
+
+  auto profile = Get("/ops/profile?seconds=1", "X-Ops-Token", config_.ops_token);
+  ASSERT_EQ(profile.status, boost::beast::http::status::ok);
+  ExpectSuccessEnvelope(profile.body);
+  EXPECT_EQ(profile.body["data"]["seconds"].get<std::uint64_t>(), 1u);
+  EXPECT_TRUE(profile.body["data"]["samples"].is_number_unsigned());
+  EXPECT_TRUE(profile.body["data"]["frequencyHz"].is_number_integer());
+  EXPECT_EQ(profile.body["data"]["format"], "folded");
+  EXPECT_TRUE(profile.body["data"]["folded"].is_string());
 
   auto health = Get("/api/health");
   ASSERT_EQ(health.status, boost::beast::http::status::ok);
@@ -141,4 +177,26 @@ TEST_F(MetricsOpsFixture, MetricsAndOpsEndpoints) {
   ExpectSuccessEnvelope(second.body);
   auto second_total = second.body["data"]["requests"]["total"].get<std::uint64_t>();
   EXPECT_GE(second_total, initial_total + 2);
+
+  EXPECT_EQ(second.body["data"]["sessions"]["degraded"], 0);
+
+  const auto& rollback = second.body["data"]["rollback"];
+  EXPECT_EQ(rollback["corrections"], 0);
+  EXPECT_EQ(rollback["resimulatedTicks"], 0);
+  EXPECT_TRUE(rollback["latency"].contains("p95Ms"));
+
+  const auto& event_loop = second.body["data"]["eventLoop"];
+  EXPECT_TRUE(event_loop["lastLagMs"].is_number());
+  EXPECT_GT(event_loop["lag"]["count"].get<std::uint64_t>(), 0u);
+  ASSERT_TRUE(event_loop["workers"].is_array());
+  ASSERT_FALSE(event_loop["workers"].empty());
+  std::uint64_t handlers = 0;
+  for (const auto& worker : event_loop["workers"]) {
+    EXPECT_TRUE(worker["index"].is_number_integer());
+    EXPECT_TRUE(worker["busyMs"].is_number());
+    EXPECT_TRUE(worker["idleMs"].is_number());
+    EXPECT_TRUE(worker["utilization"].is_number());
+    handlers += worker["handlers"].get<std::uint64_t>();
+  }
+  EXPECT_GT(handlers, 0u);
 }
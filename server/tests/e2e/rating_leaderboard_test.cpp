@@ -17,6 +17,7 @@
 
 #include "server/api_response.hpp"
 #include "server/app.hpp"
+#include "server/input_journal.hpp"
 #include "server/result_service.hpp"
 #include "server/session_manager.hpp"
 
@@ -268,6 +269,14 @@ TEST_F(RatingLeaderboardFixture, DuplicateFinalizeDoesNotDoubleApplyRating) {
 
   ASSERT_TRUE(record.has_value());
 
+  // 저장된 입력 저널을 재생하면 같은 최종 스냅샷이 나와야 한다.
+  server::Simulation replayed;
+  auto replay = server::ReplayJournal(record->input_journal, replayed);
+  ASSERT_TRUE(replay.ok) << replay.error;
+  EXPECT_GE(replay.inputs, 1u);
+  EXPECT_EQ(replay.final_tick, record->tick_count);
+  EXPECT_EQ(replayed.Snapshot(), record->snapshot);
+
   auto profile_a = Get("/api/profile", token_a);
   auto profile_b = Get("/api/profile", token_b);
   ASSERT_EQ(profile_a.status, boost::beast::http::status::ok);
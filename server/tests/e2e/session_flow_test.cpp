@@ -1,5 +1,8 @@
+#include <algorithm>
 #include <chrono>
+#include <string>
 #include <thread>
+#include <vector>
 
 #include <boost/asio/connect.hpp>
 #include <boost/asio/io_context.hpp>
@@ -43,6 +46,7 @@ server::AppConfig TestConfig(unsigned short port) {
 struct SimpleHttpResponse {
   boost::beast::http::status status;
   nlohmann::json body;
+  std::string retry_after;
 };
 
 void ExpectSuccessEnvelope(const nlohmann::json& body) {
@@ -90,8 +94,10 @@ void ExpectWsError(const nlohmann::json& msg, const std::string& code) {
 
 class SessionFlowFixture : public ::testing::Test {
  protected:
-  void SetUp() override {
-    config_ = TestConfig(18082);
+  void SetUp() override { StartApp(TestConfig(18082)); }
+
+  void StartApp(const server::AppConfig& config) {
+    config_ = config;
     app_ = std::make_unique<server::ServerApp>(config_);
     server_thread_ = std::thread([this]() { app_->Run(); });
     std::this_thread::sleep_for(std::chrono::milliseconds(400));
@@ -127,7 +133,8 @@ class SessionFlowFixture : public ::testing::Test {
     boost::beast::http::response<boost::beast::http::string_body> res;
     boost::beast::http::read(stream, buffer, res);
 
-    SimpleHttpResponse result{res.result(), nlohmann::json::parse(res.body())};
+    SimpleHttpResponse result{res.result(), nlohmann::json::parse(res.body()),
+                              std::string(res[boost::beast::http::field::retry_after])};
     boost::beast::error_code ec;
     stream.socket().shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
     return result;
@@ -153,7 +160,8 @@ class SessionFlowFixture : public ::testing::Test {
     boost::beast::http::response<boost::beast::http::string_body> res;
     boost::beast::http::read(stream, buffer, res);
 
-    SimpleHttpResponse result{res.result(), nlohmann::json::parse(res.body())};
+    SimpleHttpResponse result{res.result(), nlohmann::json::parse(res.body()),
+                              std::string(res[boost::beast::http::field::retry_after])};
     boost::beast::error_code ec;
     stream.socket().shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
     return result;
@@ -194,6 +202,78 @@ class SessionFlowFixture : public ::testing::Test {
   std::thread server_thread_;
 };
 
+class HashOnlySessionFixture : public SessionFlowFixture {
+ protected:
+  void SetUp() override {
+    auto config = TestConfig(18082);
+    config.session_tick_interval_ms = 100;
+    config.session_full_state_every = 3;
+    StartApp(config);
+  }
+};
+
+class InterestFilteredSessionFixture : public SessionFlowFixture {
+ protected:
+  void SetUp() override {
+    auto config = TestConfig(18082);
+    config.session_tick_interval_ms = 100;
+    config.match_session_size = 3;
+    config.session_interest_radius = 5;
+    StartApp(config);
+  }
+};
+
+class AdmissionLimitedSessionFixture : public SessionFlowFixture {
+ protected:
+  void SetUp() override {
+    auto config = TestConfig(18082);
+    config.session_tick_interval_ms = 300;
+    config.admission_max_sessions = 1;
+    config.admission_retry_after_seconds = 2;
+    StartApp(config);
+  }
+};
+
+class SpectatedSessionFixture : public SessionFlowFixture {
+ protected:
+  void SetUp() override {
+    auto config = TestConfig(18082);
+    config.session_tick_interval_ms = 200;
+    config.session_full_state_every = 3;
+    config.spectator_max_delay_ticks = 2;
+    StartApp(config);
+  }
+};
+
+class QueueLatencyFixture : public SessionFlowFixture {
+ protected:
+  void SetUp() override {
+    auto config = TestConfig(18082);
+    config.login_rate_limit_max = 20;
+    config.match_queue_timeout_seconds = 60;
+    StartApp(config);
+  }
+};
+
+// ranked는 2인, casual은 8인 세션이라 casual 대기자는 쉽게 모이지 않는다.
+class ModeQueuesFixture : public SessionFlowFixture {
+ protected:
+  void SetUp() override {
+    auto config = TestConfig(18082);
+    config.login_rate_limit_max = 20;
+    server::MatchModeConfig ranked;
+    ranked.name = "ranked";
+    ranked.queue_timeout_seconds = 5;
+    ranked.session_size = 2;
+    server::MatchModeConfig casual;
+    casual.name = "casual";
+    casual.queue_timeout_seconds = 7;
+    casual.session_size = 8;
+    config.match_modes = {ranked, casual};
+    StartApp(config);
+  }
+};
+
 TEST_F(SessionFlowFixture, MatchAndPersistResult) {
   std::string token_a = RegisterAndLogin("alice", "pw1");
   std::string token_b = RegisterAndLogin("bob", "pw2");
@@ -252,8 +332,13 @@ TEST_F(SessionFlowFixture, MatchAndPersistResult) {
   ws_b->write(boost::asio::buffer(input_b.dump()));
 
   bool ended = false;
+  bool saw_state = false;
   for (int i = 0; i < 12 && !ended; ++i) {
     auto msg = ReadWs(*ws_a, buf_a);
+    if (msg.contains("event") && msg["event"] == "session.state") {
+      saw_state = true;
+      EXPECT_EQ(msg["p"]["tickIntervalMs"], config_.session_tick_interval_ms);
+    }
     if (msg.contains("event") && msg["event"] == "session.ended") {
       ExpectWsEventEnvelope(msg, "session.ended");
       ended = true;
@@ -261,6 +346,7 @@ TEST_F(SessionFlowFixture, MatchAndPersistResult) {
       EXPECT_TRUE(msg["p"].contains("result"));
     }
   }
+  EXPECT_TRUE(saw_state);
 
   std::this_thread::sleep_for(std::chrono::milliseconds(200));
   EXPECT_EQ(app_->DebugResultCount(), 1);
@@ -360,4 +446,415 @@ TEST_F(SessionFlowFixture, LateInputAfterEndIsRejected) {
   EXPECT_EQ(app_->DebugResultCount(), 1);
 }
 
+TEST_F(HashOnlySessionFixture, SendsHashFramesAndResyncsOnDesyncReport) {
+  std::string token_a = RegisterAndLogin("hashA", "pw1");
+  std::string token_b = RegisterAndLogin("hashB", "pw2");
+
+  auto ws_a = ConnectWs(token_a);
+  auto ws_b = ConnectWs(token_b);
+  boost::beast::flat_buffer buf_a;
+  boost::beast::flat_buffer buf_b;
+  ExpectWsEventEnvelope(ReadWs(*ws_a, buf_a), "auth_state");
+  ExpectWsEventEnvelope(ReadWs(*ws_b, buf_b), "auth_state");
+
+  ASSERT_EQ(PostJson("/api/queue/join", {{"mode", "normal"}}, token_a).status, boost::beast::http::status::ok);
+  ASSERT_EQ(PostJson("/api/queue/join", {{"mode", "normal"}}, token_b).status, boost::beast::http::status::ok);
+
+  // 첫 틱은 전체 상태, 다음 틱(2)은 3틱 주기가 아니므로 해시만 온다.
+  std::string session_id;
+  nlohmann::json hash_frame;
+  bool saw_first_state = false;
+  for (int i = 0; i < 12 && hash_frame.is_null(); ++i) {
+    auto msg = ReadWs(*ws_a, buf_a);
+    if (!msg.contains("event")) {
+      continue;
+    }
+    if (msg["event"] == "session.created") {
+      session_id = msg["p"]["sessionId"].get<std::string>();
+    }
+    if (msg["event"] == "session.state") {
+      EXPECT_EQ(msg["p"]["tick"], 1);
+      ASSERT_TRUE(msg["p"]["stateHash"].is_string());
+      EXPECT_EQ(msg["p"]["stateHash"].get<std::string>().size(), 16u);
+      saw_first_state = true;
+    }
+    if (msg["event"] == "session.hash") {
+      ExpectWsEventEnvelope(msg, "session.hash");
+      hash_frame = msg["p"];
+    }
+  }
+  ASSERT_FALSE(session_id.empty());
+  ASSERT_TRUE(saw_first_state);
+  ASSERT_FALSE(hash_frame.is_null());
+  EXPECT_EQ(hash_frame["tick"], 2);
+  EXPECT_FALSE(hash_frame.contains("players"));
+
+  // 일치하는 해시 보고는 집계만 되고, 다른 해시 보고는 확인된 desync로 집계된다. 둘 다 전체 상태를 다시 받는다.
+  nlohmann::json matching{{"t", "event"},
+                          {"seq", 7},
+                          {"event", "session.desync"},
+                          {"p", {{"sessionId", session_id}, {"tick", 2}, {"stateHash", hash_frame["stateHash"]}}}};
+  ws_a->write(boost::asio::buffer(matching.dump()));
+  nlohmann::json mismatching{{"t", "event"},
+                             {"seq", 8},
+                             {"event", "session.desync"},
+                             {"p", {{"sessionId", session_id}, {"tick", 2}, {"stateHash", "00000000deadbeef"}}}};
+  ws_a->write(boost::asio::buffer(mismatching.dump()));
+  nlohmann::json malformed{{"t", "event"},
+                           {"seq", 9},
+                           {"event", "session.desync"},
+                           {"p", {{"sessionId", session_id}, {"tick", 2}, {"stateHash", "not-hex"}}}};
+  ws_a->write(boost::asio::buffer(malformed.dump()));
+
+  int resync_states = 0;
+  bool saw_bad_request = false;
+  bool ended = false;
+  for (int i = 0; i < 16 && !ended; ++i) {
+    auto msg = ReadWs(*ws_a, buf_a);
+    if (msg["t"] == "error") {
+      ExpectWsError(msg, "bad_request");
+      EXPECT_EQ(msg["seq"], 9);
+      saw_bad_request = true;
+    } else if (msg["event"] == "session.state") {
+      ++resync_states;
+    } else if (msg["event"] == "session.ended") {
+      ended = true;
+    }
+  }
+  EXPECT_TRUE(ended);
+  EXPECT_TRUE(saw_bad_request);
+  // 두 번의 보고 응답 + 틱 3의 주기적 전체 상태.
+  EXPECT_GE(resync_states, 3);
+
+  auto metrics = Get("/metrics");
+  ExpectSuccessEnvelope(metrics.body);
+  const auto& sync = metrics.body["data"]["stateSync"];
+  EXPECT_EQ(sync["desyncReports"], 2);
+  EXPECT_EQ(sync["desyncConfirmed"], 1);
+  EXPECT_GE(sync["hashFrames"].get<int>(), 2);
+  EXPECT_GE(sync["fullFrames"].get<int>(), 2);
+  // 세션 틱은 레인 패스로 진행되며, 끝난 세션의 틱 수만큼 세션 진행이 기록된다.
+  const auto& batch = metrics.body["data"]["tickBatch"];
+  EXPECT_GE(batch["passes"].get<int>(), 1);
+  EXPECT_GE(batch["sessions"].get<int>(), 5);
+  EXPECT_TRUE(batch["stepLatency"].contains("p95Ms"));
+  EXPECT_TRUE(batch["passLatency"].contains("p95Ms"));
+}
+
+TEST_F(InterestFilteredSessionFixture, ThreePlayerSessionFiltersStateAndRanksAll) {
+  const std::vector<std::string> names{"trioA", "trioB", "trioC"};
+  std::vector<std::string> tokens;
+  std::vector<std::unique_ptr<WebSocket>> sockets;
+  std::vector<boost::beast::flat_buffer> buffers(names.size());
+  std::vector<int> user_ids;
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    tokens.push_back(RegisterAndLogin(names[i], "pw"));
+    sockets.push_back(ConnectWs(tokens[i]));
+    auto auth = ReadWs(*sockets[i], buffers[i]);
+    ExpectWsEventEnvelope(auth, "auth_state");
+    user_ids.push_back(auth["p"]["userId"].get<int>());
+  }
+  // 두 명만으로는 세션이 만들어지지 않고 세 번째 입장 후 한 세션으로 묶인다.
+  for (const auto& token : tokens) {
+    ASSERT_EQ(PostJson("/api/queue/join", {{"mode", "normal"}}, token).status, boost::beast::http::status::ok);
+  }
+
+  std::string session_id;
+  for (std::size_t i = 0; i < sockets.size(); ++i) {
+    for (int attempt = 0; attempt < 4; ++attempt) {
+      auto msg = ReadWs(*sockets[i], buffers[i]);
+      if (msg["event"] == "session.created") {
+        EXPECT_EQ(msg["p"]["participants"].size(), 3u);
+        session_id = msg["p"]["sessionId"].get<std::string>();
+      }
+      if (msg["event"] == "session.started") {
+        break;
+      }
+    }
+  }
+  ASSERT_FALSE(session_id.empty());
+
+  // 세 번째 참가자만 틱 2에 +12 이동해 반경 5 밖으로 벗어난다.
+  for (std::uint64_t seq = 1; seq <= 4; ++seq) {
+    nlohmann::json input{{"t", "event"},
+                         {"seq", seq},
+                         {"event", "session.input"},
+                         {"p", {{"sessionId", session_id}, {"sequence", seq}, {"targetTick", 2}, {"delta", 3}}}};
+    sockets[2]->write(boost::asio::buffer(input.dump()));
+  }
+
+  auto player_ids = [](const nlohmann::json& state) {
+    std::vector<int> ids;
+    for (const auto& player : state["p"]["players"]) {
+      ids.push_back(player["userId"].get<int>());
+    }
+    return ids;
+  };
+  std::vector<std::vector<int>> last_state(sockets.size());
+  nlohmann::json ended;
+  for (std::size_t i = 0; i < sockets.size(); ++i) {
+    for (int attempt = 0; attempt < 10; ++attempt) {
+      auto msg = ReadWs(*sockets[i], buffers[i]);
+      if (msg["event"] == "session.state") {
+        last_state[i] = player_ids(msg);
+      }
+      if (msg["event"] == "session.ended") {
+        ended = msg;
+        break;
+      }
+    }
+  }
+  EXPECT_EQ(last_state[0], (std::vector<int>{user_ids[0], user_ids[1]}));
+  EXPECT_EQ(last_state[1], (std::vector<int>{user_ids[0], user_ids[1]}));
+  EXPECT_EQ(last_state[2], (std::vector<int>{user_ids[2]}));
+
+  ASSERT_FALSE(ended.is_null());
+  EXPECT_EQ(ended["p"]["result"]["winnerUserId"], user_ids[2]);
+  EXPECT_EQ(ended["p"]["result"]["ranking"], (std::vector<int>{user_ids[2], user_ids[0], user_ids[1]}));
+
+  for (int i = 0; i < 10 && app_->DebugResultCount() < 1; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  EXPECT_EQ(app_->DebugResultCount(), 1);
+  auto metrics = Get("/metrics");
+  const auto& fanout = metrics.body["data"]["fanout"];
+  EXPECT_EQ(fanout["frames"].get<int>() % 3, 0);
+  EXPECT_LT(fanout["playersPerFrame"].get<double>(), 3.0);
+}
+
+
+TEST_F(AdmissionLimitedSessionFixture, JoinsAreRefusedWhileNodeIsAtCapacity) {
+  std::string token_a = RegisterAndLogin("cap_a", "pw1");
+  std::string token_b = RegisterAndLogin("cap_b", "pw2");
+  std::string token_c = RegisterAndLogin("cap_c", "pw3");
+  auto ws_a = ConnectWs(token_a);
+  boost::beast::flat_buffer buf_a;
+  ExpectWsEventEnvelope(ReadWs(*ws_a, buf_a), "auth_state");
+
+  EXPECT_EQ(PostJson("/api/queue/join", {{"mode", "normal"}}, token_a).status, boost::beast::http::status::ok);
+  EXPECT_EQ(PostJson("/api/queue/join", {{"mode", "normal"}}, token_b).status, boost::beast::http::status::ok);
+  bool started = false;
+  for (int i = 0; i < 4 && !started; ++i) {
+    auto msg = ReadWs(*ws_a, buf_a);
+    started = msg.contains("event") && msg["event"] == "session.started";
+  }
+  ASSERT_TRUE(started);
+
+  // 세션 한도(1)가 찼으므로 새 입장은 진행 중인 매치를 늦추지 않도록 거절된다.
+  auto refused = PostJson("/api/queue/join", {{"mode", "normal"}}, token_c);
+  EXPECT_EQ(refused.status, boost::beast::http::status::service_unavailable);
+  ExpectErrorEnvelope(refused.body, "server_overloaded");
+  EXPECT_EQ(refused.retry_after, "2");
+
+  auto metrics = Get("/metrics");
+  ExpectSuccessEnvelope(metrics.body);
+  EXPECT_EQ(metrics.body["data"]["admission"]["rejected"]["sessions"], 1);
+
+  // 매치가 끝나면 다시 받는다.
+  bool ended = false;
+  for (int i = 0; i < 12 && !ended; ++i) {
+    auto msg = ReadWs(*ws_a, buf_a);
+    ended = msg.contains("event") && msg["event"] == "session.ended";
+  }
+  ASSERT_TRUE(ended);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(PostJson("/api/queue/join", {{"mode", "normal"}}, token_c).status, boost::beast::http::status::ok);
+}
+
 }  // namespace
+
+TEST_F(SpectatedSessionFixture, SpectatorsReceiveSharedStateWithIntervalAndDelay) {
+  std::string token_a = RegisterAndLogin("specA", "pw1");
+  std::string token_b = RegisterAndLogin("specB", "pw2");
+  std::string token_c = RegisterAndLogin("specC", "pw3");
+  std::string token_d = RegisterAndLogin("specD", "pw4");
+
+  auto ws_a = ConnectWs(token_a);
+  auto ws_b = ConnectWs(token_b);
+  auto ws_c = ConnectWs(token_c);
+  auto ws_d = ConnectWs(token_d);
+  boost::beast::flat_buffer buf_a;
+  boost::beast::flat_buffer buf_b;
+  boost::beast::flat_buffer buf_c;
+  boost::beast::flat_buffer buf_d;
+  ExpectWsEventEnvelope(ReadWs(*ws_a, buf_a), "auth_state");
+  ExpectWsEventEnvelope(ReadWs(*ws_b, buf_b), "auth_state");
+  ExpectWsEventEnvelope(ReadWs(*ws_c, buf_c), "auth_state");
+  ExpectWsEventEnvelope(ReadWs(*ws_d, buf_d), "auth_state");
+
+  ASSERT_EQ(PostJson("/api/queue/join", {{"mode", "normal"}}, token_a).status, boost::beast::http::status::ok);
+  ASSERT_EQ(PostJson("/api/queue/join", {{"mode", "normal"}}, token_b).status, boost::beast::http::status::ok);
+
+  std::string session_id;
+  for (int i = 0; i < 4 && session_id.empty(); ++i) {
+    auto msg = ReadWs(*ws_a, buf_a);
+    if (msg.contains("event") && msg["event"] == "session.created") {
+      session_id = msg["p"]["sessionId"].get<std::string>();
+    }
+  }
+  ASSERT_FALSE(session_id.empty());
+
+  auto spectate = [&session_id](std::uint64_t seq, nlohmann::json options) {
+    options["sessionId"] = session_id;
+    return nlohmann::json{{"t", "event"}, {"seq", seq}, {"event", "session.spectate"}, {"p", std::move(options)}};
+  };
+  ws_c->write(boost::asio::buffer(spectate(1, nlohmann::json::object()).dump()));
+  ws_d->write(boost::asio::buffer(spectate(1, {{"intervalTicks", 2}, {"delayTicks", 1}}).dump()));
+  // 참가자 자신은 관전할 수 없고, 허용 범위를 넘는 지연은 거절한다.
+  ws_a->write(boost::asio::buffer(spectate(5, nlohmann::json::object()).dump()));
+  auto too_late = nlohmann::json{{"t", "event"},
+                                 {"seq", 6},
+                                 {"event", "session.spectate"},
+                                 {"p", {{"sessionId", session_id}, {"delayTicks", 3}}}};
+  ws_b->write(boost::asio::buffer(too_late.dump()));
+
+  auto spectating_c = ReadWs(*ws_c, buf_c);
+  ExpectWsEventEnvelope(spectating_c, "session.spectating");
+  EXPECT_EQ(spectating_c["p"]["sessionId"], session_id);
+  EXPECT_EQ(spectating_c["p"]["intervalTicks"], 1);
+  auto spectating_d = ReadWs(*ws_d, buf_d);
+  ExpectWsEventEnvelope(spectating_d, "session.spectating");
+  EXPECT_EQ(spectating_d["p"]["delayTicks"], 1);
+
+  // 기본 관전자는 해시 전용 틱(2)을 포함해 매 틱 두 플레이어가 모두 담긴 전체 상태를 받고, 같은 종료 이벤트로 끝난다.
+  std::vector<int> ticks_c;
+  bool ended_c = false;
+  for (int i = 0; i < 10 && !ended_c; ++i) {
+    auto msg = ReadWs(*ws_c, buf_c);
+    ASSERT_TRUE(msg.contains("event"));
+    if (msg["event"] == "session.state") {
+      EXPECT_EQ(msg["p"]["players"].size(), 2u);
+      ticks_c.push_back(msg["p"]["tick"].get<int>());
+    } else if (msg["event"] == "session.ended") {
+      EXPECT_EQ(msg["p"]["sessionId"], session_id);
+      ended_c = true;
+    }
+  }
+  EXPECT_TRUE(ended_c);
+  ASSERT_GE(ticks_c.size(), 3u);
+  EXPECT_EQ(ticks_c.back(), 5);
+  for (std::size_t i = 1; i < ticks_c.size(); ++i) {
+    EXPECT_EQ(ticks_c[i], ticks_c[i - 1] + 1);
+  }
+  EXPECT_NE(std::find(ticks_c.begin(), ticks_c.end(), 2), ticks_c.end());
+
+  // 2틱마다, 1틱 늦은 상태: 틱 3과 5에 각각 틱 2와 4의 프레임을 받는다.
+  std::vector<int> ticks_d;
+  bool ended_d = false;
+  for (int i = 0; i < 10 && !ended_d; ++i) {
+    auto msg = ReadWs(*ws_d, buf_d);
+    ASSERT_TRUE(msg.contains("event"));
+    if (msg["event"] == "session.state") {
+      ticks_d.push_back(msg["p"]["tick"].get<int>());
+    } else if (msg["event"] == "session.ended") {
+      ended_d = true;
+    }
+  }
+  EXPECT_TRUE(ended_d);
+  EXPECT_EQ(ticks_d, (std::vector<int>{2, 4}));
+
+  bool saw_participant_error = false;
+  for (int i = 0; i < 12 && !saw_participant_error; ++i) {
+    auto msg = ReadWs(*ws_a, buf_a);
+    if (msg["t"] == "error") {
+      ExpectWsError(msg, "already_participant");
+      EXPECT_EQ(msg["seq"], 5);
+      saw_participant_error = true;
+    }
+  }
+  EXPECT_TRUE(saw_participant_error);
+  bool saw_delay_error = false;
+  for (int i = 0; i < 12 && !saw_delay_error; ++i) {
+    auto msg = ReadWs(*ws_b, buf_b);
+    if (msg["t"] == "error") {
+      ExpectWsError(msg, "bad_request");
+      EXPECT_EQ(msg["seq"], 6);
+      saw_delay_error = true;
+    }
+  }
+  EXPECT_TRUE(saw_delay_error);
+
+  auto metrics = Get("/metrics");
+  ExpectSuccessEnvelope(metrics.body);
+  const auto& spectators = metrics.body["data"]["spectators"];
+  EXPECT_EQ(spectators["active"], 0);
+  EXPECT_EQ(spectators["frames"].get<std::size_t>(), ticks_c.size() + ticks_d.size());
+  EXPECT_EQ(spectators["dropped"], 0);
+}
+
+TEST_F(QueueLatencyFixture, PairsAsSoonAsPartnerJoins) {
+  // 두 번째 입장 응답이 돌아온 시점에 이미 매치가 만들어져 있어야 한다. matchmaker는 입장 명령을 처리한 뒤에야
+  // 응답을 보내고 같은 스레드에서 재확인을 돌리므로, 이 사이에 재확인이 끼어들 수 없다. 타임아웃도 길게 두어
+  // 입장 시 페어링 말고는 결과를 설명할 수 있는 경로가 없다.
+  constexpr int kPairs = 6;
+  std::vector<std::string> tokens;
+  for (int i = 0; i < kPairs * 2; ++i) {
+    tokens.push_back(RegisterAndLogin("fast" + std::to_string(i), "pw"));
+  }
+  auto normal_queue = [this]() {
+    auto metrics = Get("/metrics");
+    ExpectSuccessEnvelope(metrics.body);
+    return metrics.body["data"]["queue"]["modes"]["normal"];
+  };
+  for (int pair = 0; pair < kPairs; ++pair) {
+    ASSERT_EQ(PostJson("/api/queue/join", {{"mode", "normal"}}, tokens[pair * 2]).status,
+              boost::beast::http::status::ok);
+    auto waiting = normal_queue();
+    EXPECT_EQ(waiting["length"], 1);
+    EXPECT_EQ(waiting["matches"], pair);
+
+    ASSERT_EQ(PostJson("/api/queue/join", {{"mode", "normal"}}, tokens[pair * 2 + 1]).status,
+              boost::beast::http::status::ok);
+    auto paired = normal_queue();
+    EXPECT_EQ(paired["length"], 0);
+    EXPECT_EQ(paired["matches"], pair + 1);
+  }
+
+  // 입장 명령은 모두 matchmaker 스레드가 꺼내 처리했다.
+  auto metrics = Get("/metrics");
+  ExpectSuccessEnvelope(metrics.body);
+  const auto& matchmaking = metrics.body["data"]["matchmaking"];
+  EXPECT_EQ(matchmaking["pendingCommands"], 0);
+  EXPECT_EQ(matchmaking["commandLag"]["count"], kPairs * 2);
+  EXPECT_EQ(metrics.body["data"]["queue"]["modes"]["normal"]["wait"]["count"], kPairs * 2);
+}
+
+TEST_F(ModeQueuesFixture, ModesQueueIndependentlyAndUserStaysInOneMode) {
+  // 등록되지 않은 모드는 거절한다.
+  std::string token_a = RegisterAndLogin("ranked_a", "pw");
+  auto unknown = PostJson("/api/queue/join", {{"mode", "normal"}}, token_a);
+  EXPECT_EQ(unknown.status, boost::beast::http::status::bad_request);
+
+  // casual에 다섯 명이 몰려 있어도 ranked 두 명은 바로 묶인다.
+  std::vector<std::string> casual_tokens;
+  for (int i = 0; i < 5; ++i) {
+    casual_tokens.push_back(RegisterAndLogin("casual_" + std::to_string(i), "pw"));
+    auto join = PostJson("/api/queue/join", {{"mode", "casual"}}, casual_tokens.back());
+    ASSERT_EQ(join.status, boost::beast::http::status::ok);
+    EXPECT_EQ(join.body["data"]["mode"], "casual");
+  }
+  std::string token_b = RegisterAndLogin("ranked_b", "pw");
+  ASSERT_EQ(PostJson("/api/queue/join", {{"mode", "ranked"}}, token_a).status, boost::beast::http::status::ok);
+  // 한 사용자는 한 모드 큐에만 들어간다.
+  auto other_mode = PostJson("/api/queue/join", {{"mode", "casual"}}, token_a);
+  EXPECT_EQ(other_mode.status, boost::beast::http::status::conflict);
+  ExpectErrorEnvelope(other_mode.body, "queue_duplicate");
+  ASSERT_EQ(PostJson("/api/queue/join", {{"mode", "ranked"}}, token_b).status, boost::beast::http::status::ok);
+
+  // 취소는 사용자가 대기 중인 모드 큐로 간다.
+  EXPECT_EQ(PostJson("/api/queue/cancel", nlohmann::json::object(), casual_tokens[0]).status,
+            boost::beast::http::status::ok);
+  auto cancel_again = PostJson("/api/queue/cancel", nlohmann::json::object(), casual_tokens[0]);
+  EXPECT_EQ(cancel_again.status, boost::beast::http::status::not_found);
+  ExpectErrorEnvelope(cancel_again.body, "queue_not_found");
+
+  auto metrics = Get("/metrics");
+  ExpectSuccessEnvelope(metrics.body);
+  const auto& queue = metrics.body["data"]["queue"];
+  EXPECT_EQ(queue["length"], 4);
+  EXPECT_EQ(queue["modes"]["casual"]["length"], 4);
+  EXPECT_EQ(queue["modes"]["casual"]["matches"], 0);
+  EXPECT_EQ(queue["modes"]["ranked"]["length"], 0);
+  EXPECT_EQ(queue["modes"]["ranked"]["matches"], 1);
+  EXPECT_EQ(queue["modes"]["ranked"]["wait"]["count"], 2);
+}
@@ -0,0 +1,462 @@
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core/buffers_to_string.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/core/tcp_stream.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/version.hpp>
+#include <boost/beast/websocket.hpp>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include "server/app.hpp"
+#include "server/input_journal.hpp"
+#include "server/session_migration.hpp"
+#include "server/simulation.hpp"
+
+namespace {
+
+server::AppConfig TestConfig(unsigned short port) {
+  server::AppConfig cfg{};
+  cfg.port = port;
+  cfg.db_host = "localhost";
+  cfg.db_port = 3306;
+  cfg.db_user = "app";
+  cfg.db_password = "app_pass";
+  cfg.db_name = "app_db";
+  cfg.redis_host = "localhost";
+  cfg.redis_port = 6379;
+  cfg.log_level = "info";
+  cfg.auth_token_ttl_seconds = 3600;
+  cfg.login_rate_window_seconds = 60;
+  cfg.login_rate_limit_max = 5;
+  cfg.ws_queue_limit_messages = 8;
+  cfg.ws_queue_limit_bytes = 65536;
+  cfg.match_queue_timeout_seconds = 5;
+  // 이전 요청이 다음 틱 전에 끝나도록 틱 간격을 넉넉히 둔다.
+  cfg.session_tick_interval_ms = 300;
+  cfg.ops_token = "ops-token";
+  cfg.migration_token = "migration-token";
+  return cfg;
+}
+
+constexpr unsigned short kSourcePort = 18085;
+constexpr unsigned short kTargetPort = 18086;
+constexpr unsigned short kTargetMigrationPort = 18087;
+
+struct SimpleHttpResponse {
+  boost::beast::http::status status;
+  nlohmann::json body;
+};
+
+// 같은 프로세스에서 서버 두 개(원본 A, 대상 B)를 띄우고 실제 로컬 TCP로 세션을 옮긴다.
+class SessionMigrationFixture : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    source_ = std::make_unique<server::ServerApp>(TestConfig(kSourcePort));
+    auto target_config = TestConfig(kTargetPort);
+    target_config.migration_port = kTargetMigrationPort;
+    target_config.migration_resume_timeout_ms = 2000;
+    target_ = std::make_unique<server::ServerApp>(target_config);
+    source_thread_ = std::thread([this]() { source_->Run(); });
+    target_thread_ = std::thread([this]() { target_->Run(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+  }
+
+  void TearDown() override {
+    source_->Stop();
+    target_->Stop();
+    if (source_thread_.joinable()) {
+      source_thread_.join();
+    }
+    if (target_thread_.joinable()) {
+      target_thread_.join();
+    }
+  }
+
+  SimpleHttpResponse Request(unsigned short port, boost::beast::http::verb verb, const std::string& target,
+                             const nlohmann::json& body, const std::string& token = "",
+                             const std::string& ops_token = "") {
+    boost::asio::io_context ioc;
+    boost::asio::ip::tcp::resolver resolver{ioc};
+    boost::beast::tcp_stream stream{ioc};
+    auto const results = resolver.resolve("127.0.0.1", std::to_string(port));
+    stream.connect(results);
+
+    boost::beast::http::request<boost::beast::http::string_body> req{verb, target, 11};
+    req.set(boost::beast::http::field::host, "localhost");
+    req.set(boost::beast::http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+    if (verb == boost::beast::http::verb::post) {
+      req.set(boost::beast::http::field::content_type, "application/json");
+      req.body() = body.dump();
+    }
+    req.prepare_payload();
+    if (!token.empty()) {
+      req.set(boost::beast::http::field::authorization, "Bearer " + token);
+    }
+    if (!ops_token.empty()) {
+      req.set("X-Ops-Token", ops_token);
+    }
+
+    boost::beast::http::write(stream, req);
+
+    boost::beast::flat_buffer buffer;
+    boost::beast::http::response<boost::beast::http::string_body> res;
+    boost::beast::http::read(stream, buffer, res);
+
+    SimpleHttpResponse result{res.result(), nlohmann::json::parse(res.body())};
+    boost::beast::error_code ec;
+    stream.socket().shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+    return result;
+  }
+
+  // 이전 수신기에 요청 한 줄을 보내고 응답 한 줄을 받는다.
+  nlohmann::json SendMigrationLine(unsigned short port, const nlohmann::json& request) {
+    boost::asio::io_context ioc;
+    boost::asio::ip::tcp::socket socket{ioc};
+    socket.connect({boost::asio::ip::address_v4::loopback(), port});
+    boost::asio::write(socket, boost::asio::buffer(request.dump() + "\n"));
+    std::string line;
+    boost::asio::read_until(socket, boost::asio::dynamic_buffer(line), '\n');
+    return nlohmann::json::parse(line);
+  }
+
+  std::string RegisterAndLogin(const std::string& username, const std::string& password) {
+    using boost::beast::http::verb;
+    Request(kSourcePort, verb::post, "/api/auth/register", {{"username", username}, {"password", password}});
+    auto login = Request(kSourcePort, verb::post, "/api/auth/login", {{"username", username}, {"password", password}});
+    return login.body["data"]["token"].get<std::string>();
+  }
+
+  using WebSocket = boost::beast::websocket::stream<boost::beast::tcp_stream>;
+
+  std::unique_ptr<WebSocket> ConnectWs(unsigned short port, const std::string& token) {
+    auto ws = std::make_unique<WebSocket>(ioc_);
+    boost::asio::ip::tcp::resolver resolver{ioc_};
+    auto const results = resolver.resolve("127.0.0.1", std::to_string(port));
+    ws->next_layer().connect(results);
+    ws->set_option(boost::beast::websocket::stream_base::decorator([&token](boost::beast::websocket::request_type& req) {
+      req.set(boost::beast::http::field::authorization, "Bearer " + token);
+    }));
+    ws->handshake("127.0.0.1", "/ws");
+    return ws;
+  }
+
+  nlohmann::json ReadWs(WebSocket& ws, boost::beast::flat_buffer& buffer) {
+    buffer.consume(buffer.size());
+    ws.read(buffer);
+    return nlohmann::json::parse(boost::beast::buffers_to_string(buffer.cdata()));
+  }
+
+  nlohmann::json ReadUntil(WebSocket& ws, boost::beast::flat_buffer& buffer, const std::string& event,
+                           int max_messages = 12) {
+    for (int i = 0; i < max_messages; ++i) {
+      auto msg = ReadWs(ws, buffer);
+      if (msg.contains("event") && msg["event"] == event) {
+        return msg;
+      }
+    }
+    return nullptr;
+  }
+
+  void SendEvent(WebSocket& ws, const std::string& event, const nlohmann::json& payload) {
+    nlohmann::json msg{{"t", "event"}, {"seq", 1}, {"event", event}, {"p", payload}};
+    ws.write(boost::asio::buffer(msg.dump()));
+  }
+
+  boost::asio::io_context ioc_;
+  std::unique_ptr<server::ServerApp> source_;
+  std::unique_ptr<server::ServerApp> target_;
+  std::thread source_thread_;
+  std::thread target_thread_;
+};
+
+TEST_F(SessionMigrationFixture, LiveSessionMovesToTargetAndFinishes) {
+  using boost::beast::http::verb;
+  const std::string token_a = RegisterAndLogin("alice", "pw1");
+  const std::string token_b = RegisterAndLogin("bob", "pw2");
+  auto ws_a = ConnectWs(kSourcePort, token_a);
+  auto ws_b = ConnectWs(kSourcePort, token_b);
+  boost::beast::flat_buffer buf_a;
+  boost::beast::flat_buffer buf_b;
+  const int alice_id = ReadWs(*ws_a, buf_a)["p"]["userId"].get<int>();
+  ReadWs(*ws_b, buf_b);
+
+  Request(kSourcePort, verb::post, "/api/queue/join", {{"mode", "normal"}}, token_a);
+  Request(kSourcePort, verb::post, "/api/queue/join", {{"mode", "normal"}}, token_b);
+  auto created = ReadUntil(*ws_a, buf_a, "session.created");
+  ASSERT_TRUE(created.is_object());
+  const auto session_id = created["p"]["sessionId"].get<std::string>();
+
+  // 이전 시점보다 미래 틱을 겨냥한 입력은 대상 서버에서 적용돼야 한다.
+  SendEvent(*ws_a, "session.input", {{"sessionId", session_id}, {"sequence", 1}, {"targetTick", 3}, {"delta", 2}});
+  ASSERT_TRUE(ReadUntil(*ws_a, buf_a, "session.state").is_object());
+
+  auto migrate = Request(kSourcePort, verb::post, "/ops/migrate",
+                         {{"sessionId", session_id}, {"targetPort", kTargetMigrationPort}}, "", "ops-token");
+  ASSERT_EQ(migrate.status, boost::beast::http::status::ok) << migrate.body.dump();
+  const auto target_session_id = migrate.body["data"]["targetSessionId"].get<std::string>();
+  const int migrated_tick = migrate.body["data"]["tick"].get<int>();
+  EXPECT_GE(migrated_tick, 1);
+
+  auto migrated_a = ReadUntil(*ws_a, buf_a, "session.migrated");
+  auto migrated_b = ReadUntil(*ws_b, buf_b, "session.migrated");
+  ASSERT_TRUE(migrated_a.is_object());
+  ASSERT_TRUE(migrated_b.is_object());
+  EXPECT_EQ(migrated_a["p"]["targetSessionId"], target_session_id);
+  EXPECT_EQ(migrated_a["p"]["target"]["port"], kTargetPort);
+  EXPECT_NE(migrated_a["p"]["resumeToken"], migrated_b["p"]["resumeToken"]);
+
+  // 원본에는 세션이 남지 않는다.
+  auto late_input = nlohmann::json{{"sessionId", session_id}, {"sequence", 2}, {"targetTick", 4}, {"delta", 1}};
+  SendEvent(*ws_a, "session.input", late_input);
+  auto late_error = ReadWs(*ws_a, buf_a);
+  EXPECT_EQ(late_error["t"], "error");
+  EXPECT_EQ(late_error["p"]["code"], "session_not_found");
+
+  auto target_a = ConnectWs(kTargetPort, migrated_a["p"]["accessToken"].get<std::string>());
+  auto target_b = ConnectWs(kTargetPort, migrated_b["p"]["accessToken"].get<std::string>());
+  boost::beast::flat_buffer tbuf_a;
+  boost::beast::flat_buffer tbuf_b;
+  EXPECT_EQ(ReadWs(*target_a, tbuf_a)["p"]["userId"], alice_id);
+  ReadWs(*target_b, tbuf_b);
+
+  // 다른 사용자의 복귀 토큰은 받지 않는다.
+  SendEvent(*target_a, "session.resume",
+            {{"sessionId", target_session_id}, {"resumeToken", migrated_b["p"]["resumeToken"]}});
+  auto rejected = ReadWs(*target_a, tbuf_a);
+  EXPECT_EQ(rejected["t"], "error");
+  EXPECT_EQ(rejected["p"]["code"], "invalid_resume_token");
+
+  SendEvent(*target_a, "session.resume",
+            {{"sessionId", target_session_id}, {"resumeToken", migrated_a["p"]["resumeToken"]}});
+  SendEvent(*target_b, "session.resume",
+            {{"sessionId", target_session_id}, {"resumeToken", migrated_b["p"]["resumeToken"]}});
+  auto resumed = ReadUntil(*target_a, tbuf_a, "session.resumed");
+  ASSERT_TRUE(resumed.is_object());
+  EXPECT_EQ(resumed["p"]["tick"], migrated_tick);
+  ASSERT_TRUE(ReadUntil(*target_b, tbuf_b, "session.resumed").is_object());
+
+  auto ended = ReadUntil(*target_a, tbuf_a, "session.ended");
+  ASSERT_TRUE(ended.is_object());
+  EXPECT_EQ(ended["p"]["sessionId"], target_session_id);
+  EXPECT_EQ(ended["p"]["result"]["winnerUserId"], alice_id);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  auto record = target_->GetResultService()->Find(target_session_id);
+  ASSERT_TRUE(record.has_value());
+  // 원본에서 받은 입력까지 담긴 저널을 재생하면 대상에서 끝난 상태와 같아야 한다.
+  server::Simulation replayed;
+  auto replay = server::ReplayJournal(record->input_journal, replayed);
+  ASSERT_TRUE(replay.ok) << replay.error;
+  EXPECT_EQ(replay.inputs, 1u);
+  EXPECT_EQ(server::SnapshotToJson(replayed.View()), record->snapshot);
+  for (const auto& player : record->snapshot["players"]) {
+    if (player["userId"] == alice_id) {
+      EXPECT_EQ(player["position"], 2);
+    }
+  }
+
+  auto source_metrics = Request(kSourcePort, verb::get, "/metrics", nullptr);
+  EXPECT_EQ(source_metrics.body["data"]["migration"]["exported"], 1);
+  auto target_metrics = Request(kTargetPort, verb::get, "/metrics", nullptr);
+  EXPECT_EQ(target_metrics.body["data"]["migration"]["imported"], 1);
+  EXPECT_EQ(target_metrics.body["data"]["migration"]["pauseTicks"]["count"], 1);
+}
+
+TEST_F(SessionMigrationFixture, UnreachableTargetResumesOnSource) {
+  using boost::beast::http::verb;
+  const std::string token_a = RegisterAndLogin("carol", "pw1");
+  const std::string token_b = RegisterAndLogin("dave", "pw2");
+  auto ws_a = ConnectWs(kSourcePort, token_a);
+  boost::beast::flat_buffer buf_a;
+  ReadWs(*ws_a, buf_a);
+
+  Request(kSourcePort, verb::post, "/api/queue/join", {{"mode", "normal"}}, token_a);
+  Request(kSourcePort, verb::post, "/api/queue/join", {{"mode", "normal"}}, token_b);
+  auto created = ReadUntil(*ws_a, buf_a, "session.created");
+  ASSERT_TRUE(created.is_object());
+  const auto session_id = created["p"]["sessionId"].get<std::string>();
+
+  auto unauthorized = Request(kSourcePort, verb::post, "/ops/migrate",
+                              {{"sessionId", session_id}, {"targetPort", kTargetMigrationPort}});
+  EXPECT_EQ(unauthorized.status, boost::beast::http::status::unauthorized);
+
+  // 수신기가 없는 포트로 보내면 실패하고 원본에서 틱이 재개된다.
+  auto failed = Request(kSourcePort, verb::post, "/ops/migrate",
+                        {{"sessionId", session_id}, {"targetPort", kTargetMigrationPort + 1}}, "", "ops-token");
+  EXPECT_EQ(failed.status, boost::beast::http::status::bad_gateway);
+  EXPECT_EQ(failed.body["error"]["code"], "migration_failed");
+
+  // 허용 목록에 없는 대상으로는 보내지 않는다.
+  auto forbidden = Request(kSourcePort, verb::post, "/ops/migrate",
+                           {{"sessionId", session_id}, {"targetHost", "10.0.0.1"}, {"targetPort", kTargetMigrationPort}},
+                           "", "ops-token");
+  EXPECT_EQ(forbidden.status, boost::beast::http::status::forbidden);
+  EXPECT_EQ(forbidden.body["error"]["code"], "migration_target_forbidden");
+
+  auto missing = Request(kSourcePort, verb::post, "/ops/migrate",
+                         {{"sessionId", "session-999"}, {"targetPort", kTargetMigrationPort}}, "", "ops-token");
+  EXPECT_EQ(missing.status, boost::beast::http::status::not_found);
+
+  auto ended = ReadUntil(*ws_a, buf_a, "session.ended");
+  ASSERT_TRUE(ended.is_object());
+  EXPECT_EQ(ended["p"]["sessionId"], session_id);
+  EXPECT_EQ(ended["p"]["result"]["ticks"], 5);
+
+  auto metrics = Request(kSourcePort, verb::get, "/metrics", nullptr);
+  EXPECT_EQ(metrics.body["data"]["migration"]["failed"], 1);
+  EXPECT_EQ(metrics.body["data"]["migration"]["exported"], 0);
+}
+
+// 결과를 모르는 이전은 대상이 취소를 확인하기 전까지 원본을 멈춘 채로 두고, 같은 대상으로 다시 보내 결과를 정한다.
+TEST_F(SessionMigrationFixture, SilentTargetLeavesSessionPausedUntilAbortIsConfirmed) {
+  using boost::beast::http::verb;
+  const std::string token_a = RegisterAndLogin("erin", "pw1");
+  const std::string token_b = RegisterAndLogin("frank", "pw2");
+  auto ws_a = ConnectWs(kSourcePort, token_a);
+  boost::beast::flat_buffer buf_a;
+  ReadWs(*ws_a, buf_a);
+
+  Request(kSourcePort, verb::post, "/api/queue/join", {{"mode", "normal"}}, token_a);
+  Request(kSourcePort, verb::post, "/api/queue/join", {{"mode", "normal"}}, token_b);
+  auto created = ReadUntil(*ws_a, buf_a, "session.created");
+  ASSERT_TRUE(created.is_object());
+  const auto session_id = created["p"]["sessionId"].get<std::string>();
+
+  // 연결은 받지만 처음 두 요청(수신, 취소)에는 응답하지 않는 대상. 다시 보낸 수신은 처리 중이라 답하고 취소는 확인한다.
+  constexpr unsigned short kSilentPort = kTargetMigrationPort + 2;
+  const std::vector<nlohmann::json> replies{
+      nullptr, nullptr, {{"ok", false}, {"code", "migration_in_progress"}, {"message", "같은 이전을 받는 중입니다"}},
+      {{"ok", true}}};
+  boost::asio::io_context silent_ioc;
+  boost::asio::ip::tcp::acceptor silent{silent_ioc, {boost::asio::ip::address_v4::loopback(), kSilentPort}};
+  std::vector<boost::asio::ip::tcp::socket> held;
+  std::vector<nlohmann::json> received;
+  std::promise<void> connected;
+  std::thread silent_thread([&]() {
+    for (const auto& reply : replies) {
+      held.emplace_back(silent_ioc);
+      silent.accept(held.back());
+      if (received.empty()) {
+        connected.set_value();
+      }
+      std::string line;
+      boost::asio::read_until(held.back(), boost::asio::dynamic_buffer(line), '\n');
+      received.push_back(nlohmann::json::parse(line));
+      if (!reply.is_null()) {
+        boost::asio::write(held.back(), boost::asio::buffer(reply.dump() + "\n"));
+      }
+    }
+  });
+
+  std::atomic<bool> migrate_done{false};
+  SimpleHttpResponse unknown{};
+  std::thread migrate_thread([&]() {
+    unknown = Request(kSourcePort, verb::post, "/ops/migrate", {{"sessionId", session_id}, {"targetPort", kSilentPort}},
+                      "", "ops-token");
+    migrate_done = true;
+  });
+  connected.get_future().wait();
+  // 테스트 서버의 io 스레드 수와 관계없이, 이전 응답을 기다리는 중에도 /metrics가 바로 돌아온다.
+  auto during = Request(kSourcePort, verb::get, "/metrics", nullptr);
+  EXPECT_EQ(during.status, boost::beast::http::status::ok);
+  EXPECT_FALSE(migrate_done.load());
+  migrate_thread.join();
+
+  EXPECT_EQ(unknown.status, boost::beast::http::status::gateway_timeout);
+  EXPECT_EQ(unknown.body["error"]["code"], "migration_unknown");
+  EXPECT_NE(unknown.body["error"]["message"].get<std::string>().find("시간이 초과"), std::string::npos);
+
+  // 대상에 사본이 있을 수 있으므로 원본은 입력을 받지 않고, 다른 대상으로 옮기지도 않는다.
+  SendEvent(*ws_a, "session.input", {{"sessionId", session_id}, {"sequence", 1}, {"targetTick", 3}, {"delta", 1}});
+  nlohmann::json paused_error;
+  for (int i = 0; i < 12 && !paused_error.is_object(); ++i) {
+    auto msg = ReadWs(*ws_a, buf_a);
+    if (msg["t"] == "error") {
+      paused_error = msg;
+    }
+  }
+  ASSERT_TRUE(paused_error.is_object());
+  EXPECT_EQ(paused_error["p"]["code"], "session_migrating");
+  auto elsewhere = Request(kSourcePort, verb::post, "/ops/migrate",
+                           {{"sessionId", session_id}, {"targetPort", kTargetMigrationPort}}, "", "ops-token");
+  EXPECT_EQ(elsewhere.status, boost::beast::http::status::conflict);
+  EXPECT_EQ(elsewhere.body["error"]["code"], "migration_in_doubt");
+
+  // 같은 대상으로 다시 보내면 같은 migrationId를 쓰고, 대상이 취소를 확인한 뒤에야 원본에서 틱이 재개된다.
+  auto retried = Request(kSourcePort, verb::post, "/ops/migrate",
+                         {{"sessionId", session_id}, {"targetPort", kSilentPort}}, "", "ops-token");
+  EXPECT_EQ(retried.status, boost::beast::http::status::bad_gateway);
+  EXPECT_EQ(retried.body["error"]["code"], "migration_failed");
+  silent_thread.join();
+
+  ASSERT_EQ(received.size(), 4u);
+  const auto migration_id = received[0]["session"]["migrationId"];
+  EXPECT_EQ(received[0]["type"], "import");
+  EXPECT_EQ(received[0]["session"]["sessionId"], session_id);
+  // 대상에는 운영 토큰이 아닌 이전 전용 토큰만 보낸다.
+  EXPECT_EQ(received[0]["migrationToken"], "migration-token");
+  EXPECT_FALSE(received[0].contains("opsToken"));
+  EXPECT_EQ(received[1]["type"], "abort");
+  EXPECT_EQ(received[1]["migrationId"], migration_id);
+  EXPECT_EQ(received[2]["type"], "import");
+  EXPECT_EQ(received[2]["session"]["migrationId"], migration_id);
+  EXPECT_EQ(received[2]["session"]["pausedAtMs"], received[0]["session"]["pausedAtMs"]);
+  EXPECT_EQ(received[3]["migrationId"], migration_id);
+
+  auto ended = ReadUntil(*ws_a, buf_a, "session.ended");
+  ASSERT_TRUE(ended.is_object());
+  EXPECT_EQ(ended["p"]["sessionId"], session_id);
+
+  auto metrics = Request(kSourcePort, verb::get, "/metrics", nullptr);
+  EXPECT_EQ(metrics.body["data"]["migration"]["inDoubt"], 1);
+  EXPECT_EQ(metrics.body["data"]["migration"]["failed"], 1);
+  EXPECT_EQ(metrics.body["data"]["migration"]["exported"], 0);
+}
+
+// 대상 수신기는 취소한 migrationId를 기억해 늦게 도착한 같은 이전을 받지 않는다.
+TEST_F(SessionMigrationFixture, TargetRejectsImportAfterAbort) {
+  server::SessionExport exported;
+  exported.migration_id = "late-1";
+  exported.session_id = "session-1";
+  exported.participants = {{901, "late-a"}, {902, "late-b"}};
+  server::InputJournal journal;
+  journal.Begin({901, 902}, 0);
+  journal.Finish(1);
+  exported.journal = journal.Bytes();
+  server::Simulation replayed;
+  server::ReplayJournal(exported.journal, replayed);
+  exported.tick = replayed.CurrentTick();
+  exported.state_hash = replayed.StateHash();
+
+  // 운영 토큰으로는 이전 수신기를 쓸 수 없다.
+  auto ops_only = SendMigrationLine(kTargetMigrationPort,
+                                    {{"type", "abort"}, {"opsToken", "ops-token"}, {"migrationId", "late-1"}});
+  EXPECT_EQ(ops_only["code"], "unauthorized");
+
+  auto missing_type = SendMigrationLine(kTargetMigrationPort, {{"migrationToken", "migration-token"}, {"migrationId", "late-1"}});
+  EXPECT_EQ(missing_type["code"], "bad_request");
+
+  auto aborted = SendMigrationLine(kTargetMigrationPort,
+                                   {{"type", "abort"}, {"migrationToken", "migration-token"}, {"migrationId", "late-1"}});
+  EXPECT_EQ(aborted["ok"], true);
+
+  auto late = SendMigrationLine(kTargetMigrationPort, {{"type", "import"},
+                                                       {"migrationToken", "migration-token"},
+                                                       {"session", server::SessionExportToJson(exported)}});
+  EXPECT_EQ(late["ok"], false);
+  EXPECT_EQ(late["code"], "migration_aborted");
+}
+
+}  // namespace
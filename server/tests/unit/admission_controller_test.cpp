@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "server/admission.hpp"
+
+namespace {
+
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+server::AdmissionConfig TestConfig() {
+  server::AdmissionConfig config;
+  config.max_active_sessions = 2;
+  config.max_tick_lateness = milliseconds(20);
+  config.max_loop_lag = milliseconds(10);
+  config.retry_after = std::chrono::seconds(3);
+  config.lateness_stale_after = milliseconds(50);
+  return config;
+}
+
+TEST(AdmissionControllerTest, DisabledConfigAdmitsEverything) {
+  server::AdmissionController admission(server::AdmissionConfig{});
+  EXPECT_FALSE(admission.Enabled());
+  server::AdmissionSignals signals{1000, microseconds(1'000'000), microseconds(1'000'000)};
+  EXPECT_EQ(admission.Evaluate(signals), server::AdmissionVerdict::kAdmit);
+}
+
+TEST(AdmissionControllerTest, RejectsWhenAnySignalIsOverBudget) {
+  server::AdmissionController admission(TestConfig());
+  EXPECT_TRUE(admission.Enabled());
+  EXPECT_EQ(admission.RetryAfter(), std::chrono::seconds(3));
+
+  EXPECT_EQ(admission.Evaluate({1, microseconds(0), microseconds(0)}), server::AdmissionVerdict::kAdmit);
+  // 한도만큼 진행 중이면 세션을 하나 더 받을 여유가 없다.
+  EXPECT_EQ(admission.Evaluate({2, microseconds(0), microseconds(0)}), server::AdmissionVerdict::kTooManySessions);
+  EXPECT_EQ(admission.Evaluate({0, microseconds(25'000), microseconds(0)}), server::AdmissionVerdict::kTickLateness);
+  EXPECT_EQ(admission.Evaluate({0, microseconds(0), microseconds(15'000)}), server::AdmissionVerdict::kLoopLag);
+}
+
+TEST(AdmissionControllerTest, SmoothsTickLatenessAndForgetsStaleSignal) {
+  server::AdmissionController admission(TestConfig());
+  EXPECT_EQ(admission.TickLateness(), microseconds(0));
+
+  // 첫 관측은 그대로 쓰고, 이후에는 1/8씩 따라간다. 단발성 튐은 평균을 크게 흔들지 않는다.
+  admission.RecordTickLateness(microseconds(8'000));
+  EXPECT_EQ(admission.TickLateness(), microseconds(8'000));
+  admission.RecordTickLateness(microseconds(88'000));
+  EXPECT_EQ(admission.TickLateness(), microseconds(18'000));
+  for (int i = 0; i < 40; ++i) {
+    admission.RecordTickLateness(microseconds(40'000));
+  }
+  EXPECT_GT(admission.TickLateness(), milliseconds(20));
+
+  // 틱이 더 오지 않으면(세션이 모두 끝나면) 지연 신호는 0으로 돌아와 입장이 다시 열린다.
+  std::this_thread::sleep_for(milliseconds(80));
+  EXPECT_EQ(admission.TickLateness(), microseconds(0));
+  admission.RecordTickLateness(microseconds(1'000));
+  EXPECT_EQ(admission.TickLateness(), microseconds(1'000));
+}
+
+}  // namespace
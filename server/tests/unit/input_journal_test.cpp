@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "server/input_journal.hpp"
+#include "server/simulation.hpp"
+
+namespace {
+
+// 실시간 세션처럼 틱 진행 중에 입력을 넣으며 저널을 기록한다.
+struct RecordedMatch {
+  server::Simulation simulation;
+  server::InputJournal journal;
+};
+
+void RecordRandomMatch(RecordedMatch& match, int rollback_window, int ticks, std::uint32_t seed) {
+  const std::vector<int> users{42, 7, 1001};
+  match.simulation.EnableRollback(rollback_window);
+  for (int id : users) {
+    match.simulation.AddPlayer(id);
+  }
+  match.journal.Begin(users, rollback_window);
+
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> offset(-rollback_window, 6);
+  std::uniform_int_distribution<int> delta(-3, 3);
+  std::uniform_int_distribution<int> pick(0, 2);
+  std::vector<std::uint64_t> sequences(users.size(), 0);
+  for (int t = 0; t < ticks; ++t) {
+    for (int k = 0; k < 2; ++k) {
+      const auto who = static_cast<std::size_t>(pick(rng));
+      server::InputCommand input{users[who], match.simulation.CurrentTick() + offset(rng), delta(rng),
+                                 sequences[who] + 1 + static_cast<std::uint64_t>(pick(rng))};
+      if (match.simulation.EnqueueInput(input).accepted) {
+        sequences[who] = input.sequence;
+        match.journal.Append(match.simulation.CurrentTick(), input);
+      }
+    }
+    match.simulation.TickOnce();
+  }
+  match.journal.Finish(match.simulation.CurrentTick());
+}
+
+TEST(InputJournalTest, ReplayReproducesFinalSnapshot) {
+  RecordedMatch match;
+  RecordRandomMatch(match, 0, 300, 7);
+  ASSERT_GT(match.journal.InputCount(), 100u);
+
+  server::Simulation replayed;
+  auto result = server::ReplayJournal(match.journal.Bytes(), replayed);
+  ASSERT_TRUE(result.ok) << result.error;
+  EXPECT_EQ(result.inputs, match.journal.InputCount());
+  EXPECT_EQ(result.final_tick, 300);
+  EXPECT_EQ(replayed.Snapshot(), match.simulation.Snapshot());
+  // 입력당 4바이트(도착 틱/슬롯·delta/목표 틱/시퀀스 증분이 모두 1바이트 varint) 이내로 기록된다.
+  EXPECT_LE(match.journal.Bytes().size(), 16 + match.journal.InputCount() * 4 + 4);
+}
+
+TEST(InputJournalTest, ReplayFollowsRollbackCorrections) {
+  RecordedMatch match;
+  RecordRandomMatch(match, 6, 200, 99);
+
+  server::Simulation replayed;
+  auto result = server::ReplayJournal(match.journal.Bytes(), replayed);
+  ASSERT_TRUE(result.ok) << result.error;
+  EXPECT_EQ(replayed.RollbackWindow(), 6);
+  EXPECT_EQ(replayed.Snapshot(), match.simulation.Snapshot());
+}
+
+TEST(InputJournalTest, RejectsCorruptJournals) {
+  RecordedMatch match;
+  RecordRandomMatch(match, 0, 20, 3);
+  const auto& bytes = match.journal.Bytes();
+
+  server::Simulation truncated;
+  EXPECT_EQ(server::ReplayJournal(bytes.substr(0, bytes.size() - 1), truncated).error, "truncated_record");
+
+  server::Simulation bad_magic;
+  EXPECT_EQ(server::ReplayJournal("XX", bad_magic).error, "bad_magic");
+
+  server::Simulation trailing;
+  EXPECT_EQ(server::ReplayJournal(bytes + std::string(1, '\0'), trailing).error, "trailing_bytes");
+
+  // 플레이어 수는 할당 전에, 도착 틱은 틱을 진행하기 전에 거절해야 한다.
+  const std::string header("IJ\x01\x00", 4);
+  server::Simulation crowd;
+  EXPECT_EQ(server::ReplayJournal(header + "\xff\xff\xff\xff\xff\xff\xff\xff\x7f", crowd).error,
+            "too_many_players");
+
+  const std::string far_arrival = header + std::string("\x01\x02", 2) + "\xff\xff\xff\xff\xff\xff\xff\xff\x7f";
+  server::Simulation far;
+  EXPECT_EQ(server::ReplayJournal(far_arrival + std::string("\x07", 1), far).error, "tick_out_of_range");
+  EXPECT_EQ(far.CurrentTick(), 0);
+
+  server::Simulation capped;
+  const auto replayed = server::ReplayJournal(bytes, capped, nullptr, 19);
+  EXPECT_EQ(replayed.error, "tick_out_of_range");
+  EXPECT_LE(capped.CurrentTick(), 19);
+}
+
+TEST(InputJournalTest, EncodesBase64WithPadding) {
+  EXPECT_EQ(server::EncodeBase64(""), "");
+  EXPECT_EQ(server::EncodeBase64("f"), "Zg==");
+  EXPECT_EQ(server::EncodeBase64("fo"), "Zm8=");
+  EXPECT_EQ(server::EncodeBase64("foo"), "Zm9v");
+}
+
+TEST(InputJournalTest, DecodesBase64RoundTrip) {
+  RecordedMatch match;
+  RecordRandomMatch(match, 2, 30, 5);
+  std::string decoded;
+  ASSERT_TRUE(server::DecodeBase64(server::EncodeBase64(match.journal.Bytes()), decoded));
+  EXPECT_EQ(decoded, match.journal.Bytes());
+  ASSERT_TRUE(server::DecodeBase64("Zm8=", decoded));
+  EXPECT_EQ(decoded, "fo");
+  EXPECT_FALSE(server::DecodeBase64("Zm8", decoded));
+  EXPECT_FALSE(server::DecodeBase64("Z=8=", decoded));
+  EXPECT_FALSE(server::DecodeBase64("Zm*v", decoded));
+}
+
+// 진행 중인 저널을 끊어 재생하고 이어 기록하면, 끊지 않은 원래 매치와 상태/저널 바이트가 같아야 한다(세션 이전 경로).
+TEST(InputJournalTest, ContinuedReplayResumesMidMatch) {
+  const std::vector<int> users{42, 7, 1001};
+  constexpr int kWindow = 4;
+  server::Simulation original;
+  server::InputJournal original_journal;
+  original.EnableRollback(kWindow);
+  for (int id : users) {
+    original.AddPlayer(id);
+  }
+  original_journal.Begin(users, kWindow);
+
+  std::mt19937 rng(11);
+  std::uniform_int_distribution<int> offset(-kWindow, 6);
+  std::uniform_int_distribution<int> delta(-3, 3);
+  std::uniform_int_distribution<int> pick(0, 2);
+  std::vector<std::uint64_t> sequences(users.size(), 0);
+  auto drive = [&](server::Simulation& sim, server::InputJournal& journal, server::Simulation* mirror,
+                   server::InputJournal* mirror_journal, int ticks) {
+    for (int t = 0; t < ticks; ++t) {
+      for (int k = 0; k < 2; ++k) {
+        const auto who = static_cast<std::size_t>(pick(rng));
+        server::InputCommand input{users[who], sim.CurrentTick() + offset(rng), delta(rng), sequences[who] + 1};
+        if (sim.EnqueueInput(input).accepted) {
+          sequences[who] = input.sequence;
+          journal.Append(sim.CurrentTick(), input);
+          if (mirror) {
+            ASSERT_TRUE(mirror->EnqueueInput(input).accepted);
+            mirror_journal->Append(mirror->CurrentTick(), input);
+          }
+        }
+      }
+      sim.TickOnce();
+      if (mirror) {
+        mirror->TickOnce();
+      }
+    }
+  };
+  drive(original, original_journal, nullptr, nullptr, 60);
+
+  // 내보내기: 진행 중인 저널의 복사본에만 종료 표시를 붙인다.
+  server::InputJournal exported = original_journal;
+  exported.Finish(original.CurrentTick());
+  server::Simulation migrated;
+  server::InputJournal migrated_journal;
+  auto result = server::ReplayJournal(exported.Bytes(), migrated, &migrated_journal);
+  ASSERT_TRUE(result.ok) << result.error;
+  EXPECT_EQ(migrated.CurrentTick(), original.CurrentTick());
+  EXPECT_EQ(migrated.StateHash(), original.StateHash());
+  EXPECT_EQ(migrated_journal.Bytes(), original_journal.Bytes());
+
+  // 미래 틱 대상 대기 입력과 롤백 저장 상태도 옮겨졌으므로 이후 진행이 같다.
+  drive(original, original_journal, &migrated, &migrated_journal, 60);
+  EXPECT_EQ(migrated.Snapshot(), original.Snapshot());
+  original_journal.Finish(original.CurrentTick());
+  migrated_journal.Finish(migrated.CurrentTick());
+  EXPECT_EQ(migrated_journal.Bytes(), original_journal.Bytes());
+}
+
+}  // namespace
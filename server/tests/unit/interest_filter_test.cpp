@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "server/interest_filter.hpp"
+#include "server/simulation.hpp"
+
+namespace {
+
+std::vector<int> SelectedIds(const server::Simulation& sim, int recipient, const server::InterestFilter& filter) {
+  std::vector<server::PlayerView> out;
+  server::SelectInterestedPlayers(sim.View(), recipient, filter, out);
+  std::vector<int> ids;
+  for (const auto& player : out) {
+    ids.push_back(player.user_id);
+  }
+  return ids;
+}
+
+// 1: 0, 2: +3, 3: -6, 4: +9 위치로 이동시킨 세션.
+server::Simulation SpreadPlayers() {
+  server::Simulation sim;
+  for (int user = 1; user <= 4; ++user) {
+    sim.AddPlayer(user);
+  }
+  EXPECT_TRUE(sim.EnqueueInput({2, 1, 3, 1}).accepted);
+  EXPECT_TRUE(sim.EnqueueInput({3, 1, -3, 1}).accepted);
+  EXPECT_TRUE(sim.EnqueueInput({3, 1, -3, 2}).accepted);
+  for (std::uint64_t seq = 1; seq <= 3; ++seq) {
+    EXPECT_TRUE(sim.EnqueueInput({4, 1, 3, seq}).accepted);
+  }
+  sim.TickOnce();
+  return sim;
+}
+
+TEST(InterestFilterTest, AllPlayersFilterKeepsEveryone) {
+  auto sim = SpreadPlayers();
+  server::AllPlayersFilter filter;
+  EXPECT_TRUE(filter.Broadcast());
+  EXPECT_EQ(SelectedIds(sim, 3, filter), (std::vector<int>{1, 2, 3, 4}));
+}
+
+TEST(InterestFilterTest, RadiusFilterSelectsNearbyPlayersInUserOrder) {
+  auto sim = SpreadPlayers();
+  server::RadiusInterestFilter filter(6);
+  EXPECT_FALSE(filter.Broadcast());
+  EXPECT_EQ(SelectedIds(sim, 1, filter), (std::vector<int>{1, 2, 3}));
+  EXPECT_EQ(SelectedIds(sim, 2, filter), (std::vector<int>{1, 2, 4}));
+  EXPECT_EQ(SelectedIds(sim, 3, filter), (std::vector<int>{1, 3}));
+  EXPECT_EQ(SelectedIds(sim, 4, filter), (std::vector<int>{2, 4}));
+}
+
+TEST(InterestFilterTest, UnknownRecipientReceivesEveryone) {
+  auto sim = SpreadPlayers();
+  server::RadiusInterestFilter filter(1);
+  EXPECT_EQ(SelectedIds(sim, 99, filter), (std::vector<int>{1, 2, 3, 4}));
+}
+
+TEST(InterestFilterTest, FactoryFallsBackToBroadcast) {
+  EXPECT_TRUE(server::MakeInterestFilter(0)->Broadcast());
+  EXPECT_FALSE(server::MakeInterestFilter(5)->Broadcast());
+}
+
+}  // namespace
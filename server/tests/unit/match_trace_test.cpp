@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include "server/histogram.hpp"
+#include "server/match_trace.hpp"
+
+namespace {
+
+TEST(HistogramTest, PercentilesFollowBucketUpperBounds) {
+  server::Histogram histogram({10, 100, 1000});
+  for (int i = 0; i < 90; ++i) {
+    histogram.Record(5);
+  }
+  for (int i = 0; i < 10; ++i) {
+    histogram.Record(500);
+  }
+  EXPECT_EQ(histogram.Count(), 100u);
+  EXPECT_EQ(histogram.Percentile(0.5), 10u);
+  EXPECT_EQ(histogram.Percentile(0.95), 500u);
+
+  auto json = histogram.ToJson(1.0, "");
+  EXPECT_EQ(json["count"].get<std::uint64_t>(), 100u);
+  ASSERT_EQ(json["buckets"].size(), 4u);
+  EXPECT_EQ(json["buckets"][2]["count"].get<std::uint64_t>(), 10u);
+}
+
+TEST(MatchTracerTest, RecordsLifecycleSpansAndSampledTrace) {
+  server::MatchTracer tracer(1);
+  tracer.RecordJoin(1, "join-a");
+  tracer.RecordJoin(2, "join-b");
+  EXPECT_TRUE(tracer.OpenSession("session-1", "trace-1", {1, 2}));
+
+  tracer.Mark("session-1", server::MatchEvent::kCreated);
+  tracer.Mark("session-1", server::MatchEvent::kStarted);
+  tracer.Mark("session-1", server::MatchEvent::kFirstTick);
+  tracer.Mark("session-1", server::MatchEvent::kFirstTick);
+  tracer.Mark("session-1", server::MatchEvent::kInput, 1);
+  tracer.Mark("session-1", server::MatchEvent::kEnded);
+  EXPECT_EQ(tracer.OpenTraceCount(), 1u);
+  tracer.Mark("session-1", server::MatchEvent::kRatingApplied);
+  EXPECT_EQ(tracer.OpenTraceCount(), 0u);
+
+  auto histograms = tracer.HistogramsJson();
+  EXPECT_EQ(histograms["joinToPair"]["count"].get<std::uint64_t>(), 2u);
+  EXPECT_EQ(histograms["pairToCreated"]["count"].get<std::uint64_t>(), 1u);
+  EXPECT_EQ(histograms["createdToFirstTick"]["count"].get<std::uint64_t>(), 1u);
+  EXPECT_EQ(histograms["queueToStart"]["count"].get<std::uint64_t>(), 2u);
+  EXPECT_EQ(histograms["endToRatingApplied"]["count"].get<std::uint64_t>(), 1u);
+
+  auto traces = tracer.SampledTracesJson();
+  ASSERT_EQ(traces.size(), 1u);
+  EXPECT_EQ(traces[0]["traceId"], "trace-1");
+  EXPECT_EQ(traces[0]["sessionId"], "session-1");
+  ASSERT_EQ(traces[0]["joins"].size(), 2u);
+  EXPECT_EQ(traces[0]["joins"][0]["traceId"], "join-a");
+  ASSERT_EQ(traces[0]["events"].size(), 6u);
+  EXPECT_EQ(traces[0]["events"][3]["name"], "session.input");
+  EXPECT_EQ(traces[0]["events"][3]["userId"], 1);
+}
+
+TEST(MatchTracerTest, DroppedJoinIsNotLinkedAndSamplingSkips) {
+  server::MatchTracer tracer(2);
+  tracer.RecordJoin(1, "join-a");
+  tracer.DropJoin(1);
+  EXPECT_TRUE(tracer.OpenSession("session-1", "trace-1", {1, 2}));
+  EXPECT_FALSE(tracer.OpenSession("session-2", "trace-2", {3, 4}));
+  tracer.CloseSession("session-1");
+  tracer.CloseSession("session-2");
+
+  EXPECT_EQ(tracer.HistogramsJson()["joinToPair"]["count"].get<std::uint64_t>(), 0u);
+  auto traces = tracer.SampledTracesJson();
+  ASSERT_EQ(traces.size(), 1u);
+  EXPECT_TRUE(traces[0]["joins"].empty());
+}
+
+}  // namespace
@@ -0,0 +1,259 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "server/matchmaking_index.hpp"
+
+namespace {
+
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+using Clock = std::chrono::steady_clock;
+
+server::MatchTicket Ticket(int user_id, int rating, Clock::time_point joined_at) {
+  return server::MatchTicket{user_id, "user" + std::to_string(user_id), rating, joined_at, joined_at + seconds(30)};
+}
+
+std::vector<int> UserIds(const std::vector<server::MatchTicket>& tickets) {
+  std::vector<int> ids;
+  for (const auto& ticket : tickets) {
+    ids.push_back(ticket.user_id);
+  }
+  return ids;
+}
+
+server::MatchmakingConfig TestConfig() {
+  server::MatchmakingConfig config;
+  config.base_window = 50;
+  config.widen_per_second = 100;
+  config.max_window = 300;
+  return config;
+}
+
+TEST(MatchmakingIndexTest, WindowWidensWithWaitUpToCap) {
+  server::MatchmakingIndex index(TestConfig());
+  EXPECT_EQ(index.WindowFor(milliseconds(0)), 50);
+  EXPECT_EQ(index.WindowFor(milliseconds(1500)), 200);
+  EXPECT_EQ(index.WindowFor(seconds(60)), 300);
+
+  server::MatchmakingConfig uncapped = TestConfig();
+  uncapped.max_window = 0;
+  EXPECT_EQ(server::MatchmakingIndex(uncapped).WindowFor(seconds(60)), 6050);
+}
+
+TEST(MatchmakingIndexTest, PairsClosestRatingsInsideAnchorWindow) {
+  server::MatchmakingIndex index(TestConfig());
+  const auto now = Clock::now();
+  // 가장 오래 기다린 1번(1000)이 앵커다. 창 50 안에서 가장 가까운 3번(1030)과 묶이고, 먼 2번(1400)은 남는다.
+  ASSERT_TRUE(index.Add(Ticket(1, 1000, now)));
+  ASSERT_TRUE(index.Add(Ticket(2, 1400, now)));
+  ASSERT_TRUE(index.Add(Ticket(3, 1030, now)));
+  ASSERT_TRUE(index.Add(Ticket(4, 1045, now)));
+  EXPECT_FALSE(index.Add(Ticket(1, 900, now)));
+
+  std::vector<server::MatchTicket> out;
+  ASSERT_TRUE(index.PopMatch(now, 2, out));
+  EXPECT_EQ(UserIds(out), (std::vector<int>{1, 3}));
+  EXPECT_EQ(index.Size(), 2u);
+  EXPECT_FALSE(index.Contains(1));
+
+  // 2번(1400)과 4번(1045)은 창 밖이라 지금은 묶이지 않는다.
+  EXPECT_FALSE(index.PopMatch(now, 2, out));
+  EXPECT_EQ(index.Size(), 2u);
+}
+
+TEST(MatchmakingIndexTest, LongWaitWidensWindowUntilMatchForms) {
+  server::MatchmakingIndex index(TestConfig());
+  const auto joined = Clock::now();
+  ASSERT_TRUE(index.Add(Ticket(1, 1000, joined)));
+  ASSERT_TRUE(index.Add(Ticket(2, 1180, joined + milliseconds(100))));
+
+  std::vector<server::MatchTicket> out;
+  EXPECT_FALSE(index.PopMatch(joined + seconds(1), 2, out));
+  // 1번이 1.3초 기다리면 창이 180이 되어 2번과 묶인다.
+  ASSERT_TRUE(index.PopMatch(joined + milliseconds(1300), 2, out));
+  EXPECT_EQ(UserIds(out), (std::vector<int>{1, 2}));
+  EXPECT_TRUE(index.Empty());
+}
+
+TEST(MatchmakingIndexTest, FormsLargerSessionsAndSkipsAnchorsThatCannotFill) {
+  server::MatchmakingIndex index(TestConfig());
+  const auto now = Clock::now();
+  // 1번(2000) 주변에는 아무도 없으므로 다음 앵커 2번부터 가까운 세 명을 묶는다.
+  ASSERT_TRUE(index.Add(Ticket(1, 2000, now)));
+  ASSERT_TRUE(index.Add(Ticket(2, 1000, now)));
+  ASSERT_TRUE(index.Add(Ticket(3, 990, now)));
+  ASSERT_TRUE(index.Add(Ticket(4, 1020, now)));
+  ASSERT_TRUE(index.Add(Ticket(5, 1200, now)));
+
+  std::vector<server::MatchTicket> out;
+  ASSERT_TRUE(index.PopMatch(now, 3, out));
+  EXPECT_EQ(UserIds(out), (std::vector<int>{2, 3, 4}));
+  EXPECT_FALSE(index.PopMatch(now, 3, out));
+  EXPECT_TRUE(index.Contains(1));
+  EXPECT_TRUE(index.Contains(5));
+}
+
+TEST(MatchmakingIndexTest, ScanSkipsAnchorsThatAlreadyFailedInThisPass) {
+  server::MatchmakingIndex index(TestConfig());
+  const auto now = Clock::now();
+  // 1번(2000)과 4번(3000)은 창 안에 상대가 없다. 한 번의 재확인에서 (2, 3), (5, 6)을 차례로 묶는다.
+  ASSERT_TRUE(index.Add(Ticket(1, 2000, now)));
+  ASSERT_TRUE(index.Add(Ticket(2, 1000, now)));
+  ASSERT_TRUE(index.Add(Ticket(3, 1010, now)));
+  ASSERT_TRUE(index.Add(Ticket(4, 3000, now)));
+  ASSERT_TRUE(index.Add(Ticket(5, 1500, now)));
+  ASSERT_TRUE(index.Add(Ticket(6, 1510, now)));
+
+  server::MatchmakingIndex::Scan scan;
+  std::vector<server::MatchTicket> out;
+  ASSERT_TRUE(index.PopMatch(now, 2, out, scan));
+  EXPECT_EQ(UserIds(out), (std::vector<int>{2, 3}));
+  ASSERT_TRUE(index.PopMatch(now, 2, out, scan));
+  EXPECT_EQ(UserIds(out), (std::vector<int>{5, 6}));
+  EXPECT_FALSE(index.PopMatch(now, 2, out, scan));
+
+  // 이번 재확인 중에 들어온 티켓은 scan 뒤에 놓이므로 같은 재확인에서 앵커로 시도된다.
+  ASSERT_TRUE(index.Add(Ticket(7, 3020, now)));
+  ASSERT_TRUE(index.PopMatch(now, 2, out, scan));
+  EXPECT_EQ(UserIds(out), (std::vector<int>{7, 4}));
+  EXPECT_EQ(index.Size(), 1u);
+  EXPECT_TRUE(index.Contains(1));
+}
+
+TEST(MatchmakingIndexTest, PopMatchForUsesNewcomerAsAnchorAndHonorsWiderCandidateWindow) {
+  server::MatchmakingIndex index(TestConfig());
+  const auto now = Clock::now();
+  // 1번은 2초를 기다려 창이 250이다. 새로 들어온 3번(1200) 창은 50뿐이지만 1번의 창 안이라 바로 묶인다.
+  ASSERT_TRUE(index.Add(Ticket(1, 1000, now - seconds(2))));
+  ASSERT_TRUE(index.Add(Ticket(2, 1600, now)));
+  ASSERT_TRUE(index.Add(Ticket(3, 1200, now)));
+
+  std::vector<server::MatchTicket> out;
+  ASSERT_TRUE(index.PopMatchFor(3, now, 2, out));
+  EXPECT_EQ(UserIds(out), (std::vector<int>{3, 1}));
+
+  // 4번(1620)은 2번(1600)과 창 50 안이다. 큐에 없는 사용자는 시도하지 않는다.
+  ASSERT_TRUE(index.Add(Ticket(4, 1620, now)));
+  EXPECT_FALSE(index.PopMatchFor(99, now, 2, out));
+  ASSERT_TRUE(index.PopMatchFor(4, now, 2, out));
+  EXPECT_EQ(UserIds(out), (std::vector<int>{4, 2}));
+
+  ASSERT_TRUE(index.Add(Ticket(5, 1000, now)));
+  ASSERT_TRUE(index.Add(Ticket(6, 1300, now)));
+  EXPECT_FALSE(index.PopMatchFor(6, now, 2, out));
+  EXPECT_EQ(index.Size(), 2u);
+}
+
+TEST(MatchmakingIndexTest, PopMatchForSkipsNearCandidatesOutsideWindowToReachWiderOnes) {
+  server::MatchmakingIndex index(TestConfig());
+  const auto now = Clock::now();
+  // 새로 들어온 1번(1000) 바로 위의 2번(1100)은 둘 다 창이 50이라 묶을 수 없다.
+  // 더 먼 3번(1200)은 2초를 기다려 창이 250이므로 1번을 받을 수 있다.
+  ASSERT_TRUE(index.Add(Ticket(3, 1200, now - seconds(2))));
+  ASSERT_TRUE(index.Add(Ticket(2, 1100, now)));
+  ASSERT_TRUE(index.Add(Ticket(4, 850, now)));
+  ASSERT_TRUE(index.Add(Ticket(1, 1000, now)));
+
+  std::vector<server::MatchTicket> out;
+  ASSERT_TRUE(index.PopMatchFor(1, now, 2, out));
+  EXPECT_EQ(UserIds(out), (std::vector<int>{1, 3}));
+  EXPECT_TRUE(index.Contains(2));
+  EXPECT_TRUE(index.Contains(4));
+
+  // 창 상한(300)보다 먼 대기자는 오래 기다렸어도 묶지 않는다.
+  ASSERT_TRUE(index.Add(Ticket(5, 1450, now - seconds(10))));
+  ASSERT_TRUE(index.Add(Ticket(6, 1780, now)));
+  EXPECT_FALSE(index.PopMatchFor(6, now, 2, out));
+}
+
+TEST(MatchmakingIndexTest, PopMatchForWithoutCapReachesOnlyOldestTicketsWindow) {
+  server::MatchmakingConfig uncapped = TestConfig();
+  uncapped.max_window = 0;
+  server::MatchmakingIndex index(uncapped);
+  const auto now = Clock::now();
+  // 상한이 없어도 가장 오래 기다린 3번의 창(5초, 550)까지만 본다. 그 안의 3번(1500)은 1번(1000)을 받는다.
+  ASSERT_TRUE(index.Add(Ticket(3, 1500, now - seconds(5))));
+  ASSERT_TRUE(index.Add(Ticket(2, 1100, now)));
+  ASSERT_TRUE(index.Add(Ticket(1, 1000, now)));
+
+  std::vector<server::MatchTicket> out;
+  ASSERT_TRUE(index.PopMatchFor(1, now, 2, out));
+  EXPECT_EQ(UserIds(out), (std::vector<int>{1, 3}));
+
+  // 세션을 만들지 못해 다시 넣은 티켓은 새 순번을 받아도 원래 입장 시각의 창을 가진다.
+  ASSERT_TRUE(index.Add(Ticket(4, 3000, now)));
+  ASSERT_TRUE(index.Add(Ticket(5, 2200, now - seconds(8))));
+  ASSERT_TRUE(index.PopMatchFor(4, now, 2, out));
+  EXPECT_EQ(UserIds(out), (std::vector<int>{4, 5}));
+
+  // 남은 대기자 중 가장 넓은 창(2번, 50)보다 먼 입장자는 묶지 않는다.
+  ASSERT_TRUE(index.Add(Ticket(6, 9000, now)));
+  EXPECT_FALSE(index.PopMatchFor(6, now, 2, out));
+  EXPECT_TRUE(index.Contains(2));
+  EXPECT_TRUE(index.Contains(6));
+}
+
+TEST(MatchmakingIndexTest, RemoveAndExpireDropTicketsFromIndex) {
+  server::MatchmakingIndex index(TestConfig());
+  const auto now = Clock::now();
+  ASSERT_TRUE(index.Add(Ticket(1, 1000, now - seconds(40))));
+  ASSERT_TRUE(index.Add(Ticket(2, 1000, now)));
+  ASSERT_TRUE(index.Add(Ticket(3, 1000, now)));
+
+  EXPECT_TRUE(index.Remove(3));
+  EXPECT_FALSE(index.Remove(3));
+  std::vector<server::MatchTicket> expired;
+  EXPECT_EQ(index.RemoveExpired(now, expired), 1u);
+  EXPECT_EQ(UserIds(expired), (std::vector<int>{1}));
+  EXPECT_EQ(index.Size(), 1u);
+
+  std::vector<server::MatchTicket> out;
+  EXPECT_FALSE(index.PopMatch(now, 2, out));
+  ASSERT_TRUE(index.Add(Ticket(1, 1010, now)));
+  ASSERT_TRUE(index.PopMatch(now, 2, out));
+  EXPECT_EQ(UserIds(out), (std::vector<int>{2, 1}));
+}
+
+TEST(MatchmakingIndexTest, ExpiresByDeadlineOrderNotJoinOrder) {
+  server::MatchmakingIndex index(TestConfig());
+  const auto now = Clock::now();
+  // 사용자별 타임아웃이 달라 입장 순서와 만료 순서가 다르다.
+  ASSERT_TRUE(index.Add(server::MatchTicket{1, "user1", 1000, now, now + seconds(30)}));
+  ASSERT_TRUE(index.Add(server::MatchTicket{2, "user2", 3000, now, now + seconds(5)}));
+  ASSERT_TRUE(index.Add(server::MatchTicket{3, "user3", 5000, now, now + seconds(10)}));
+  ASSERT_TRUE(index.Add(server::MatchTicket{4, "user4", 7000, now, now + seconds(3)}));
+
+  // 취소된 티켓의 힙 항목은 꺼낼 때 건너뛴다. 같은 사용자가 다시 들어오면 새 만료 시각을 따른다.
+  ASSERT_TRUE(index.Remove(4));
+  ASSERT_TRUE(index.Add(server::MatchTicket{4, "user4", 7000, now, now + seconds(20)}));
+
+  std::vector<server::MatchTicket> expired;
+  EXPECT_EQ(index.RemoveExpired(now + seconds(4), expired), 0u);
+  EXPECT_EQ(index.RemoveExpired(now + seconds(11), expired), 2u);
+  EXPECT_EQ(UserIds(expired), (std::vector<int>{2, 3}));
+  EXPECT_EQ(index.Size(), 2u);
+
+  expired.clear();
+  EXPECT_EQ(index.RemoveExpired(now + seconds(60), expired), 2u);
+  EXPECT_EQ(UserIds(expired), (std::vector<int>{4, 1}));
+  EXPECT_TRUE(index.Empty());
+}
+
+TEST(MatchmakingIndexTest, ExpirySkipsTicketsMatchedDuringChurn) {
+  server::MatchmakingIndex index(TestConfig());
+  const auto now = Clock::now();
+  // 매치/취소를 반복해도 죽은 힙 항목이 다시 쌓이면서 치워지고, 만료는 살아 있는 티켓만 돌려준다.
+  std::vector<server::MatchTicket> out;
+  for (int round = 0; round < 1000; ++round) {
+    ASSERT_TRUE(index.Add(Ticket(round * 2 + 1, 1000, now)));
+    ASSERT_TRUE(index.Add(Ticket(round * 2 + 2, 1000, now)));
+    ASSERT_TRUE(index.PopMatchFor(round * 2 + 2, now, 2, out));
+  }
+  ASSERT_TRUE(index.Add(Ticket(5000, 1000, now)));
+  std::vector<server::MatchTicket> expired;
+  EXPECT_EQ(index.RemoveExpired(now + seconds(31), expired), 1u);
+  EXPECT_EQ(UserIds(expired), (std::vector<int>{5000}));
+}
+
+}  // namespace
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "server/metrics_registry.hpp"
+
+namespace {
+
+TEST(MetricsRegistryTest, SumsPerThreadShardsOnScrape) {
+  server::MetricsRegistry registry;
+  constexpr int kThreads = 4;
+  constexpr int kIncrements = 10000;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&registry]() {
+      for (int i = 0; i < kIncrements; ++i) {
+        registry.Add(server::Counter::kRequestTotal);
+      }
+      registry.Add(server::Counter::kRequestErrors, 2);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // 스레드가 종료된 뒤에도 슬롯 누적값은 유지된다.
+  EXPECT_EQ(registry.Sum(server::Counter::kRequestTotal), kThreads * kIncrements);
+  EXPECT_EQ(registry.Sum(server::Counter::kRequestErrors), kThreads * 2);
+  EXPECT_EQ(registry.ShardCount(), static_cast<std::size_t>(kThreads));
+}
+
+TEST(MetricsRegistryTest, GaugeDeltasFromDifferentThreadsCancelOut) {
+  server::MetricsRegistry registry;
+  std::thread opener([&registry]() {
+    registry.Add(server::Counter::kWebsocketActive, 1);
+    registry.Add(server::Counter::kWebsocketActive, 1);
+  });
+  opener.join();
+  std::thread closer([&registry]() { registry.Add(server::Counter::kWebsocketActive, -1); });
+  closer.join();
+
+  EXPECT_EQ(registry.Sum(server::Counter::kWebsocketActive), 1);
+}
+
+TEST(MetricsRegistryTest, RegistriesDoNotShareThreadSlots) {
+  server::MetricsRegistry first;
+  server::MetricsRegistry second;
+  first.Add(server::Counter::kRequestTotal, 3);
+  second.Add(server::Counter::kRequestTotal, 5);
+  first.Add(server::Counter::kRequestTotal);
+
+  EXPECT_EQ(first.Sum(server::Counter::kRequestTotal), 4);
+  EXPECT_EQ(second.Sum(server::Counter::kRequestTotal), 5);
+  EXPECT_EQ(first.ShardCount(), 1u);
+
+  {
+    // 소멸된 레지스트리의 캐시 항목이 새 레지스트리에 재사용되지 않아야 한다.
+    server::MetricsRegistry scoped;
+    scoped.Add(server::Counter::kRequestErrors);
+  }
+  server::MetricsRegistry fresh;
+  EXPECT_EQ(fresh.Sum(server::Counter::kRequestErrors), 0);
+  fresh.Add(server::Counter::kRequestErrors);
+  EXPECT_EQ(fresh.Sum(server::Counter::kRequestErrors), 1);
+}
+
+}  // namespace
@@ -22,4 +22,32 @@ TEST(RatingServiceTest, ApplyMatchUpdatesBothPlayers) {
   EXPECT_EQ(loser->matches(), 1);
 }
 
+TEST(RatingServiceTest, RankedResultWithTwoPlayersMatchesHeadToHead) {
+  server::RatingService service;
+  auto summaries = service.ApplyRankedResult({1, 2});
+  ASSERT_EQ(summaries.size(), 2u);
+  EXPECT_EQ(summaries[0].rating, 1016);
+  EXPECT_EQ(summaries[1].rating, 984);
+}
+
+TEST(RatingServiceTest, RankedResultSplitsKAcrossOpponents) {
+  server::RatingService service;
+  // 동일 레이팅 4인: 쌍마다 K/3 * 0.5 → 1위 +16, 2위 +16/3, 3위 -16/3, 4위 -16.
+  auto summaries = service.ApplyRankedResult({4, 3, 2, 1});
+  ASSERT_EQ(summaries.size(), 4u);
+  EXPECT_EQ(summaries[0].user_id, 4);
+  EXPECT_EQ(summaries[0].rating, 1016);
+  EXPECT_EQ(summaries[1].rating, 1005);
+  EXPECT_EQ(summaries[2].rating, 995);
+  EXPECT_EQ(summaries[3].rating, 984);
+  EXPECT_EQ(summaries[0].wins, 1);
+  EXPECT_EQ(summaries[3].losses, 1);
+
+  int total = 0;
+  for (const auto& summary : summaries) {
+    total += summary.rating;
+  }
+  EXPECT_EQ(total, 4000);
+}
+
 }  // namespace
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "server/result_service.hpp"
+#include "server/wake_signal.hpp"
+
+namespace {
+
+server::MatchResultRecord MakeRecord(const std::string& session_id, std::vector<int> ranked) {
+  const int winner = ranked.front();
+  return server::MatchResultRecord{session_id, std::move(ranked), winner, 5, std::chrono::system_clock::now(), {}, {}};
+}
+
+TEST(ResultServiceTest, SubmitWithoutFinalizerAppliesInline) {
+  auto ratings = std::make_shared<server::RatingService>();
+  server::ResultService service(std::make_shared<server::ResultRepository>(), ratings);
+
+  service.Submit(MakeRecord("session-1", {1, 2}), {{1, "alpha"}, {2, "beta"}});
+  EXPECT_EQ(service.Count(), 1u);
+  EXPECT_EQ(service.PendingCount(), 0u);
+  ASSERT_TRUE(ratings->GetSummary(1).has_value());
+  EXPECT_EQ(ratings->GetSummary(1)->rating, 1016);
+  EXPECT_EQ(ratings->GetSummary(1)->username, "alpha");
+}
+
+// 여러 스레드가 동시에 제출해도 모두 반영되고, 같은 session_id는 배치 안팎에서 한 번만 레이팅에 반영된다.
+TEST(ResultServiceTest, ConcurrentSubmitsAreAppliedOnceInBatches) {
+  auto ratings = std::make_shared<server::RatingService>();
+  auto observability = std::make_shared<server::Observability>(1);
+  server::ResultService service(std::make_shared<server::ResultRepository>(), ratings);
+  service.SetObservability(observability);
+  service.Start();
+
+  constexpr int kThreads = 4;
+  constexpr int kMatchesPerThread = 200;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&service, t]() {
+      for (int i = 0; i < kMatchesPerThread; ++i) {
+        const int base = (t * kMatchesPerThread + i) * 2 + 1;
+        const auto session_id = "session-" + std::to_string(base);
+        // 각 결과를 두 번씩 제출해 재전송을 흉내 낸다.
+        service.Submit(MakeRecord(session_id, {base, base + 1}), {{base, "w"}, {base + 1, "l"}});
+        service.Submit(MakeRecord(session_id, {base + 1, base}), {{base, "w"}, {base + 1, "l"}});
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  service.Stop();
+
+  EXPECT_EQ(service.PendingCount(), 0u);
+  EXPECT_EQ(service.Count(), static_cast<std::size_t>(kThreads * kMatchesPerThread));
+  for (int user = 1; user <= kThreads * kMatchesPerThread * 2; user += 2) {
+    auto winner = ratings->GetSummary(user);
+    ASSERT_TRUE(winner.has_value());
+    // 먼저 제출된 결과만 반영된다.
+    EXPECT_EQ(winner->rating, 1016);
+    EXPECT_EQ(winner->wins + winner->losses, 1);
+  }
+  EXPECT_FALSE(service.FinalizeResult(MakeRecord("session-1", {1, 2}), {{1, "w"}, {2, "l"}}));
+
+  auto json = observability->ResultFinalizerJson(service.PendingCount());
+  EXPECT_EQ(json["records"].get<std::uint64_t>(), static_cast<std::uint64_t>(kThreads * kMatchesPerThread));
+  EXPECT_EQ(json["duplicates"].get<std::uint64_t>(), static_cast<std::uint64_t>(kThreads * kMatchesPerThread) + 1);
+  EXPECT_GE(json["batches"].get<std::uint64_t>(), 1u);
+  EXPECT_EQ(json["lag"]["count"].get<std::uint64_t>(), static_cast<std::uint64_t>(kThreads * kMatchesPerThread));
+}
+
+// 소비자가 잠들기 전에 온 신호도 다음 대기에서 받는다. 신호 하나는 한 번만 소비된다.
+TEST(WakeSignalTest, NotifyBeforeWaitIsNotLost) {
+  server::WakeSignal signal;
+  signal.Notify();
+  EXPECT_TRUE(signal.WaitUntil(server::WakeSignal::Clock::now()));
+  EXPECT_FALSE(signal.WaitUntil(server::WakeSignal::Clock::now()));
+
+  std::thread producer([&signal]() { signal.Notify(); });
+  signal.Wait();
+  producer.join();
+}
+
+}  // namespace
@@ -0,0 +1,274 @@
+#include <gtest/gtest.h>
+
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+
+#include "server/session_manager.hpp"
+
+namespace {
+
+std::shared_ptr<server::SessionManager> MakeManager(boost::asio::io_context& ioc) {
+  auto result_service = std::make_shared<server::ResultService>(std::make_shared<server::ResultRepository>(),
+                                                                std::make_shared<server::RatingService>());
+  return std::make_shared<server::SessionManager>(ioc, std::make_shared<server::RealtimeCoordinator>(),
+                                                  result_service, std::chrono::milliseconds(100), 5);
+}
+
+// 참가자 1, 2가 2틱 진행한 세션의 이전 단위.
+server::SessionExport ExportOf(const std::string& migration_id) {
+  server::SessionExport exported;
+  exported.migration_id = migration_id;
+  exported.participants = {{1, "a"}, {2, "b"}};
+  server::InputJournal journal;
+  journal.Begin({1, 2}, 0);
+  journal.Finish(2);
+  exported.journal = journal.Bytes();
+  server::Simulation replayed;
+  server::ReplayJournal(exported.journal, replayed);
+  exported.tick = replayed.CurrentTick();
+  exported.state_hash = replayed.StateHash();
+  return exported;
+}
+
+TEST(SessionManagerTest, FormatsWireIdOnlyFromIntegerId) {
+  EXPECT_EQ(server::FormatSessionId(1), "session-1");
+  EXPECT_EQ(server::FormatSessionId(18446744073709551615ULL), "session-18446744073709551615");
+}
+
+TEST(SessionManagerTest, RejectsEmptyAndOversizedSessions) {
+  boost::asio::io_context ioc;
+  auto manager = MakeManager(ioc);
+  EXPECT_EQ(manager->CreateSession({}), server::kInvalidSessionId);
+  std::vector<server::SessionParticipant> crowd;
+  for (int user = 1; user <= static_cast<int>(server::SessionManager::kMaxSessionPlayers) + 1; ++user) {
+    crowd.push_back({user, "u"});
+  }
+  EXPECT_EQ(manager->CreateSession(crowd), server::kInvalidSessionId);
+  EXPECT_EQ(manager->ActiveSessionCount(), 0u);
+}
+
+// 이미 세션에 매핑된 사용자가 섞인 세션은 만들지 않고, 기존 매핑과 다른 참가자의 상태도 그대로 둔다.
+TEST(SessionManagerTest, RejectsParticipantAlreadyInSession) {
+  boost::asio::io_context ioc;
+  auto manager = MakeManager(ioc);
+  const auto first = manager->CreateSession({{1, "a"}, {2, "b"}});
+  ASSERT_NE(first, server::kInvalidSessionId);
+
+  EXPECT_EQ(manager->CreateSession({{3, "c"}, {2, "b"}}), server::kInvalidSessionId);
+  EXPECT_EQ(manager->ActiveSessionCount(), 1u);
+  EXPECT_FALSE(manager->IsUserInSession(3));
+  EXPECT_TRUE(manager->IsUserInSession(2));
+
+  EXPECT_NE(manager->CreateSession({{3, "c"}, {4, "d"}}), server::kInvalidSessionId);
+  EXPECT_EQ(manager->ActiveSessionCount(), 2u);
+}
+
+// 이전 단위는 요청 본문에서 오므로, 저널 헤더 참가자가 다르거나 틱이 세션 상한을 넘으면 재생/등록 없이 거절한다.
+TEST(SessionManagerTest, ImportRejectsJournalThatDoesNotMatchExport) {
+  boost::asio::io_context ioc;
+  auto manager = MakeManager(ioc);
+  server::SessionExport exported;
+  exported.migration_id = "m-1";
+  exported.participants = {{1, "a"}, {2, "b"}};
+  server::InputJournal journal;
+  journal.Begin({1, 3}, 0);
+  exported.journal = journal.Bytes();
+  std::string code;
+  std::string message;
+  EXPECT_EQ(manager->ImportSession(exported, code, message), server::kInvalidSessionId);
+  EXPECT_EQ(code, "migration_invalid");
+
+  journal.Begin({1, 2}, 0);
+  journal.Finish(1'000'000);
+  exported.journal = journal.Bytes();
+  code.clear();
+  EXPECT_EQ(manager->ImportSession(exported, code, message), server::kInvalidSessionId);
+  EXPECT_EQ(code, "migration_invalid");
+  EXPECT_NE(message.find("tick_out_of_range"), std::string::npos);
+  EXPECT_EQ(manager->ActiveSessionCount(), 0u);
+  EXPECT_FALSE(manager->IsUserInSession(1));
+}
+
+// 같은 참가자를 가진 세션이 이미 있으면 이전을 받지 않는다.
+TEST(SessionManagerTest, ImportRejectsParticipantAlreadyInSession) {
+  boost::asio::io_context ioc;
+  auto manager = MakeManager(ioc);
+  ASSERT_NE(manager->CreateSession({{2, "b"}, {5, "e"}}), server::kInvalidSessionId);
+
+  server::SessionExport exported;
+  exported.migration_id = "m-1";
+  exported.participants = {{1, "a"}, {2, "b"}};
+  server::InputJournal journal;
+  journal.Begin({1, 2}, 0);
+  exported.journal = journal.Bytes();
+  std::string code;
+  std::string message;
+  EXPECT_EQ(manager->ImportSession(exported, code, message), server::kInvalidSessionId);
+  EXPECT_EQ(code, "migration_conflict");
+  EXPECT_EQ(manager->ActiveSessionCount(), 1u);
+  EXPECT_FALSE(manager->IsUserInSession(1));
+}
+
+// 응답을 받지 못한 원본이 같은 migrationId로 다시 보내면 두 번째 사본을 만들지 않고 받은 세션을 돌려준다.
+TEST(SessionManagerTest, ImportIsIdempotentOnMigrationId) {
+  boost::asio::io_context ioc;
+  auto manager = MakeManager(ioc);
+  std::string code;
+  std::string message;
+  const auto first = manager->ImportSession(ExportOf("m-1"), code, message);
+  ASSERT_NE(first, server::kInvalidSessionId) << message;
+  EXPECT_EQ(manager->ImportSession(ExportOf("m-1"), code, message), first);
+  EXPECT_EQ(manager->ActiveSessionCount(), 1u);
+
+  // 같은 id라도 참가자가 다르면 토큰을 다시 발급하지 않는다.
+  auto other = ExportOf("m-1");
+  other.participants = {{1, "a"}, {3, "c"}};
+  EXPECT_EQ(manager->ImportSession(other, code, message), server::kInvalidSessionId);
+  EXPECT_EQ(code, "migration_invalid");
+
+  EXPECT_EQ(manager->ImportSession(ExportOf("m-2"), code, message), server::kInvalidSessionId);
+  EXPECT_EQ(code, "migration_conflict");
+}
+
+// 취소한 이전은 아무도 복귀하지 않았으면 내리고, 이후 같은 id로 온 요청은 받지 않는다.
+// 받은 적 없는 id의 취소도 표시를 남겨 늦게 도착한 요청이 사본을 만들지 못하게 한다.
+TEST(SessionManagerTest, AbortImportDropsUnresumedCopyAndRejectsLateImports) {
+  boost::asio::io_context ioc;
+  auto work = boost::asio::make_work_guard(ioc);
+  std::thread runner([&ioc]() { ioc.run(); });
+  auto manager = MakeManager(ioc);
+  std::string code;
+  std::string message;
+  ASSERT_NE(manager->ImportSession(ExportOf("m-1"), code, message), server::kInvalidSessionId) << message;
+
+  EXPECT_TRUE(manager->AbortImport("m-1", code, message));
+  EXPECT_EQ(manager->ActiveSessionCount(), 0u);
+  EXPECT_FALSE(manager->IsUserInSession(1));
+  EXPECT_EQ(manager->ImportSession(ExportOf("m-1"), code, message), server::kInvalidSessionId);
+  EXPECT_EQ(code, "migration_aborted");
+
+  EXPECT_TRUE(manager->AbortImport("m-2", code, message));
+  EXPECT_EQ(manager->ImportSession(ExportOf("m-2"), code, message), server::kInvalidSessionId);
+  EXPECT_EQ(code, "migration_aborted");
+
+  EXPECT_NE(manager->ImportSession(ExportOf("m-3"), code, message), server::kInvalidSessionId);
+  work.reset();
+  ioc.stop();
+  runner.join();
+}
+
+// 참가자가 복귀한 세션은 이 서버가 진행하는 사본이므로 취소하지 않는다.
+TEST(SessionManagerTest, AbortImportRefusesCopyAfterResume) {
+  boost::asio::io_context ioc;
+  auto work = boost::asio::make_work_guard(ioc);
+  std::thread runner([&ioc]() { ioc.run(); });
+  auto manager = MakeManager(ioc);
+  std::string code;
+  std::string message;
+  const auto id = manager->ImportSession(ExportOf("m-1"), code, message);
+  ASSERT_NE(id, server::kInvalidSessionId) << message;
+  ASSERT_TRUE(manager->ResumeMigratedUser(1, server::FormatSessionId(id), code, message)) << message;
+
+  EXPECT_FALSE(manager->AbortImport("m-1", code, message));
+  EXPECT_EQ(code, "migration_committed");
+  EXPECT_TRUE(manager->IsUserInSession(1));
+  EXPECT_EQ(manager->ImportSession(ExportOf("m-1"), code, message), id);
+  work.reset();
+  ioc.stop();
+  runner.join();
+}
+
+// io_context를 돌리지 않으므로 세션은 시작/종료되지 않고 등록 상태로 남는다.
+TEST(SessionManagerTest, ConcurrentCreatesAcrossShardsKeepCountAndUserMapping) {
+  boost::asio::io_context ioc;
+  auto manager = MakeManager(ioc);
+  constexpr int kThreads = 8;
+  constexpr int kSessionsPerThread = 250;
+
+  std::vector<std::vector<server::SessionId>> ids(kThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kSessionsPerThread; ++i) {
+        const int base = (t * kSessionsPerThread + i) * 2 + 1;
+        ids[t].push_back(manager->CreateSession({{base, "a"}, {base + 1, "b"}}));
+        EXPECT_TRUE(manager->IsUserInSession(base));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::set<server::SessionId> unique;
+  for (const auto& per_thread : ids) {
+    unique.insert(per_thread.begin(), per_thread.end());
+  }
+  EXPECT_EQ(unique.size(), static_cast<std::size_t>(kThreads * kSessionsPerThread));
+  EXPECT_EQ(unique.count(server::kInvalidSessionId), 0u);
+  EXPECT_EQ(manager->ActiveSessionCount(), static_cast<std::size_t>(kThreads * kSessionsPerThread));
+  EXPECT_TRUE(manager->IsUserInSession(kThreads * kSessionsPerThread * 2));
+  EXPECT_FALSE(manager->IsUserInSession(kThreads * kSessionsPerThread * 2 + 1));
+}
+
+// 같은 레인의 같은 간격 세션은 같은 격자 시각에 만기되어 레인 패스 하나에서 함께 진행된다.
+TEST(SessionManagerTest, SessionsSharingLaneAndIntervalStepInOnePass) {
+  boost::asio::io_context ioc;
+  auto result_service = std::make_shared<server::ResultService>(std::make_shared<server::ResultRepository>(),
+                                                                std::make_shared<server::RatingService>());
+  auto manager = std::make_shared<server::SessionManager>(ioc, std::make_shared<server::RealtimeCoordinator>(),
+                                                          result_service, std::chrono::milliseconds(20), 5);
+  auto observability = std::make_shared<server::Observability>();
+  manager->SetObservability(observability);
+
+  // 레인마다 세션 128개씩 들어가도록 만든다. 패스는 조각(kLaneSliceSessions) 여러 개로 나뉘어도 한 번으로 센다.
+  constexpr int kSessions = 2048;
+  for (int i = 0; i < kSessions; ++i) {
+    ASSERT_NE(manager->CreateSession({{i * 2 + 1, "a"}, {i * 2 + 2, "b"}}), server::kInvalidSessionId);
+  }
+  ioc.run();
+  EXPECT_EQ(manager->ActiveSessionCount(), 0u);
+
+  const auto batch = observability->TickBatchJson();
+  EXPECT_EQ(batch["sessions"].get<std::uint64_t>(), static_cast<std::uint64_t>(kSessions * 5));
+  // 생성 중에 격자 경계를 넘은 세션은 첫 틱만 따로 돌고 다음 틱부터 합류하므로, 패스는 틱 수보다 훨씬 적다.
+  EXPECT_LE(batch["passes"].get<std::uint64_t>(), static_cast<std::uint64_t>(kSessions * 5 / 2));
+  EXPECT_GT(batch["sessionsPerPass"].get<double>(), 64.0);
+}
+
+// 종료된 세션의 컨텍스트는 풀로 돌아가고, 다음 세션 생성 시 새로 할당하지 않고 재사용된다.
+TEST(SessionManagerTest, FinishedContextsAreRecycledForNextSession) {
+  boost::asio::io_context ioc;
+  auto result_service = std::make_shared<server::ResultService>(std::make_shared<server::ResultRepository>(),
+                                                                std::make_shared<server::RatingService>());
+  auto manager = std::make_shared<server::SessionManager>(ioc, std::make_shared<server::RealtimeCoordinator>(),
+                                                          result_service, std::chrono::milliseconds(1), 2);
+
+  const auto first = manager->CreateSession({{1, "a"}, {2, "b"}});
+  ASSERT_NE(first, server::kInvalidSessionId);
+  ioc.run();
+  EXPECT_EQ(manager->ActiveSessionCount(), 0u);
+  EXPECT_EQ(manager->PooledContextCount(), 1u);
+  EXPECT_FALSE(manager->IsUserInSession(1));
+
+  const auto second = manager->CreateSession({{3, "c"}, {4, "d"}, {5, "e"}});
+  ASSERT_NE(second, server::kInvalidSessionId);
+  EXPECT_NE(second, first);
+  EXPECT_EQ(manager->PooledContextCount(), 0u);
+  EXPECT_TRUE(manager->IsUserInSession(5));
+  ioc.restart();
+  ioc.run();
+  EXPECT_EQ(manager->PooledContextCount(), 1u);
+  EXPECT_EQ(manager->PoolHighWater(), 1u);
+
+  const auto stored = result_service->Find(server::FormatSessionId(second));
+  ASSERT_TRUE(stored.has_value());
+  EXPECT_EQ(stored->ranked_user_ids.size(), 3u);
+}
+
+}  // namespace
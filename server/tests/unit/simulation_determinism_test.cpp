@@ -1,9 +1,33 @@
 #include <gtest/gtest.h>
 
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
 #include "server/simulation.hpp"
 
 namespace {
 
+// 틱 진행 중 힙 할당 여부를 확인하기 위해 전역 operator new 호출 수를 센다.
+std::atomic<std::size_t> g_allocations{0};
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace {
+
 std::vector<server::InputCommand> BuildInputSequence() {
   return {
       {1, 1, 1, 1}, {2, 1, -1, 1}, {1, 2, 1, 2}, {2, 2, 1, 2}, {1, 3, -1, 3}, {2, 4, 2, 3}};
@@ -61,3 +85,215 @@ TEST(SimulationTickLoopTest, RunsForDurationWithoutRunaway) {
   EXPECT_GE(produced, 6);
   EXPECT_LE(produced, 10);
 }
+
+TEST(SimulationDeterminismTest, KeepsUserOrderWhenPlayersArriveOutOfOrder) {
+  server::Simulation sim;
+  sim.AddPlayer(7);
+  ASSERT_TRUE(sim.EnqueueInput({7, 2, 2, 1}).accepted);
+  // 더 작은 user_id가 나중에 들어와도 대기 중인 입력은 원래 플레이어에게 적용된다.
+  ASSERT_TRUE(sim.EnqueueInput({3, 2, -1, 1}).accepted);
+  sim.AddPlayer(5);
+
+  sim.TickOnce();
+  nlohmann::json after_first{{"tick", 1},
+                             {"players", nlohmann::json::array({{{"userId", 5}, {"position", 0}, {"lastSequence", 0}},
+                                                                {{"userId", 7}, {"position", 0}, {"lastSequence", 0}}})}};
+  EXPECT_EQ(sim.Snapshot(), after_first);
+
+  sim.TickOnce();
+  nlohmann::json after_second{{"tick", 2},
+                              {"players", nlohmann::json::array({{{"userId", 3}, {"position", -1}, {"lastSequence", 1}},
+                                                                 {{"userId", 5}, {"position", 0}, {"lastSequence", 0}},
+                                                                 {{"userId", 7}, {"position", 2}, {"lastSequence", 1}}})}};
+  EXPECT_EQ(sim.Snapshot(), after_second);
+}
+
+TEST(SimulationDeterminismTest, RejectsInputsBeyondPerTickLimit) {
+  server::Simulation sim;
+  sim.AddPlayer(1);
+  for (std::uint64_t seq = 1; seq <= server::Simulation::kMaxInputsPerTickPerUser; ++seq) {
+    ASSERT_TRUE(sim.EnqueueInput({1, 1, 1, seq}).accepted);
+  }
+  auto rejected = sim.EnqueueInput({1, 1, 1, 10});
+  EXPECT_FALSE(rejected.accepted);
+  EXPECT_EQ(rejected.reason, "tick_input_limit");
+  EXPECT_TRUE(sim.EnqueueInput({1, 2, 1, 11}).accepted);
+  EXPECT_EQ(sim.EnqueueInput({1, 3, 1, 11}).reason, "sequence_not_monotonic");
+}
+
+TEST(SimulationDeterminismTest, RejectsInputsBeyondHorizon) {
+  server::Simulation sim;
+  sim.AddPlayer(1);
+  EXPECT_TRUE(sim.EnqueueInput({1, server::Simulation::kInputHorizonTicks, 1, 1}).accepted);
+  auto rejected = sim.EnqueueInput({1, server::Simulation::kInputHorizonTicks + 1, 1, 2});
+  EXPECT_FALSE(rejected.accepted);
+  EXPECT_EQ(rejected.reason, "tick_out_of_window");
+
+  sim.TickOnce();
+  // 한 틱이 지나면 창이 한 칸 이동한다.
+  EXPECT_TRUE(sim.EnqueueInput({1, server::Simulation::kInputHorizonTicks + 1, 1, 3}).accepted);
+}
+
+TEST(SimulationDeterminismTest, RecyclesRingBucketsWithoutAllocating) {
+  server::Simulation sim;
+  sim.AddPlayer(1);
+  sim.AddPlayer(2);
+
+  std::uint64_t sequence = 0;
+  auto run_ticks = [&](int ticks) {
+    for (int i = 0; i < ticks; ++i) {
+      const int target = sim.CurrentTick() + 1 + (i % 4);
+      ASSERT_TRUE(sim.EnqueueInput({1, target, 1, ++sequence}).accepted);
+      ASSERT_TRUE(sim.EnqueueInput({2, target, -1, sequence}).accepted);
+      sim.TickOnce();
+    }
+  };
+
+  // 링을 한 바퀴 이상 돌려 모든 버킷을 재사용한 뒤 할당 여부를 측정한다.
+  run_ticks(server::Simulation::kInputHorizonTicks * 2);
+  const auto before = g_allocations.load();
+  run_ticks(server::Simulation::kInputHorizonTicks * 2);
+  EXPECT_EQ(g_allocations.load(), before);
+
+  // 나중 틱을 겨냥한 입력까지 적용되도록 창을 비운다.
+  for (int i = 0; i < 4; ++i) {
+    sim.TickOnce();
+  }
+  auto snapshot = sim.Snapshot();
+  const auto total = static_cast<int>(sequence);
+  EXPECT_EQ(snapshot["players"][0]["position"], total);
+  EXPECT_EQ(snapshot["players"][1]["position"], -total);
+}
+
+TEST(SimulationDeterminismTest, SnapshotViewMatchesJsonSnapshot) {
+  server::Simulation sim;
+  ApplySequence(sim, BuildInputSequence());
+
+  const auto view = sim.View();
+  EXPECT_EQ(view.Tick(), 4);
+  std::vector<server::PlayerView> players;
+  view.ForEachPlayer([&players](const server::PlayerView& player) { players.push_back(player); });
+  ASSERT_EQ(players.size(), 2u);
+  EXPECT_EQ(players[0].user_id, 1);
+  EXPECT_EQ(players[0].position, 1);
+  EXPECT_EQ(players[1].user_id, 2);
+  EXPECT_EQ(players[1].last_sequence, 3u);
+  EXPECT_EQ(server::SnapshotToJson(view), sim.Snapshot());
+}
+
+TEST(SimulationRollbackTest, LateInputsResimulateToOnTimeResult) {
+  auto sequence = BuildInputSequence();
+
+  server::Simulation on_time;
+  ApplySequence(on_time, sequence);
+
+  server::Simulation late;
+  late.EnableRollback(8);
+  // 모든 입력이 목표 틱보다 늦게(틱 4 이후) 도착한다.
+  for (int i = 0; i < 4; ++i) {
+    late.TickOnce();
+  }
+  for (const auto& input : sequence) {
+    auto result = late.EnqueueInput(input);
+    ASSERT_TRUE(result.accepted) << result.reason;
+  }
+  EXPECT_EQ(late.PendingCorrectionTick(), 1);
+  EXPECT_EQ(late.Resimulate(), 4);
+  EXPECT_EQ(late.PendingCorrectionTick(), 0);
+  EXPECT_EQ(late.Snapshot(), on_time.Snapshot());
+
+  // 정정 이후 진행도 같아야 한다.
+  ASSERT_TRUE(late.EnqueueInput({1, 5, 3, 10}).accepted);
+  ASSERT_TRUE(on_time.EnqueueInput({1, 5, 3, 10}).accepted);
+  late.TickOnce();
+  on_time.TickOnce();
+  EXPECT_EQ(late.Snapshot(), on_time.Snapshot());
+}
+
+TEST(SimulationRollbackTest, RejectsInputsOutsideRollbackWindow) {
+  server::Simulation sim;
+  sim.EnableRollback(4);
+  sim.AddPlayer(1);
+  for (int i = 0; i < 10; ++i) {
+    sim.TickOnce();
+  }
+  EXPECT_EQ(sim.EnqueueInput({1, 6, 1, 1}).reason, "stale_tick");
+  EXPECT_TRUE(sim.EnqueueInput({1, 7, 1, 2}).accepted);
+  // 미래 범위는 링을 과거 창과 나눠 쓰므로 kInputHorizonTicks - 창 크기까지다.
+  EXPECT_EQ(sim.EnqueueInput({1, 10 + server::Simulation::kInputHorizonTicks - 3, 1, 3}).reason,
+            "tick_out_of_window");
+  EXPECT_TRUE(sim.EnqueueInput({1, 10 + server::Simulation::kInputHorizonTicks - 4, 1, 4}).accepted);
+
+  // 늦은 입력은 TickOnce 진행 전에 반영된다.
+  sim.TickOnce();
+  EXPECT_EQ(sim.Snapshot()["players"][0]["position"], 1);
+  EXPECT_EQ(sim.PendingCorrectionTick(), 0);
+}
+
+TEST(SimulationStateHashTest, HashIsOrderStableAndTracksState) {
+  auto sequence = BuildInputSequence();
+  server::Simulation sim_a;
+  server::Simulation sim_b;
+  sim_a.AddPlayer(1);
+  sim_a.AddPlayer(2);
+  // 입장 순서가 달라도 슬롯이 user_id 순이므로 해시가 같다.
+  sim_b.AddPlayer(2);
+  sim_b.AddPlayer(1);
+  EXPECT_EQ(sim_a.StateHash(), sim_b.StateHash());
+
+  ApplySequence(sim_a, sequence);
+  ApplySequence(sim_b, sequence);
+  EXPECT_EQ(sim_a.StateHash(), sim_b.StateHash());
+
+  // 계약 문서의 규칙(FNV-1a 64비트 워드 + 상위 32비트 접기)으로 클라이언트가 재현할 수 있어야 한다.
+  auto mix = [](std::uint64_t hash, std::uint64_t word) {
+    hash = (hash ^ word) * 0x100000001b3ULL;
+    return hash ^ (hash >> 32);
+  };
+  std::uint64_t expected = mix(0xcbf29ce484222325ULL, 4);
+  for (auto [user_id, position, last_sequence] : {std::array<std::uint64_t, 3>{1, 1, 3}, {2, 2, 3}}) {
+    expected = mix(mix(mix(expected, user_id), position), last_sequence);
+  }
+  EXPECT_EQ(sim_a.StateHash(), expected);
+
+  const auto before = sim_a.StateHash();
+  ASSERT_TRUE(sim_a.EnqueueInput({1, 5, -1, 4}).accepted);
+  sim_a.TickOnce();
+  sim_b.TickOnce();
+  EXPECT_NE(sim_a.StateHash(), before);
+  EXPECT_NE(sim_a.StateHash(), sim_b.StateHash());
+}
+
+TEST(SimulationDeterminismTest, ResetReplaysIdenticallyWithoutAllocating) {
+  auto sequence = BuildInputSequence();
+  server::Simulation fresh;
+  ApplySequence(fresh, sequence);
+
+  server::Simulation reused;
+  reused.EnableRollback(4);
+  reused.AddPlayer(1);
+  reused.AddPlayer(2);
+  ApplySequence(reused, sequence);
+  for (int i = 0; i < 10; ++i) {
+    reused.TickOnce();
+  }
+
+  reused.Reset();
+  EXPECT_EQ(reused.CurrentTick(), 0);
+  EXPECT_EQ(reused.Snapshot()["players"].size(), 0u);
+
+  // 같은 규모의 다음 매치는 이전 용량을 재사용한다. 세션 생성과 같은 순서(Reset → EnableRollback → AddPlayer)로 시작한다.
+  const auto before = g_allocations.load();
+  reused.EnableRollback(4);
+  reused.AddPlayer(1);
+  reused.AddPlayer(2);
+  for (const auto& input : sequence) {
+    ASSERT_TRUE(reused.EnqueueInput(input).accepted);
+  }
+  for (int i = 0; i < 4; ++i) {
+    reused.TickOnce();
+  }
+  EXPECT_EQ(g_allocations.load(), before);
+  EXPECT_EQ(reused.StateHash(), fresh.StateHash());
+  EXPECT_EQ(reused.Snapshot(), fresh.Snapshot());
+}
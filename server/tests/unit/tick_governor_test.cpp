@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include "server/tick_governor.hpp"
+
+namespace {
+
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+server::TickGovernorConfig TestConfig() {
+  server::TickGovernorConfig config;
+  config.base_interval = milliseconds(20);
+  config.max_interval = milliseconds(60);
+  config.pressure_ticks = 2;
+  config.relief_ticks = 4;
+  return config;
+}
+
+TEST(TickGovernorTest, StepsDownUnderSustainedPressureWithinBounds) {
+  server::TickGovernor governor(TestConfig());
+  // 단발성 지연에는 반응하지 않는다.
+  EXPECT_FALSE(governor.Observe(microseconds(10000), microseconds(0)));
+  EXPECT_FALSE(governor.Observe(microseconds(0), microseconds(0)));
+  EXPECT_EQ(governor.Interval(), milliseconds(20));
+
+  EXPECT_FALSE(governor.Observe(microseconds(0), microseconds(10000)));
+  EXPECT_TRUE(governor.Observe(microseconds(10000), microseconds(0)));
+  EXPECT_EQ(governor.Interval(), milliseconds(30));
+  EXPECT_TRUE(governor.Degraded());
+
+  for (int i = 0; i < 20; ++i) {
+    governor.Observe(microseconds(50000), microseconds(50000));
+  }
+  EXPECT_EQ(governor.Interval(), milliseconds(60));
+}
+
+TEST(TickGovernorTest, RecoversToBaseAfterSustainedHeadroom) {
+  server::TickGovernor governor(TestConfig());
+  for (int i = 0; i < 10; ++i) {
+    governor.Observe(microseconds(50000), microseconds(0));
+  }
+  ASSERT_EQ(governor.Interval(), milliseconds(60));
+
+  // 여유 구간 사이의 중간 값은 회복 카운트를 초기화한다.
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_FALSE(governor.Observe(microseconds(0), microseconds(0)));
+  }
+  EXPECT_FALSE(governor.Observe(microseconds(5000), microseconds(0)));
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_FALSE(governor.Observe(microseconds(0), microseconds(0)));
+  }
+  EXPECT_TRUE(governor.Observe(microseconds(0), microseconds(0)));
+  EXPECT_EQ(governor.Interval(), milliseconds(40));
+
+  for (int i = 0; i < 40; ++i) {
+    governor.Observe(microseconds(0), microseconds(0));
+  }
+  EXPECT_EQ(governor.Interval(), milliseconds(20));
+  EXPECT_FALSE(governor.Degraded());
+}
+
+TEST(TickGovernorTest, DisabledWhenMaxDoesNotExceedBase) {
+  auto config = TestConfig();
+  config.max_interval = config.base_interval;
+  server::TickGovernor governor(config);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_FALSE(governor.Observe(microseconds(100000), microseconds(100000)));
+  }
+  EXPECT_EQ(governor.Interval(), milliseconds(20));
+}
+
+}  // namespace